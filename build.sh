@@ -23,7 +23,7 @@ mkdir -p "$BIN_DIR"
 
 # 编译配置
 CXX=g++
-CXXFLAGS="-std=c++17 -O2 -Wall -Wextra -fPIC"
+CXXFLAGS="-std=c++17 -O2 -Wall -Wextra -fPIC -DVIDEOSR_LOG_MIN_LEVEL=${LOG_MIN_LEVEL:-0}"
 INCLUDES="-Isrc -Isrc/Decoder/include -Isrc/SuperEigen/include -Isrc/SyncVA -Isrc/Encoder -Isrc/Utils -Isrc/DataStruct -Isrc/Processing"
 OPENCV_FLAGS="$(pkg-config --cflags --libs opencv4)"
 FFMPEG_FLAGS="-lavformat -lavcodec -lavutil -lswscale -lswresample"
@@ -37,19 +37,19 @@ RPATH_FLAGS="-Wl,-rpath,\$ORIGIN/../../${ONNX_PATH}/lib"
 LIBS="$OPENCV_FLAGS $FFMPEG_FLAGS $ONNX_FLAGS $RPATH_FLAGS -pthread"
 
 # 通用源文件
-DECODER_SOURCES="src/Decoder/src/VideoDecoder.cpp src/Decoder/src/AudioDecoder.cpp src/Decoder/src/Decoder.cpp"
-SUPERRES_SOURCES="src/SuperEigen/src/SuperResEngine.cpp src/SuperEigen/src/ModelSession.cpp src/SuperEigen/src/PrePostProcessor.cpp src/SuperEigen/src/SuperResConfig.cpp"
+DECODER_SOURCES="src/Decoder/src/VideoDecoder.cpp src/Decoder/src/AudioDecoder.cpp src/Decoder/src/InputReader.cpp src/Decoder/src/KeyframeIndex.cpp src/Decoder/src/ProbeCache.cpp src/Decoder/src/Decoder.cpp"
+SUPERRES_SOURCES="src/SuperEigen/src/SuperResEngine.cpp src/SuperEigen/src/ModelSession.cpp src/SuperEigen/src/PrePostProcessor.cpp src/SuperEigen/src/TensorKernels.cpp src/SuperEigen/src/SuperResConfig.cpp src/SuperEigen/src/ModelCache.cpp"
 SYNC_SOURCES="src/SyncVA/AVSyncManager.cpp"
-ENCODER_SOURCES="src/Encoder/Encoder.cpp src/Encoder/VideoEncoder.cpp src/Encoder/AudioEncoder.cpp src/Encoder/Muxer.cpp"
-UTILS_SOURCES="src/Utils/Logger.cpp src/Utils/LogUtils.cpp src/Utils/FileUtils.cpp"
-PROCESSING_SOURCES="src/Processing/SuperResolution.cpp"
+ENCODER_SOURCES="src/Encoder/Encoder.cpp src/Encoder/VideoEncoder.cpp src/Encoder/AudioEncoder.cpp src/Encoder/Muxer.cpp src/Encoder/PacketPool.cpp src/Encoder/AsyncFileWriter.cpp"
+UTILS_SOURCES="src/Utils/Logger.cpp src/Utils/LogUtils.cpp src/Utils/CpuTopology.cpp src/Utils/Metrics.cpp src/Utils/Trace.cpp src/Utils/MemoryTracker.cpp src/Utils/ScalerCache.cpp src/Utils/TaskScheduler.cpp src/Utils/FileUtils.cpp"
+PROCESSING_SOURCES="src/Processing/SuperResolution.cpp src/Processing/ThreadBudgetTuner.cpp"
 
 # 编译 test_pipeline (完整视频处理流水线)
 echo "=========================================="
 echo "编译 test_pipeline (视频处理流水线)"
 echo "=========================================="
 $CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/test_pipeline" \
-    src/test_pipeline.cpp \
+    src/test_pipeline.cpp src/Processing/ThreadBudgetTuner.cpp \
     $DECODER_SOURCES $SUPERRES_SOURCES $SYNC_SOURCES $ENCODER_SOURCES $UTILS_SOURCES \
     $LIBS
 echo "✅ test_pipeline 编译完成"
@@ -64,6 +64,48 @@ $CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/run_sr_image" \
     $LIBS
 echo "✅ run_sr_image 编译完成"
 
+# 编译 benchmark_pipeline (端到端性能基准)
+echo "=========================================="
+echo "编译 benchmark_pipeline (性能基准测试)"
+echo "=========================================="
+$CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/benchmark_pipeline" \
+    src/tools/benchmark_pipeline.cpp \
+    src/Decoder/src/VideoDecoder.cpp src/Decoder/src/InputReader.cpp src/Decoder/src/KeyframeIndex.cpp src/Decoder/src/ProbeCache.cpp $SUPERRES_SOURCES $ENCODER_SOURCES $UTILS_SOURCES \
+    $LIBS
+echo "✅ benchmark_pipeline 编译完成"
+
+# 编译 videosr (无界面批处理命令行)
+echo "=========================================="
+echo "编译 videosr (批处理命令行)"
+echo "=========================================="
+$CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/videosr" \
+    src/tools/videosr.cpp src/AppController/JobScheduler.cpp src/AppController/VideoJob.cpp src/AppController/ImageBatchPipeline.cpp src/Processing/ThreadBudgetTuner.cpp \
+    $DECODER_SOURCES $SUPERRES_SOURCES $SYNC_SOURCES $ENCODER_SOURCES $UTILS_SOURCES \
+    $LIBS
+echo "✅ videosr 编译完成"
+
+# 编译 log_decode (二进制日志解码)
+echo "=========================================="
+echo "编译 log_decode (二进制日志解码)"
+echo "=========================================="
+$CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/log_decode" \
+    src/tools/log_decode.cpp src/Utils/Logger.cpp -pthread
+echo "✅ log_decode 编译完成"
+
+# 编译 benchmark_kernels (内核微基准，需要 google-benchmark)
+if [ -f /usr/include/benchmark/benchmark.h ] || [ -f /usr/local/include/benchmark/benchmark.h ]; then
+    echo "=========================================="
+    echo "编译 benchmark_kernels (内核微基准)"
+    echo "=========================================="
+    $CXX $CXXFLAGS $INCLUDES -o "$BIN_DIR/benchmark_kernels" \
+        src/tools/benchmark_kernels.cpp src/SuperEigen/src/TensorKernels.cpp \
+        $OPENCV_FLAGS $FFMPEG_FLAGS -lbenchmark -pthread
+    echo "✅ benchmark_kernels 编译完成"
+else
+    echo "⚠️  未检测到google-benchmark，跳过benchmark_kernels编译"
+    echo "   安装命令: sudo apt-get install libbenchmark-dev"
+fi
+
 # 编译 GUI 应用程序
 echo "=========================================="
 echo "编译 VideoSR-Lite GUI"
@@ -101,7 +143,9 @@ ls -la "$BIN_DIR"
 echo ""
 echo "使用方法:"
 echo "  🖼️  单张图片超分: ./build/bin/run_sr_image input.jpg output.png"
-echo "  🎬 视频处理流水线: ./build/bin/test_pipeline [input.mp4] [output.mp4]"
+echo "  🎬 视频处理流水线: ./build/bin/test_pipeline [input.mp4] [output.mp4] [--auto-tune]"
+echo "  📊 性能基准测试:   ./build/bin/benchmark_pipeline --json results.json --csv results.csv"
+echo "  📜 二进制日志解码: ./build/bin/log_decode pipeline.vsrlog"
 if [ -f "$BIN_DIR/VideoSRLiteGUI" ]; then
 echo "  🖥️  图形界面应用: ./build/bin/VideoSRLiteGUI"
 fi
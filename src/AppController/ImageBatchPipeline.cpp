@@ -0,0 +1,240 @@
+#include "ImageBatchPipeline.h"
+#include "../SuperEigen/include/SuperResEngine.h"
+#include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/TaskScheduler.h"
+#include "../Utils/Trace.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+double elapsedMs(ImageBatchPipeline::Clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(ImageBatchPipeline::Clock::now() - from).count();
+}
+
+std::string lowerExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return std::string();
+    }
+    std::string ext = path.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+} // namespace
+
+ImageBatchPipeline::ImageBatchPipeline(JobScheduler& scheduler, const ImageBatchConfig& config)
+    : scheduler_(scheduler)
+    , config_(config) {
+    if (config_.maxInFlight == 0) {
+        config_.maxInFlight = 1;
+    }
+}
+
+ImageBatchPipeline::~ImageBatchPipeline() {
+    cancel();
+    wait();
+}
+
+void ImageBatchPipeline::setResultCallback(ResultCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = std::move(callback);
+}
+
+void ImageBatchPipeline::setConfig(const ImageBatchConfig& config) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    config_ = config;
+    if (config_.maxInFlight == 0) {
+        config_.maxInFlight = 1;
+    }
+}
+
+ImageBatchConfig ImageBatchPipeline::getConfig() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return config_;
+}
+
+std::vector<int> ImageBatchPipeline::encodeParams(const std::string& outputPath, const ImageBatchConfig& config) {
+    std::string ext = lowerExtension(outputPath);
+    if (ext == ".jpg" || ext == ".jpeg") {
+        return {cv::IMWRITE_JPEG_QUALITY, std::clamp(config.jpegQuality, 1, 100)};
+    }
+    if (ext == ".png") {
+        return {cv::IMWRITE_PNG_COMPRESSION, std::clamp(config.pngCompression, 0, 9)};
+    }
+    if (ext == ".webp") {
+        return {cv::IMWRITE_WEBP_QUALITY, std::clamp(config.webpQuality, 1, 100)};
+    }
+    return {};
+}
+
+void ImageBatchPipeline::submit(const ImageBatchItem& item) {
+    auto work = std::make_shared<Work>();
+    work->item = item;
+    work->result.item = item;
+    work->submitted = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(work));
+    }
+    pump();
+}
+
+void ImageBatchPipeline::takeReadyLocked(std::vector<std::shared_ptr<Work>>& ready) {
+    while (!queue_.empty() && inFlight_ < config_.maxInFlight) {
+        ready.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+        ++inFlight_;
+    }
+    METRICS_GAUGE_SET("image_batch_in_flight", inFlight_);
+}
+
+void ImageBatchPipeline::pump() {
+    std::vector<std::shared_ptr<Work>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        takeReadyLocked(ready);
+    }
+    startDecodes(ready);
+}
+
+void ImageBatchPipeline::startDecodes(const std::vector<std::shared_ptr<Work>>& ready) {
+    for (const auto& work : ready) {
+        if (!TaskScheduler::shared().submit([this, work]() { decode(work); })) {
+            complete(work, false, "task scheduler is shut down");
+        }
+    }
+}
+
+void ImageBatchPipeline::decode(const std::shared_ptr<Work>& work) {
+    TRACE_SCOPE("image_decode", "image_batch");
+    auto start = Clock::now();
+    work->image = cv::imread(work->item.inputPath, cv::IMREAD_COLOR);
+    work->result.decodeMs = elapsedMs(start);
+    if (work->image.empty()) {
+        complete(work, false, "failed to read image");
+        return;
+    }
+
+    // 超分交给作业调度器，与其他作业按优先级共享会话
+    auto job = std::make_shared<FunctionJob>(work->item.inputPath, [work](SuperEigen::SuperResEngine& engine) {
+        auto srStart = Clock::now();
+        work->enhanced = engine.Process(work->image);
+        work->result.srMs = elapsedMs(srStart);
+        return !work->enhanced.empty();
+    });
+
+    JobOptions options;
+    options.priority = getConfig().priority;
+    options.onFinished = [this, work](JobId, JobState state) {
+        if (state == JobState::Completed) {
+            encode(work);
+        } else {
+            complete(work, false, state == JobState::Cancelled ? "cancelled" : "super resolution failed");
+        }
+    };
+    if (scheduler_.submit(job, options) == 0) {
+        complete(work, false, "job scheduler is shut down");
+    }
+}
+
+void ImageBatchPipeline::encode(const std::shared_ptr<Work>& work) {
+    if (work->item.outputPath.empty()) {
+        complete(work, true);
+        return;
+    }
+
+    // 编码放回任务调度器：超分会话立即转去处理下一张
+    std::vector<int> params = encodeParams(work->item.outputPath, getConfig());
+    bool submitted = TaskScheduler::shared().submit([this, work, params]() {
+        TRACE_SCOPE("image_encode", "image_batch");
+        auto start = Clock::now();
+        bool ok = false;
+        try {
+            ok = cv::imwrite(work->item.outputPath, work->enhanced, params);
+        } catch (const cv::Exception& e) {
+            LOG_ERROR("ImageBatchPipeline: imwrite failed for " + work->item.outputPath + ": " + e.what());
+        }
+        work->result.encodeMs = elapsedMs(start);
+        complete(work, ok, ok ? std::string() : "failed to write image");
+    });
+    if (!submitted) {
+        complete(work, false, "task scheduler is shut down");
+    }
+}
+
+void ImageBatchPipeline::complete(const std::shared_ptr<Work>& work, bool success, const std::string& error) {
+    ImageBatchResult& result = work->result;
+    result.success = success;
+    result.error = error;
+    result.totalMs = elapsedMs(work->submitted);
+    if (getConfig().keepImages) {
+        result.original = work->image;
+        result.enhanced = work->enhanced;
+    }
+    // 尽早释放缓冲，在途图像数只统计尚未完成的
+    work->image.release();
+    work->enhanced.release();
+
+    if (success) {
+        METRICS_COUNTER_ADD("image_batch_completed", 1);
+    } else {
+        METRICS_COUNTER_ADD("image_batch_failed", 1);
+        LOG_WARNING("ImageBatchPipeline: " + work->item.inputPath + ": " + error);
+    }
+
+    ResultCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        callback = callback_;
+    }
+    if (callback) {
+        callback(result);
+    }
+
+    // 递减与取出下一批在同一临界区内完成：解锁后只有取到新图像时才访问成员，
+    // 此时在途数大于0，wait()不会返回，对象不会被析构
+    std::vector<std::shared_ptr<Work>> ready;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --inFlight_;
+        takeReadyLocked(ready);
+        if (inFlight_ == 0 && queue_.empty()) {
+            doneCv_.notify_all();
+        }
+    }
+    if (!ready.empty()) {
+        startDecodes(ready);
+    }
+}
+
+void ImageBatchPipeline::cancel() {
+    std::deque<std::shared_ptr<Work>> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dropped.swap(queue_);
+        // 计入在途，complete()逐个递减
+        inFlight_ += dropped.size();
+    }
+    for (auto& work : dropped) {
+        complete(work, false, "cancelled");
+    }
+}
+
+bool ImageBatchPipeline::wait(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto done = [this] { return inFlight_ == 0 && queue_.empty(); };
+    if (timeout.count() < 0) {
+        doneCv_.wait(lock, done);
+        return true;
+    }
+    return doneCv_.wait_for(lock, timeout, done);
+}
+
+size_t ImageBatchPipeline::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inFlight_ + queue_.size();
+}
@@ -0,0 +1,133 @@
+#ifndef IMAGE_BATCH_PIPELINE_H
+#define IMAGE_BATCH_PIPELINE_H
+
+#include "JobScheduler.h"
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 图像批处理配置
+ */
+struct ImageBatchConfig {
+    int jpegQuality = 95;              // JPEG质量 (1-100)
+    int pngCompression = 3;            // PNG压缩级别 (0-9，越大越慢)
+    int webpQuality = 95;              // WebP质量 (1-100)
+    size_t maxInFlight = 8;            // 同时在内存中的图像数（已解码未写出）
+    JobPriority priority = JobPriority::Batch;  // 超分作业优先级
+    bool keepImages = false;           // 结果中保留原图和超分图（GUI预览用）
+};
+
+/**
+ * @brief 单张图像
+ */
+struct ImageBatchItem {
+    std::string inputPath;             // 输入图像
+    std::string outputPath;            // 输出图像（空表示不写出，只返回结果）
+};
+
+/**
+ * @brief 单张图像的处理结果
+ */
+struct ImageBatchResult {
+    ImageBatchItem item;
+    bool success = false;
+    std::string error;
+    double decodeMs = 0.0;             // 读取解码耗时
+    double srMs = 0.0;                 // 超分耗时（不含排队）
+    double encodeMs = 0.0;             // 编码写出耗时
+    double totalMs = 0.0;              // 从提交到完成
+    cv::Mat original;                  // keepImages时有效
+    cv::Mat enhanced;                  // keepImages时有效
+};
+
+/**
+ * @brief 图像批处理流水线：解码、超分、编码三段重叠执行
+ *
+ * - 解码（imread）和编码（imwrite）在 TaskScheduler::shared() 上并行执行
+ * - 超分作为单步作业提交到 JobScheduler，与视频作业共享超分会话；
+ *   每张图像一个作业，调度器只保留未结束的作业，挑选开销不随批量增长
+ * - 最多 maxInFlight 张图像同时在内存中，其余排队等待，
+ *   解码始终领先超分若干张，编码与后续图像的推理重叠
+ *
+ * submit() 不阻塞，可在GUI线程调用；结果回调在工作线程中执行
+ */
+class ImageBatchPipeline {
+public:
+    using ResultCallback = std::function<void(const ImageBatchResult&)>;
+    using Clock = std::chrono::steady_clock;
+
+    explicit ImageBatchPipeline(JobScheduler& scheduler, const ImageBatchConfig& config = ImageBatchConfig());
+    ~ImageBatchPipeline();
+
+    ImageBatchPipeline(const ImageBatchPipeline&) = delete;
+    ImageBatchPipeline& operator=(const ImageBatchPipeline&) = delete;
+
+    /**
+     * @brief 设置结果回调（在submit前设置）
+     */
+    void setResultCallback(ResultCallback callback);
+
+    void setConfig(const ImageBatchConfig& config);
+    ImageBatchConfig getConfig() const;
+
+    /**
+     * @brief 提交一张图像
+     */
+    void submit(const ImageBatchItem& item);
+
+    /**
+     * @brief 取消排队中的图像（报告为失败），已开始的图像继续完成
+     */
+    void cancel();
+
+    /**
+     * @brief 等待已提交的图像全部完成
+     * @param timeout 超时时间，负值表示一直等待
+     */
+    bool wait(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    /**
+     * @brief 尚未完成的图像数（含排队中）
+     */
+    size_t pending() const;
+
+    /**
+     * @brief 按输出扩展名生成imwrite参数
+     */
+    static std::vector<int> encodeParams(const std::string& outputPath, const ImageBatchConfig& config);
+
+private:
+    struct Work {
+        ImageBatchItem item;
+        ImageBatchResult result;
+        cv::Mat image;
+        cv::Mat enhanced;
+        Clock::time_point submitted;
+    };
+
+    // 在未超过maxInFlight时启动排队图像的解码
+    void pump();
+    void takeReadyLocked(std::vector<std::shared_ptr<Work>>& ready);
+    void startDecodes(const std::vector<std::shared_ptr<Work>>& ready);
+    void decode(const std::shared_ptr<Work>& work);
+    void encode(const std::shared_ptr<Work>& work);
+    void complete(const std::shared_ptr<Work>& work, bool success, const std::string& error = std::string());
+
+    JobScheduler& scheduler_;
+    ImageBatchConfig config_;
+    ResultCallback callback_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable doneCv_;
+    std::deque<std::shared_ptr<Work>> queue_;
+    size_t inFlight_ = 0;
+};
+
+#endif // IMAGE_BATCH_PIPELINE_H
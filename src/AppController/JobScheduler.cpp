@@ -0,0 +1,396 @@
+#include "JobScheduler.h"
+#include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/Trace.h"
+
+namespace {
+
+const char* stateToString(JobState state) {
+    switch (state) {
+        case JobState::Queued: return "queued";
+        case JobState::Running: return "running";
+        case JobState::Completed: return "completed";
+        case JobState::Failed: return "failed";
+        case JobState::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+double elapsedMs(JobScheduler::Clock::time_point from, JobScheduler::Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+JobScheduler::JobScheduler() = default;
+
+JobScheduler::~JobScheduler() {
+    shutdown();
+}
+
+void JobScheduler::addSession(std::shared_ptr<SuperEigen::SuperResEngine> engine) {
+    if (!engine) {
+        LOG_ERROR("JobScheduler::addSession called with null engine");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        LOG_WARNING("JobScheduler is shut down, session not added");
+        return;
+    }
+    size_t index = workers_.size();
+    workers_.emplace_back(&JobScheduler::workerLoop, this, index, std::move(engine));
+    LOG_INFO("JobScheduler: added SR session " + std::to_string(index));
+}
+
+int JobScheduler::sessionCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return static_cast<int>(workers_.size());
+}
+
+JobId JobScheduler::submit(std::shared_ptr<Job> job, const JobOptions& options) {
+    if (!job) {
+        LOG_ERROR("JobScheduler::submit called with null job");
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_) {
+        LOG_WARNING("JobScheduler is shut down, job rejected: " + job->name());
+        return 0;
+    }
+
+    auto entry = std::make_unique<Entry>();
+    entry->id = nextId_++;
+    entry->name = job->name();
+    entry->job = std::move(job);
+    entry->options = options;
+    entry->submitted = Clock::now();
+    JobId id = entry->id;
+    jobs_[id] = std::move(entry);
+
+    METRICS_COUNTER_ADD("jobs_submitted", 1);
+    LOG_DEBUG("JobScheduler: submitted job " + std::to_string(id) + " (" + jobs_[id]->name + ")");
+    workCv_.notify_one();
+    return id;
+}
+
+JobScheduler::Entry* JobScheduler::pickLocked() {
+    Entry* best = nullptr;
+    for (auto& item : jobs_) {
+        Entry* entry = item.second.get();
+        if (entry->busy) {
+            continue;
+        }
+        if (!best) {
+            best = entry;
+            continue;
+        }
+        if (entry->options.priority != best->options.priority) {
+            if (entry->options.priority > best->options.priority) {
+                best = entry;
+            }
+        } else if (entry->options.deadline != best->options.deadline) {
+            if (entry->options.deadline < best->options.deadline) {
+                best = entry;
+            }
+        } else if (entry->lastScheduled < best->lastScheduled) {
+            // 同优先级同截止时间：最久未被调度的先执行（id顺序遍历，相同时先提交者优先）
+            best = entry;
+        }
+    }
+    return best;
+}
+
+void JobScheduler::workerLoop(size_t index, std::shared_ptr<SuperEigen::SuperResEngine> engine) {
+    Tracer::getInstance().setThreadName("job-" + std::to_string(index));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        Entry* entry = nullptr;
+        workCv_.wait(lock, [this, &entry] {
+            if (stopping_) {
+                return true;
+            }
+            entry = paused_ ? nullptr : pickLocked();
+            return entry != nullptr;
+        });
+        if (stopping_) {
+            break;
+        }
+
+        entry->busy = true;
+        entry->lastScheduled = ++scheduleCounter_;
+        bool needsStart = entry->state == JobState::Queued;
+        if (needsStart) {
+            entry->state = JobState::Running;
+            entry->firstScheduled = Clock::now();
+        }
+        std::shared_ptr<Job> job = entry->job;
+        lock.unlock();
+
+        // 作业代码在锁外执行：其他工作线程可同时推进别的作业
+        Job::StepResult result = Job::StepResult::Failed;
+        auto stepStart = Clock::now();
+        try {
+            TRACE_SCOPE("job_step", "scheduler");
+            if (!needsStart || job->start()) {
+                result = job->step(*engine);
+            } else {
+                LOG_ERROR("JobScheduler: job failed to start: " + job->name());
+            }
+        } catch (const std::exception& e) {
+            LOG_ERROR("JobScheduler: job '" + job->name() + "' threw: " + e.what());
+        } catch (...) {
+            LOG_ERROR("JobScheduler: job '" + job->name() + "' threw unknown exception");
+        }
+        auto stepEnd = Clock::now();
+        METRICS_COUNTER_ADD("job_steps", 1);
+        double progress = job->progress();
+
+        lock.lock();
+        entry->steps++;
+        entry->runMs += elapsedMs(stepStart, stepEnd);
+        entry->progress = progress;
+
+        JobState finalState = JobState::Running;
+        if (result == Job::StepResult::Done) {
+            finalState = JobState::Completed;
+        } else if (result == Job::StepResult::Failed) {
+            finalState = JobState::Failed;
+        } else if (entry->cancelRequested) {
+            finalState = JobState::Cancelled;
+        }
+
+        if (finalState == JobState::Running) {
+            entry->busy = false;
+            // 让出会话：其他工作线程可能在等这个作业或更高优先级的作业
+            workCv_.notify_one();
+            continue;
+        }
+
+        lock.unlock();
+        finalize(*entry, finalState);
+        lock.lock();
+    }
+}
+
+void JobScheduler::finalize(Entry& entry, JobState state) {
+    // 调用方已将entry标记为busy，此时不会有其他线程访问作业对象
+    try {
+        if (!entry.job->finish(state == JobState::Completed) && state == JobState::Completed) {
+            LOG_ERROR("JobScheduler: job '" + entry.name + "' failed to finish its output");
+            state = JobState::Failed;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("JobScheduler: job '" + entry.name + "' finish threw: " + e.what());
+        if (state == JobState::Completed) {
+            state = JobState::Failed;
+        }
+    }
+
+    Clock::time_point deadline;
+    uint64_t steps = 0;
+    double runMs = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        deadline = entry.options.deadline;
+        steps = entry.steps;
+        runMs = entry.runMs;
+    }
+
+    auto now = Clock::now();
+    bool missed = deadline != Clock::time_point::max() && now > deadline;
+    if (missed) {
+        METRICS_COUNTER_ADD("jobs_deadline_missed", 1);
+        LOG_WARNING("JobScheduler: job '" + entry.name + "' missed its deadline by " +
+                    std::to_string(static_cast<int64_t>(elapsedMs(deadline, now))) + " ms");
+    }
+    if (state == JobState::Completed) {
+        METRICS_COUNTER_ADD("jobs_completed", 1);
+    } else {
+        METRICS_COUNTER_ADD("jobs_failed", 1);
+    }
+    LOG_INFO("JobScheduler: job " + std::to_string(entry.id) + " (" + entry.name + ") " + stateToString(state) +
+             " after " + std::to_string(steps) + " steps, " +
+             std::to_string(static_cast<int64_t>(runMs)) + " ms processing, " +
+             std::to_string(static_cast<int64_t>(elapsedMs(entry.submitted, now))) + " ms total");
+
+    // 回调在移除记录前执行：wait()返回时回调已经完成
+    if (entry.options.onFinished) {
+        entry.options.onFinished(entry.id, state);
+    }
+
+    // 结束的作业从表中移除，调度和等待只遍历未结束的作业；
+    // 记录连同作业对象在锁外析构（可能关闭文件、释放编码器）
+    std::unique_ptr<Entry> removed;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = jobs_.find(entry.id);
+        removed = std::move(it->second);
+        jobs_.erase(it);
+    }
+    doneCv_.notify_all();
+}
+
+bool JobScheduler::cancel(JobId id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+
+    Entry& entry = *it->second;
+    if (entry.busy) {
+        // 正在执行：由工作线程在当前帧结束后收尾
+        entry.cancelRequested = true;
+        return true;
+    }
+
+    entry.busy = true;
+    lock.unlock();
+    finalize(entry, JobState::Cancelled);
+    return true;
+}
+
+void JobScheduler::cancelAll() {
+    std::vector<JobId> ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& item : jobs_) {
+            ids.push_back(item.first);
+        }
+    }
+    for (JobId id : ids) {
+        cancel(id);
+    }
+}
+
+bool JobScheduler::setPriority(JobId id, JobPriority priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    it->second->options.priority = priority;
+    workCv_.notify_all();
+    return true;
+}
+
+bool JobScheduler::setDeadline(JobId id, Clock::time_point deadline) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    it->second->options.deadline = deadline;
+    workCv_.notify_all();
+    return true;
+}
+
+void JobScheduler::setPaused(bool paused) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        paused_ = paused;
+    }
+    if (!paused) {
+        workCv_.notify_all();
+    }
+}
+
+bool JobScheduler::isPaused() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return paused_;
+}
+
+JobStatus JobScheduler::snapshotLocked(const Entry& entry) const {
+    JobStatus status;
+    status.id = entry.id;
+    status.name = entry.name;
+    status.priority = entry.options.priority;
+    status.state = entry.state;
+    status.progress = entry.progress;
+    status.steps = entry.steps;
+    status.runMs = entry.runMs;
+    auto now = Clock::now();
+    status.deadlineMissed = entry.options.deadline != Clock::time_point::max() && now > entry.options.deadline;
+    if (entry.state != JobState::Queued) {
+        status.queuedMs = elapsedMs(entry.submitted, entry.firstScheduled);
+    } else {
+        status.queuedMs = elapsedMs(entry.submitted, now);
+    }
+    return status;
+}
+
+bool JobScheduler::getStatus(JobId id, JobStatus& status) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = jobs_.find(id);
+    if (it == jobs_.end()) {
+        return false;
+    }
+    status = snapshotLocked(*it->second);
+    return true;
+}
+
+std::vector<JobStatus> JobScheduler::getAllStatus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JobStatus> result;
+    result.reserve(jobs_.size());
+    for (const auto& item : jobs_) {
+        result.push_back(snapshotLocked(*item.second));
+    }
+    return result;
+}
+
+size_t JobScheduler::activeJobs() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+bool JobScheduler::wait(JobId id, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto finished = [this, id] { return jobs_.find(id) == jobs_.end(); };
+    if (timeout.count() < 0) {
+        doneCv_.wait(lock, finished);
+        return true;
+    }
+    return doneCv_.wait_for(lock, timeout, finished);
+}
+
+bool JobScheduler::waitAll(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto finished = [this] { return jobs_.empty(); };
+    if (timeout.count() < 0) {
+        doneCv_.wait(lock, finished);
+        return true;
+    }
+    return doneCv_.wait_for(lock, timeout, finished);
+}
+
+void JobScheduler::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) {
+            return;
+        }
+    }
+
+    // 先取消作业，正在执行的作业在当前帧完成后由工作线程收尾
+    cancelAll();
+    waitAll();
+
+    std::vector<std::thread> workers;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        workers.swap(workers_);
+    }
+    workCv_.notify_all();
+    for (auto& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    LOG_INFO("JobScheduler stopped");
+}
@@ -0,0 +1,244 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace SuperEigen {
+class SuperResEngine;
+}
+
+/**
+ * @brief 可调度作业：按帧推进的处理过程
+ *
+ * 调度器每次调用 step() 处理一帧（一张图像或一个视频帧的解码-超分-编码），
+ * 在两次 step() 之间作业可能被更高优先级或截止时间更早的作业抢占。
+ * 同一作业的 start/step/finish 不会并发调用，但可能在不同工作线程上执行。
+ */
+class Job {
+public:
+    enum class StepResult {
+        Continue,  // 还有剩余帧
+        Done,      // 全部完成
+        Failed     // 出错终止
+    };
+
+    virtual ~Job() = default;
+
+    /**
+     * @brief 首次被调度时调用（打开文件等），返回false视为失败
+     */
+    virtual bool start() { return true; }
+
+    /**
+     * @brief 用分配到的超分会话处理一帧
+     */
+    virtual StepResult step(SuperEigen::SuperResEngine& engine) = 0;
+
+    /**
+     * @brief 结束时调用一次（完成、失败或取消），负责刷新输出和释放资源
+     * @param success 是否正常完成
+     * @return 输出是否完整写出；正常完成时返回false，作业记为失败
+     */
+    virtual bool finish(bool success) { (void)success; return true; }
+
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief 进度 0~1，未知时返回负值
+     */
+    virtual double progress() const { return -1.0; }
+};
+
+/**
+ * @brief 由函数构成的单步作业（如GUI中的单张图像）
+ */
+class FunctionJob : public Job {
+public:
+    using StepFunction = std::function<bool(SuperEigen::SuperResEngine&)>;
+
+    FunctionJob(std::string name, StepFunction function)
+        : name_(std::move(name)), function_(std::move(function)) {}
+
+    StepResult step(SuperEigen::SuperResEngine& engine) override {
+        return function_(engine) ? StepResult::Done : StepResult::Failed;
+    }
+
+    std::string name() const override { return name_; }
+
+private:
+    std::string name_;
+    StepFunction function_;
+};
+
+/**
+ * @brief 作业优先级
+ */
+enum class JobPriority {
+    Batch = 0,        // 离线批处理
+    Normal = 1,       // 普通
+    Interactive = 2   // 交互预览
+};
+
+/**
+ * @brief 作业状态
+ */
+enum class JobState {
+    Queued,     // 等待首次调度
+    Running,    // 已开始（可能正被抢占等待下一次调度）
+    Completed,  // 已完成
+    Failed,     // 失败
+    Cancelled   // 已取消
+};
+
+using JobId = uint64_t;
+
+/**
+ * @brief 作业提交选项
+ */
+struct JobOptions {
+    using Clock = std::chrono::steady_clock;
+
+    JobPriority priority = JobPriority::Normal;        // 优先级
+    Clock::time_point deadline = Clock::time_point::max();  // 截止时间（max表示无）
+    std::function<void(JobId, JobState)> onFinished;   // 结束回调（在工作线程或cancel调用线程中执行）
+};
+
+/**
+ * @brief 作业状态快照
+ */
+struct JobStatus {
+    JobId id = 0;
+    std::string name;
+    JobPriority priority = JobPriority::Normal;
+    JobState state = JobState::Queued;
+    double progress = -1.0;
+    uint64_t steps = 0;            // 已处理帧数
+    double queuedMs = 0.0;         // 从提交到首次调度的等待时间
+    double runMs = 0.0;            // 累计处理时间
+    bool deadlineMissed = false;   // 是否超过截止时间
+};
+
+/**
+ * @brief 作业级调度器：多个作业共享超分会话
+ *
+ * 每个超分会话对应一个工作线程。工作线程在每个帧边界上重新挑选作业：
+ * 1. 优先级高者优先
+ * 2. 同优先级按截止时间最早优先（EDF），无截止时间的排在后面
+ * 3. 再按最近一次被调度的先后轮转，同级作业按帧交替推进而不是先到先做完
+ *
+ * 作业的编码也在这一步内完成，因此编码线程同样按作业的优先级分配；
+ * 低优先级的批处理在交互作业到来后最多再处理完当前一帧即让出会话。
+ */
+class JobScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    JobScheduler();
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    /**
+     * @brief 添加超分会话（须已初始化），为其启动一个工作线程
+     */
+    void addSession(std::shared_ptr<SuperEigen::SuperResEngine> engine);
+    int sessionCount() const;
+
+    /**
+     * @brief 提交作业
+     * @return 作业ID，调度器已关闭时返回0
+     */
+    JobId submit(std::shared_ptr<Job> job, const JobOptions& options = JobOptions());
+
+    /**
+     * @brief 取消作业：未在执行的立即结束，正在执行的在当前帧完成后结束
+     * @return 作业存在且尚未结束时返回true
+     */
+    bool cancel(JobId id);
+
+    /**
+     * @brief 取消全部未结束的作业
+     */
+    void cancelAll();
+
+    bool setPriority(JobId id, JobPriority priority);
+    bool setDeadline(JobId id, Clock::time_point deadline);
+
+    /**
+     * @brief 暂停/恢复：暂停后工作线程在当前帧完成后不再调度新的帧
+     */
+    void setPaused(bool paused);
+    bool isPaused() const;
+
+    /**
+     * @brief 查询作业状态
+     *
+     * 作业结束后记录即被移除（onFinished回调中仍可查询最终的统计），之后返回false
+     */
+    bool getStatus(JobId id, JobStatus& status) const;
+    std::vector<JobStatus> getAllStatus() const;
+
+    /**
+     * @brief 未结束的作业数
+     */
+    size_t activeJobs() const;
+
+    /**
+     * @brief 等待作业结束
+     * @param timeout 超时时间，负值表示一直等待
+     * @return 作业是否已结束（不存在的作业视为已结束）
+     */
+    bool wait(JobId id, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+    bool waitAll(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    /**
+     * @brief 取消全部作业并停止工作线程
+     */
+    void shutdown();
+
+private:
+    struct Entry {
+        JobId id = 0;
+        std::shared_ptr<Job> job;
+        JobOptions options;
+        JobState state = JobState::Queued;
+        bool busy = false;              // 正在某个工作线程上执行
+        bool cancelRequested = false;
+        uint64_t lastScheduled = 0;     // 最近一次被调度的序号（轮转用）
+        uint64_t steps = 0;
+        Clock::time_point submitted;
+        Clock::time_point firstScheduled;
+        double runMs = 0.0;
+        std::string name;
+        double progress = -1.0;
+    };
+
+    void workerLoop(size_t index, std::shared_ptr<SuperEigen::SuperResEngine> engine);
+    Entry* pickLocked();
+    // 结束作业：调用finish和回调（不持锁），然后移除记录并唤醒等待者
+    void finalize(Entry& entry, JobState state);
+    JobStatus snapshotLocked(const Entry& entry) const;
+
+    mutable std::mutex mutex_;
+    std::condition_variable workCv_;  // 工作线程等待可调度的作业
+    std::condition_variable doneCv_;  // wait/waitAll等待作业结束
+    std::map<JobId, std::unique_ptr<Entry>> jobs_;  // 未结束的作业
+    std::vector<std::thread> workers_;
+    JobId nextId_ = 1;
+    uint64_t scheduleCounter_ = 0;
+    bool paused_ = false;
+    bool stopping_ = false;
+};
+
+#endif // JOB_SCHEDULER_H
@@ -0,0 +1,289 @@
+#include "VideoJob.h"
+#include "../SuperEigen/include/SuperResEngine.h"
+#include "../Utils/Logger.h"
+#include "../Utils/MemoryTracker.h"
+#include <algorithm>
+
+VideoJob::VideoJob(const VideoJobConfig& config)
+    : config_(config) {
+}
+
+VideoJob::~VideoJob() {
+    if (audioPacket_) {
+        av_packet_free(&audioPacket_);
+    }
+}
+
+bool VideoJob::start() {
+    videoDecoder_ = std::make_unique<VideoDecoder>();
+    if (!videoDecoder_->initialize(config_.decoder) || !videoDecoder_->open(config_.inputPath)) {
+        LOG_ERROR("VideoJob: failed to open video file: " + config_.inputPath);
+        return false;
+    }
+
+    VideoInfo info = videoDecoder_->getVideoInfo();
+    frameRate_ = info.frameRate > 0.0 ? info.frameRate : 30.0;
+    totalFrames_ = info.totalFrames > 0 ? info.totalFrames
+                                        : static_cast<int64_t>(info.duration * frameRate_);
+    if (config_.maxFrames > 0) {
+        totalFrames_ = totalFrames_ > 0 ? std::min(totalFrames_, config_.maxFrames) : config_.maxFrames;
+    }
+
+    // 音频可选；直通时只解复用压缩包，省去音频解码和重新编码
+    audioDecoder_ = std::make_unique<AudioDecoder>();
+    AudioDecoderConfig audioConfig;
+    audioConfig.passthrough = config_.audioPassthrough;
+    audioConfig.input = config_.decoder.input;  // 与视频解码器共享同一个输入读取器
+    audioDecoder_->initialize(audioConfig);
+    hasAudio_ = audioDecoder_->open(config_.inputPath);
+    if (hasAudio_ && audioConfig.passthrough) {
+        // 分段输出的分段是fMP4，按mp4检查
+        std::string container = config_.encoder.outputMode == MuxerOutputMode::Segmented ? "mp4" : config_.encoder.format;
+        AVCodecID codecId = audioDecoder_->getCodecParameters()->codec_id;
+        if (!Muxer::canStreamCopy(container, codecId)) {
+            LOG_WARNING("VideoJob: " + std::string(avcodec_get_name(codecId)) + " audio cannot be copied into " +
+                        container + ", re-encoding instead");
+            audioDecoder_ = std::make_unique<AudioDecoder>();
+            audioConfig.passthrough = false;
+            audioDecoder_->initialize(audioConfig);
+            hasAudio_ = audioDecoder_->open(config_.inputPath);
+        }
+    }
+    if (!hasAudio_) {
+        LOG_WARNING("VideoJob: no audio stream in " + config_.inputPath + ", processing video only");
+        audioDecoder_.reset();
+    } else if (audioConfig.passthrough) {
+        audioPassthrough_ = true;
+        audioPacket_ = av_packet_alloc();
+        if (!audioPacket_) {
+            LOG_ERROR("VideoJob: failed to allocate audio packet");
+            return false;
+        }
+    }
+
+    syncManager_ = std::make_unique<AVSyncManager>(config_.sync);
+    if (!hasAudio_ || audioPassthrough_) {
+        // 没有音频经过同步管理器，视频帧不必等待音频推进
+        syncManager_->endAudio();
+    }
+    LOG_INFO("VideoJob started: " + config_.inputPath + " -> " + config_.outputPath);
+    return true;
+}
+
+Job::StepResult VideoJob::step(SuperEigen::SuperResEngine& engine) {
+    if (videoDone_) {
+        return StepResult::Done;
+    }
+
+    FrameData frame;
+    bool limitReached = config_.maxFrames > 0 && processedFrames() >= config_.maxFrames;
+    if (limitReached || !videoDecoder_->readNextFrame(frame)) {
+        videoDone_ = true;
+        syncManager_->endVideo();
+        // 视频读完时剩余音频全部送入编码器；达到帧数上限时只送到最后一帧视频结束为止
+        double audioEnd = limitReached ? lastVideoTimestamp_ + 1.0 / frameRate_ : -1.0;
+        if (audioPassthrough_) {
+            if (!drainSync() || !pumpAudioPackets(audioEnd)) {
+                return StepResult::Failed;
+            }
+        } else {
+            if (!pumpAudio(audioEnd)) {
+                return StepResult::Failed;
+            }
+            if (hasAudio_) {
+                hasAudio_ = false;
+                syncManager_->endAudio();
+            }
+            if (!drainSync()) {
+                return StepResult::Failed;
+            }
+        }
+        LOG_INFO("VideoJob: decoding finished for " + config_.inputPath + ", " +
+                 std::to_string(processedFrames()) + " frames");
+        return StepResult::Done;
+    }
+
+    // 超过内存上限时等待其他作业的在途帧释放缓冲（本帧从超分到编码都计为在途）
+    MemoryTracker::HeadroomScope headroom;
+
+    cv::Mat enhanced = engine.Process(frame.image);
+    if (enhanced.empty()) {
+        LOG_ERROR("VideoJob: super resolution failed at frame " + std::to_string(processedFrames()) +
+                  " of " + config_.inputPath);
+        return StepResult::Failed;
+    }
+    frame.image = enhanced;
+    frame.width = enhanced.cols;
+    frame.height = enhanced.rows;
+
+    if (!encoder_ && !initializeEncoder(frame)) {
+        return StepResult::Failed;
+    }
+
+    double timestamp = frame.timestamp;
+    lastVideoTimestamp_ = timestamp;
+    if (!pushSync(frame)) {
+        return StepResult::Failed;
+    }
+    if (audioPassthrough_) {
+        // 直通音频包不经过同步管理器，由封装器按时间戳交错
+        if (!drainSync() || !pumpAudioPackets(timestamp)) {
+            return StepResult::Failed;
+        }
+    } else {
+        if (!pumpAudio(timestamp) || !drainSync()) {
+            return StepResult::Failed;
+        }
+    }
+
+    processedFrames_.fetch_add(1, std::memory_order_relaxed);
+    return StepResult::Continue;
+}
+
+bool VideoJob::pumpAudio(double untilTimestamp) {
+    // 音频解码到当前视频帧的时间戳为止（负值表示读完），与视频交错送入编码器
+    while (hasAudio_) {
+        AudioFrameData audioFrame;
+        if (!audioDecoder_->readNextFrame(audioFrame)) {
+            hasAudio_ = false;
+            syncManager_->endAudio();
+            break;
+        }
+        double timestamp = audioFrame.timestamp;
+        if (!pushSync(audioFrame)) {
+            return false;
+        }
+        if (untilTimestamp >= 0.0 && timestamp >= untilTimestamp) {
+            break;
+        }
+    }
+    return true;
+}
+
+bool VideoJob::pumpAudioPackets(double untilTimestamp) {
+    // 写出到当前视频帧时间戳为止的音频包（负值表示全部），超出的一包留到下一帧
+    while (hasAudio_ && encoder_) {
+        if (!audioPacketPending_) {
+            if (!audioDecoder_->readNextPacket(audioPacket_)) {
+                hasAudio_ = false;
+                break;
+            }
+            audioPacketPending_ = true;
+        }
+        if (untilTimestamp >= 0.0 && audioDecoder_->getCurrentTime() > untilTimestamp) {
+            break;
+        }
+        audioPacketPending_ = false;
+        bool written = encoder_->pushAudioPacket(audioPacket_);
+        av_packet_unref(audioPacket_);
+        if (!written) {
+            LOG_ERROR("VideoJob: failed to write audio packet of " + config_.inputPath);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VideoJob::pushSync(const FrameData& frame) {
+    while (!syncManager_->pushVideo(frame, std::chrono::milliseconds(0))) {
+        if (!drainFullSync("video")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VideoJob::pushSync(const AudioFrameData& frame) {
+    while (!syncManager_->pushAudio(frame, std::chrono::milliseconds(0))) {
+        if (!drainFullSync("audio")) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VideoJob::drainFullSync(const char* stream) {
+    // 同一线程既推入又取出：队列满时先把可输出的帧送去编码，阻塞等待只会等到自己
+    if (!syncManager_->hasNext()) {
+        LOG_ERROR("VideoJob: " + std::string(stream) + " sync queue full with no frame ready in " + config_.inputPath);
+        return false;
+    }
+    return drainSync();
+}
+
+bool VideoJob::drainSync() {
+    AVSyncManager::FrameVariant frame;
+    while (syncManager_->popNext(frame, std::chrono::milliseconds(0))) {
+        if (!encoder_) {
+            // 第一帧视频之前的音频：编码器尚未创建，丢弃
+            continue;
+        }
+        if (!encoder_->push(frame)) {
+            LOG_ERROR("VideoJob: failed to encode frame of " + config_.inputPath);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool VideoJob::initializeEncoder(const FrameData& firstFrame) {
+    EncoderConfig config = config_.encoder;
+    config.outputPath = config_.outputPath;
+    config.videoWidth = firstFrame.width;
+    config.videoHeight = firstFrame.height;
+    config.videoFrameRate = frameRate_;
+    if (audioPassthrough_) {
+        config.audioPassthrough = true;
+        config.audioCodecParameters = audioDecoder_->getCodecParameters();
+        config.audioTimeBase = audioDecoder_->getTimeBase();
+    } else if (!audioDecoder_) {
+        // 没有音频流，设置为0禁用音频编码
+        config.audioSampleRate = 0;
+        config.audioChannels = 0;
+        config.audioBitrate = 0;
+    }
+
+    encoder_ = std::make_unique<Encoder>();
+    if (!encoder_->init(config)) {
+        LOG_ERROR("VideoJob: failed to initialize encoder for " + config_.outputPath);
+        encoder_.reset();
+        return false;
+    }
+    return true;
+}
+
+bool VideoJob::finish(bool success) {
+    bool written = true;
+    if (encoder_) {
+        if (success && !encoder_->flush()) {
+            LOG_ERROR("VideoJob: failed to flush encoder for " + config_.outputPath);
+            written = false;
+        }
+        // 文件尾写失败同样视为输出不完整
+        if (!encoder_->close()) {
+            LOG_ERROR("VideoJob: failed to close output " + config_.outputPath);
+            written = false;
+        }
+        encoder_.reset();
+    }
+    if (!success) {
+        LOG_WARNING("VideoJob: " + config_.inputPath + " stopped after " + std::to_string(processedFrames()) +
+                    " frames, output may be incomplete");
+    }
+
+    syncManager_.reset();
+    if (audioPacket_) {
+        av_packet_free(&audioPacket_);
+    }
+    audioPacketPending_ = false;
+    audioDecoder_.reset();
+    videoDecoder_.reset();
+    return written;
+}
+
+double VideoJob::progress() const {
+    if (totalFrames_ <= 0) {
+        return -1.0;
+    }
+    return std::min(1.0, static_cast<double>(processedFrames()) / static_cast<double>(totalFrames_));
+}
@@ -0,0 +1,79 @@
+#ifndef VIDEO_JOB_H
+#define VIDEO_JOB_H
+
+#include "JobScheduler.h"
+#include "../Decoder/include/AudioDecoder.h"
+#include "../Decoder/include/VideoDecoder.h"
+#include "../Encoder/Encoder.h"
+#include "../SyncVA/AVSyncManager.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+/**
+ * @brief 视频作业配置
+ */
+struct VideoJobConfig {
+    std::string inputPath;            // 输入视频
+    std::string outputPath;           // 输出视频
+    VideoDecoderConfig decoder;       // 解码配置
+    EncoderConfig encoder;            // 编码配置（输出路径、尺寸、音频参数由作业填写）
+    int64_t maxFrames = 0;            // 最多处理的视频帧数（0表示全部）
+    bool audioPassthrough = true;     // 音频直通（容器不支持源音频编码时回退为重新编码）
+    AVSyncConfig sync;                // 音视频同步队列容量
+
+    VideoJobConfig() {
+        // 与test_pipeline一致：CRF高质量快速编码；编码线程数限制在2，
+        // 多个作业并发时编码线程由作业调度分摊，不再每个作业占满全部核心
+        encoder.videoBitrate = 0;
+        encoder.videoCRF = 18;
+        encoder.videoPreset = "ultrafast";
+        encoder.threadCount = 2;
+        // 每步只推入一帧视频和追上它的音频，随即取出；容量只是防止异常流无限堆积
+        sync.videoCapacity = 4;
+        sync.audioCapacity = 64;
+    }
+};
+
+/**
+ * @brief 单个视频的超分作业：每步解码一帧视频、超分、连同音频送入编码器
+ */
+class VideoJob : public Job {
+public:
+    explicit VideoJob(const VideoJobConfig& config);
+    ~VideoJob() override;
+
+    bool start() override;
+    StepResult step(SuperEigen::SuperResEngine& engine) override;
+    bool finish(bool success) override;
+    std::string name() const override { return config_.inputPath; }
+    double progress() const override;
+
+    int64_t processedFrames() const { return processedFrames_.load(std::memory_order_relaxed); }
+
+private:
+    bool initializeEncoder(const FrameData& firstFrame);
+    bool pumpAudio(double untilTimestamp);
+    bool pumpAudioPackets(double untilTimestamp);
+    bool pushSync(const FrameData& frame);
+    bool pushSync(const AudioFrameData& frame);
+    bool drainFullSync(const char* stream);
+    bool drainSync();
+
+    VideoJobConfig config_;
+    std::unique_ptr<VideoDecoder> videoDecoder_;
+    std::unique_ptr<AudioDecoder> audioDecoder_;
+    std::unique_ptr<AVSyncManager> syncManager_;
+    std::unique_ptr<Encoder> encoder_;
+    bool hasAudio_ = false;
+    bool audioPassthrough_ = false;
+    AVPacket* audioPacket_ = nullptr;  // 直通模式下读到但尚未写出的音频包
+    bool audioPacketPending_ = false;
+    bool videoDone_ = false;
+    double frameRate_ = 0.0;
+    double lastVideoTimestamp_ = 0.0;  // 最后一帧送入编码的视频时间戳
+    int64_t totalFrames_ = 0;
+    std::atomic<int64_t> processedFrames_{0};
+};
+
+#endif // VIDEO_JOB_H
@@ -4,6 +4,7 @@
 #include <vector>
 #include <mutex>
 #include "../../DataStruct/AudioFrameData.h"
+#include "InputReader.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -17,6 +18,8 @@ struct AudioDecoderConfig {
     int outputChannels = 2;              // 输出声道数
     AVSampleFormat outputFormat = AV_SAMPLE_FMT_S16;  // 输出格式
     int maxSamples = 0;                  // 最大样本数（0表示不限制）
+    bool passthrough = false;            // 直通模式：只解复用出压缩包，不打开解码器
+    InputReaderConfig input;             // 输入读取方式（与同文件的视频解码器共享读取器）
 };
 
 // 音频信息
@@ -54,6 +57,11 @@ public:
     bool seekToTime(double seconds);
     bool seekToSample(int64_t sampleNumber);
     
+    // 直通模式：读取下一个音频压缩包（时间戳已减去流起始时间），用完由调用方unref
+    bool readNextPacket(AVPacket* packet);
+    const AVCodecParameters* getCodecParameters() const;
+    AVRational getTimeBase() const;
+    
     // 配置和控制
     void setThreadSafe(bool enable) { threadSafe_ = enable; }
     void setConfig(const AudioDecoderConfig& config) { config_ = config; }
@@ -69,10 +77,12 @@ private:
     bool initDecoder();
     bool initSwrContext();
     void cleanup();
+    void closeInput();
     bool processPacket(AudioFrameData& frame);
     
     // FFmpeg组件
     AVFormatContext* formatCtx_ = nullptr;
+    AVIOContext* inputIO_ = nullptr;     // 自定义输入I/O（为空时用FFmpeg默认文件I/O）
     AVCodecContext* codecCtx_ = nullptr;
     AVPacket* packet_ = nullptr;
     AVFrame* frame_ = nullptr;
@@ -84,6 +94,7 @@ private:
     bool initialized_ = false;
     bool opened_ = false;
     int audioStreamIndex_ = -1;
+    int64_t startPts_ = 0;               // 文件起始时间（流时间基）：输出时间戳以此为零点，与视频共用同一原点
     double currentTime_ = 0.0;
     int64_t currentSample_ = 0;
     
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 输入读取方式
+enum class InputReadMode {
+    Default,        // FFmpeg默认文件I/O（逐次小块read）
+    Mmap,           // 整个文件mmap，按游标madvise(WILLNEED)预取
+    ReadAhead       // 后台线程pread大块对齐缓冲，按游标预读
+};
+
+// 输入读取配置
+struct InputReaderConfig {
+    InputReadMode mode = InputReadMode::ReadAhead;  // 读取方式
+    size_t blockSize = 4 << 20;                     // 预读块大小（向上对齐到4KiB）
+    size_t readAheadBlocks = 8;                     // 游标前方预读的块数
+    int ioThreads = 2;                              // 预读线程数（ReadAhead）
+    int avioBufferSize = 256 << 10;                 // AVIOContext缓冲大小
+};
+
+/**
+ * @brief 解复用输入读取器
+ *
+ * 同一文件的视频、音频解码器共享一个读取器（按路径登记），各自持有独立游标的AVIOContext。
+ * ReadAhead模式下块缓存由预读线程填充，demux读到的块大多已在内存中，
+ * 慢速存储上的读阻塞不再直接变成解码空泡；只有预读没跟上时才会在读调用里等待。
+ *
+ * read()线程安全，可被多个游标并发调用。
+ */
+class InputReader {
+public:
+    ~InputReader();
+
+    InputReader(const InputReader&) = delete;
+    InputReader& operator=(const InputReader&) = delete;
+
+    /**
+     * @brief 取得路径对应的共享读取器，不存在时创建
+     * @return 失败或不适用（非普通文件、Default模式）返回nullptr
+     */
+    static std::shared_ptr<InputReader> acquire(const std::string& path, const InputReaderConfig& config);
+
+    /**
+     * @brief 创建读该文件的自定义AVIOContext（独立游标，共享读取器）
+     * @return nullptr 表示应回退到FFmpeg默认文件I/O
+     */
+    static AVIOContext* createIOContext(const std::string& path, const InputReaderConfig& config);
+
+    /**
+     * @brief 释放createIOContext创建的上下文（含缓冲和游标），并置空
+     */
+    static void freeIOContext(AVIOContext** context);
+
+    /**
+     * @brief 从offset处读取最多size字节
+     * @return 读取字节数，0表示文件结束，-1表示读失败
+     */
+    int read(int64_t offset, uint8_t* dst, int size);
+
+    int64_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+    struct Statistics {
+        uint64_t bytesRead = 0;         // 交给demux的字节数
+        uint64_t blockLoads = 0;        // 从存储读入的块数
+        uint64_t cacheHits = 0;         // 读时块已就绪的次数
+        uint64_t cacheMisses = 0;       // 读时需要等待存储的次数
+        double ioWaitMs = 0.0;          // demux线程等待存储的时间
+        double loadMs = 0.0;            // 预读线程实际读盘耗时
+    };
+
+    Statistics getStatistics() const;
+
+private:
+    enum class BlockState { Loading, Ready, Failed };
+
+    struct Block {
+        int64_t index = -1;
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        BlockState state = BlockState::Loading;
+        uint64_t lastUse = 0;
+        int pins = 0;                   // 正在等待或拷贝该块的读调用数
+    };
+
+    InputReader(const std::string& path, const InputReaderConfig& config);
+
+    bool open();
+    int readMapped(int64_t offset, uint8_t* dst, int size);
+    int readCached(int64_t offset, uint8_t* dst, int size);
+
+    Block* obtainBlockLocked(int64_t index, bool demand);
+    void scheduleLocked(int64_t firstIndex);
+    bool loadBlock(Block* block);
+    void loaderLoop();
+
+    std::string path_;
+    InputReaderConfig config_;
+    int fd_ = -1;
+    int64_t size_ = 0;
+    int64_t blockCount_ = 0;
+
+    // Mmap模式
+    uint8_t* map_ = nullptr;
+    std::atomic<int64_t> advisedEnd_{0};
+
+    // ReadAhead模式
+    mutable std::mutex mutex_;
+    std::condition_variable loadCv_;    // 预读线程等待任务
+    std::condition_variable readyCv_;   // 读调用等待块就绪
+    std::unordered_map<int64_t, Block*> blocks_;
+    std::vector<std::unique_ptr<Block>> storage_;
+    std::deque<Block*> loadQueue_;
+    size_t capacity_ = 0;
+    uint64_t tick_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> loaders_;
+
+    Statistics stats_;
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief 视频流的帧/关键帧PTS索引
+ *
+ * 一次解复用扫描（不解码）记录每个视频包的PTS和关键帧标记，按显示顺序排序后：
+ * 帧号 ↔ PTS 精确互查，并能找到目标帧之前最近的关键帧。
+ * 可保存为输入文件旁的索引文件，按文件大小和修改时间校验，下次打开直接加载。
+ */
+class KeyframeIndex {
+public:
+    static constexpr const char* kSidecarSuffix = ".kfidx";
+
+    /**
+     * @brief 扫描视频流建立索引（会移动formatCtx的读位置，调用方负责seek回去）
+     * @return 流中存在缺失PTS的包时无法建立精确索引，返回false
+     */
+    bool build(AVFormatContext* formatCtx, int streamIndex);
+
+    /**
+     * @brief 从索引文件加载，输入文件大小或修改时间不符时视为失效
+     */
+    bool load(const std::string& sidecarPath, const std::string& mediaPath);
+
+    /**
+     * @brief 写索引文件（记录输入文件大小和纳秒精度的修改时间）
+     */
+    bool save(const std::string& sidecarPath, const std::string& mediaPath) const;
+
+    void clear();
+    bool empty() const { return framePts_.empty(); }
+
+    int64_t frameCount() const { return static_cast<int64_t>(framePts_.size()); }
+    size_t keyframeCount() const { return keyframePts_.size(); }
+    AVRational timeBase() const { return timeBase_; }
+
+    /**
+     * @brief 第frame帧（显示顺序，从0开始）的PTS，越界返回AV_NOPTS_VALUE
+     */
+    int64_t framePts(int64_t frame) const;
+
+    /**
+     * @brief PTS对应的帧号：不超过pts的最后一帧（pts早于第一帧时为0）
+     */
+    int64_t frameAtPts(int64_t pts) const;
+
+    /**
+     * @brief 不晚于pts的最近关键帧PTS（没有时返回第一个关键帧）
+     */
+    int64_t keyframeAtOrBefore(int64_t pts) const;
+
+    const std::vector<int64_t>& keyframes() const { return keyframePts_; }
+
+private:
+    std::vector<int64_t> framePts_;     // 全部帧PTS，升序（显示顺序）
+    std::vector<int64_t> keyframePts_;  // 关键帧PTS，升序
+    AVRational timeBase_{0, 1};
+};
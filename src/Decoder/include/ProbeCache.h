@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+// 探测得到的单个流参数
+struct ProbedStream {
+    std::shared_ptr<AVCodecParameters> codecpar;
+    AVRational timeBase{0, 1};
+    AVRational avgFrameRate{0, 1};
+    AVRational rFrameRate{0, 1};
+    int64_t startTime = AV_NOPTS_VALUE;
+    int64_t duration = AV_NOPTS_VALUE;
+    int64_t nbFrames = 0;
+};
+
+// 一个文件的探测结果（avformat_find_stream_info之后的状态）
+struct ProbeResult {
+    uint64_t fileSize = 0;
+    int64_t mtimeNs = 0;
+    int64_t duration = AV_NOPTS_VALUE;     // AV_TIME_BASE单位
+    int64_t startTime = AV_NOPTS_VALUE;
+    int64_t bitRate = 0;
+    std::vector<ProbedStream> streams;
+
+    /**
+     * @brief 第一个指定类型流的下标，没有时返回-1
+     */
+    int findStream(AVMediaType type) const;
+};
+
+/**
+ * @brief 媒体探测缓存
+ *
+ * avformat_find_stream_info 在部分容器上要读取并解码数MB数据。这里按 路径+修改时间+大小
+ * 缓存探测结果（内存中，可选落盘），再次打开同一文件时直接把缓存的编解码参数、帧率、时长
+ * 写回格式上下文，跳过探测。文件被修改后键不再匹配，自动重新探测。
+ *
+ * 线程安全。
+ */
+class ProbeCache {
+public:
+    static ProbeCache& getInstance();
+
+    /**
+     * @brief 代替 avformat_find_stream_info：命中时用缓存填充formatCtx，否则探测并缓存
+     * @return 探测失败返回false
+     */
+    bool findStreamInfo(AVFormatContext* formatCtx, const std::string& path);
+
+    /**
+     * @brief 取文件的探测结果，未缓存时打开文件探测一次
+     * @return 文件无法打开或探测失败返回nullptr
+     */
+    std::shared_ptr<const ProbeResult> probe(const std::string& path);
+
+    /**
+     * @brief 设置落盘目录（空表示只用内存缓存）
+     */
+    void setDiskCacheDir(const std::string& dir);
+    void setCapacity(size_t entries);
+
+    void invalidate(const std::string& path);
+    void clear();
+
+    struct Statistics {
+        uint64_t hits = 0;          // 内存命中
+        uint64_t diskHits = 0;      // 落盘命中
+        uint64_t misses = 0;        // 实际探测次数
+    };
+
+    Statistics getStatistics() const;
+
+private:
+    ProbeCache() = default;
+
+    struct Entry {
+        std::shared_ptr<const ProbeResult> result;
+        uint64_t lastUse = 0;
+    };
+
+    bool runProbe(AVFormatContext* formatCtx, const std::string& path, bool cacheable, uint64_t size,
+                  int64_t mtimeNs, std::shared_ptr<const ProbeResult>* probed);
+    std::shared_ptr<const ProbeResult> lookup(const std::string& path, uint64_t size, int64_t mtimeNs);
+    void store(const std::string& path, const std::shared_ptr<const ProbeResult>& result);
+    std::string diskPath(const std::string& path) const;
+    std::shared_ptr<const ProbeResult> loadFromDisk(const std::string& path, uint64_t size, int64_t mtimeNs) const;
+    void saveToDisk(const std::string& path, const ProbeResult& result) const;
+
+    static std::shared_ptr<const ProbeResult> capture(const AVFormatContext* formatCtx, uint64_t size, int64_t mtimeNs);
+    static bool apply(const ProbeResult& result, AVFormatContext* formatCtx);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::string diskDir_;
+    size_t capacity_ = 256;
+    uint64_t tick_ = 0;
+    Statistics stats_;
+};
@@ -4,6 +4,10 @@
 #include <vector>
 #include <mutex>
 #include "../../DataStruct/FrameData.h"
+#include "../../Utils/MemoryTracker.h"
+#include "../../Utils/ScalerCache.h"
+#include "InputReader.h"
+#include "KeyframeIndex.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -19,6 +23,11 @@ struct VideoDecoderConfig {
     int maxHeight = 0;                        // 最大高度（0表示不限制）
     bool enableHardwareAccel = false;         // 是否启用硬件加速
     int threadCount = 0;                      // 解码线程数（0表示自动）
+    int numaNode = -1;                        // 解码线程绑定的NUMA节点（-1表示不绑定）
+    int swsThreads = 1;                       // 色彩转换并行带数（1表示单线程，0表示按帧尺寸自动；分带有色度接缝）
+    InputReaderConfig input;                  // 输入读取方式（mmap/预读线程/默认I/O）
+    bool accurateSeek = true;                 // 精确定位：从前一关键帧解码前进到目标帧
+    bool persistKeyframeIndex = false;        // 关键帧索引保存为输入旁的.kfidx文件，下次打开直接加载
 };
 
 // 视频信息
@@ -56,6 +65,10 @@ public:
     bool seekToTime(double seconds);
     bool seekToFrame(int64_t frameNumber);
     
+    // 关键帧索引（按帧号定位时自动建立；分块并行处理可据此切分）
+    bool buildKeyframeIndex();
+    const KeyframeIndex& getKeyframeIndex() const { return keyframeIndex_; }
+    
     // 配置和控制
     void setThreadSafe(bool enable) { threadSafe_ = enable; }
     void setConfig(const VideoDecoderConfig& config) { config_ = config; }
@@ -69,16 +82,22 @@ public:
 private:
     // 内部方法
     bool initDecoder();
-    bool initSwsContext();
     void cleanup();
-    bool processPacket(FrameData& frame);
+    void closeInput();
+    bool decodeFrame();
+    bool convertFrame(FrameData& frame, int64_t pts);
+    bool seekToPts(int64_t targetPts, int64_t frameNumber);
+    bool ensureKeyframeIndex();
     
     // FFmpeg组件
     AVFormatContext* formatCtx_ = nullptr;
+    AVIOContext* inputIO_ = nullptr;          // 自定义输入I/O（为空时用FFmpeg默认文件I/O）
     AVCodecContext* codecCtx_ = nullptr;
     AVPacket* packet_ = nullptr;
     AVFrame* frame_ = nullptr;
-    SwsContext* swsCtx_ = nullptr;
+    ScalerCache scaler_;                      // 按帧尺寸/格式缓存的转换上下文（流中途变分辨率时复用）
+    AVPixelFormat outputFormat_ = AV_PIX_FMT_BGR24;
+    MemoryTracker::TrackedBuffer frameMemory_{MemoryTracker::Source::FFmpeg};  // 解码器持有的帧缓冲
     
     // 配置和状态
     VideoDecoderConfig config_;
@@ -87,8 +106,15 @@ private:
     bool opened_ = false;
     int videoStreamIndex_ = -1;
     double currentTime_ = 0.0;
+    int64_t originPts_ = 0;                   // 文件起始时间（流时间基）：输出时间戳以此为零点，与音频共用同一原点
     int64_t currentFrame_ = 0;
     
+    // 精确定位
+    std::string filepath_;
+    KeyframeIndex keyframeIndex_;
+    bool indexAttempted_ = false;             // 建索引失败后不再重试
+    int64_t skipUntilPts_ = AV_NOPTS_VALUE;   // seek后丢弃PTS小于此值的帧
+    
     // 线程安全
     bool threadSafe_ = false;
     mutable std::mutex mutex_;
@@ -1,5 +1,8 @@
 #include "../include/AudioDecoder.h"
+#include "../include/ProbeCache.h"
 #include "../../Utils/Logger.h"
+#include "../../Utils/Metrics.h"
+#include "../../Utils/Trace.h"
 #include <cstring>
 
 extern "C" {
@@ -78,16 +81,29 @@ bool AudioDecoder::open(const std::string& filepath) {
         close();
     }
     
-    // 打开文件
+    // 打开文件：本地文件走自定义输入I/O（mmap或预读线程），否则用FFmpeg默认I/O
+    inputIO_ = InputReader::createIOContext(filepath, config_.input);
+    if (inputIO_) {
+        formatCtx_ = avformat_alloc_context();
+        if (!formatCtx_) {
+            LOG_ERROR("无法分配格式上下文");
+            InputReader::freeIOContext(&inputIO_);
+            return false;
+        }
+        formatCtx_->pb = inputIO_;
+        formatCtx_->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
     if (avformat_open_input(&formatCtx_, filepath.c_str(), nullptr, nullptr) < 0) {
+        // 失败时formatCtx_已被释放，自定义I/O需自行释放
+        InputReader::freeIOContext(&inputIO_);
         LOG_ERROR("无法打开音频文件: " + filepath);
         return false;
     }
     
-    // 查找流信息
-    if (avformat_find_stream_info(formatCtx_, nullptr) < 0) {
+    // 查找流信息（同一文件再次打开时由探测缓存直接填充）
+    if (!ProbeCache::getInstance().findStreamInfo(formatCtx_, filepath)) {
         LOG_ERROR("无法找到流信息");
-        avformat_close_input(&formatCtx_);
+        closeInput();
         return false;
     }
     
@@ -102,30 +118,40 @@ bool AudioDecoder::open(const std::string& filepath) {
     
     if (audioStreamIndex_ == -1) {
         LOG_WARNING("未找到音频流");
-        avformat_close_input(&formatCtx_);
+        closeInput();
         return false;
     }
     
-    if (!initDecoder()) {
-        avformat_close_input(&formatCtx_);
+    // 直通模式不需要解码器
+    if (!config_.passthrough && !initDecoder()) {
+        closeInput();
         return false;
     }
     
-    // 填充音频信息
+    // 填充音频信息（直通模式没有解码器上下文，直接取流参数）
     AVStream* stream = formatCtx_->streams[audioStreamIndex_];
-    audioInfo_.sampleRate = codecCtx_->sample_rate;
-    audioInfo_.channels = codecCtx_->channels;
+    const AVCodecParameters* codecpar = stream->codecpar;
+    audioInfo_.sampleRate = codecpar->sample_rate;
+    audioInfo_.channels = codecpar->channels;
     audioInfo_.duration = formatCtx_->duration / (double)AV_TIME_BASE;
     audioInfo_.totalSamples = stream->nb_frames;
-    audioInfo_.codecName = avcodec_get_name(codecCtx_->codec_id);
-    audioInfo_.sampleFormat = av_get_sample_fmt_name(codecCtx_->sample_fmt);
-    audioInfo_.bitRate = codecCtx_->bit_rate;
+    audioInfo_.codecName = avcodec_get_name(codecpar->codec_id);
+    const char* sampleFormat = av_get_sample_fmt_name(static_cast<AVSampleFormat>(codecpar->format));
+    audioInfo_.sampleFormat = sampleFormat ? sampleFormat : "";
+    audioInfo_.bitRate = codecpar->bit_rate;
+    // 以整个文件的起始时间为零点（与视频解码器相同），音视频起始时间不同时保留原有的偏移
+    if (formatCtx_->start_time != AV_NOPTS_VALUE) {
+        startPts_ = av_rescale_q(formatCtx_->start_time, AV_TIME_BASE_Q, stream->time_base);
+    } else {
+        startPts_ = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    }
     
     opened_ = true;
     currentTime_ = 0.0;
     currentSample_ = 0;
     
-    LOG_INFO("音频解码器打开成功: " + std::to_string(audioInfo_.sampleRate) + "Hz " + 
+    LOG_INFO(std::string(config_.passthrough ? "音频直通打开成功: " : "音频解码器打开成功: ") +
+             audioInfo_.codecName + " " + std::to_string(audioInfo_.sampleRate) + "Hz " +
              std::to_string(audioInfo_.channels) + "ch");
     
     return true;
@@ -155,13 +181,13 @@ void AudioDecoder::close() {
     
     // 3. 最后关闭格式上下文
     if (formatCtx_) {
-        avformat_close_input(&formatCtx_);
-        formatCtx_ = nullptr;
+        closeInput();
         LOG_DEBUG("AudioFormatContext已释放");
     }
     
     // 4. 重置状态
     audioStreamIndex_ = -1;
+    startPts_ = 0;
     opened_ = false;
     currentTime_ = 0.0;
     currentSample_ = 0;
@@ -207,9 +233,24 @@ std::vector<AudioFrameData> AudioDecoder::getAllFrames() {
 }
 
 bool AudioDecoder::readNextFrame(AudioFrameData& frameData) {
+    TRACE_SCOPE("AudioDecoder::readNextFrame", "decode");
     if (!opened_) return false;
+    if (!codecCtx_) {
+        LOG_ERROR("直通模式下没有解码器，请使用readNextPacket");
+        return false;
+    }
     
-    while (av_read_frame(formatCtx_, packet_) >= 0) {
+    while (true) {
+        int ret;
+        {
+            METRICS_SCOPED_TIMER("audio_demux_us");
+            ret = av_read_frame(formatCtx_, packet_);
+        }
+        if (ret < 0) {
+            break;
+        }
+        METRICS_COUNTER_ADD("audio_demux_bytes", packet_->size);
+        
         if (packet_->stream_index == audioStreamIndex_) {
             if (processPacket(frameData)) {
                 av_packet_unref(packet_);
@@ -226,17 +267,70 @@ bool AudioDecoder::seekToTime(double seconds) {
     if (!opened_) return false;
     
     AVStream* stream = formatCtx_->streams[audioStreamIndex_];
-    int64_t timestamp = av_rescale_q(seconds * AV_TIME_BASE, AV_TIME_BASE_Q, stream->time_base);
+    int64_t timestamp = av_rescale_q(seconds * AV_TIME_BASE, AV_TIME_BASE_Q, stream->time_base) + startPts_;
     
     if (av_seek_frame(formatCtx_, audioStreamIndex_, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
         return false;
     }
     
-    avcodec_flush_buffers(codecCtx_);
+    if (codecCtx_) {
+        avcodec_flush_buffers(codecCtx_);
+    }
     currentTime_ = seconds;
     return true;
 }
 
+bool AudioDecoder::readNextPacket(AVPacket* packet) {
+    TRACE_SCOPE("AudioDecoder::readNextPacket", "decode");
+    if (!opened_ || !packet) return false;
+    
+    while (true) {
+        int ret;
+        {
+            METRICS_SCOPED_TIMER("audio_demux_us");
+            ret = av_read_frame(formatCtx_, packet_);
+        }
+        if (ret < 0) {
+            return false;
+        }
+        METRICS_COUNTER_ADD("audio_demux_bytes", packet_->size);
+        
+        if (packet_->stream_index != audioStreamIndex_) {
+            av_packet_unref(packet_);
+            continue;
+        }
+        
+        // 以文件起始时间为零点，与视频时间戳同一原点
+        if (packet_->pts != AV_NOPTS_VALUE) {
+            packet_->pts -= startPts_;
+        }
+        if (packet_->dts != AV_NOPTS_VALUE) {
+            packet_->dts -= startPts_;
+        }
+        
+        AVStream* stream = formatCtx_->streams[audioStreamIndex_];
+        int64_t ts = packet_->pts != AV_NOPTS_VALUE ? packet_->pts : packet_->dts;
+        if (ts != AV_NOPTS_VALUE) {
+            currentTime_ = ts * av_q2d(stream->time_base);
+        }
+        METRICS_COUNTER_ADD("audio_passthrough_packets", 1);
+        
+        av_packet_unref(packet);
+        av_packet_move_ref(packet, packet_);
+        return true;
+    }
+}
+
+const AVCodecParameters* AudioDecoder::getCodecParameters() const {
+    if (!opened_) return nullptr;
+    return formatCtx_->streams[audioStreamIndex_]->codecpar;
+}
+
+AVRational AudioDecoder::getTimeBase() const {
+    if (!opened_) return AVRational{0, 1};
+    return formatCtx_->streams[audioStreamIndex_]->time_base;
+}
+
 bool AudioDecoder::seekToSample(int64_t sampleNumber) {
     if (!opened_) return false;
     
@@ -320,14 +414,24 @@ void AudioDecoder::cleanup() {
     LOG_DEBUG("AudioDecoder资源清理完成");
 }
 
+void AudioDecoder::closeInput() {
+    avformat_close_input(&formatCtx_);
+    // 自定义I/O不随格式上下文释放
+    InputReader::freeIOContext(&inputIO_);
+}
+
 bool AudioDecoder::processPacket(AudioFrameData& frameData) {
-    if (avcodec_send_packet(codecCtx_, packet_) != 0) {
-        return false;
-    }
-    
-    if (avcodec_receive_frame(codecCtx_, frame_) != 0) {
-        return false;
+    {
+        METRICS_SCOPED_TIMER("audio_decode_us");
+        if (avcodec_send_packet(codecCtx_, packet_) != 0) {
+            return false;
+        }
+        
+        if (avcodec_receive_frame(codecCtx_, frame_) != 0) {
+            return false;
+        }
     }
+    METRICS_COUNTER_ADD("audio_decoded_frames", 1);
     
     if (!swrCtx_) {
         if (!initSwrContext()) {
@@ -346,8 +450,12 @@ bool AudioDecoder::processPacket(AudioFrameData& frameData) {
     uint8_t* outputBuffer = frameData.data.data();
     
     // 重采样
-    int convertedSamples = swr_convert(swrCtx_, &outputBuffer, outputSamples,
-                                      (const uint8_t**)frame_->data, frame_->nb_samples);
+    int convertedSamples;
+    {
+        METRICS_SCOPED_TIMER("audio_resample_us");
+        convertedSamples = swr_convert(swrCtx_, &outputBuffer, outputSamples,
+                                       (const uint8_t**)frame_->data, frame_->nb_samples);
+    }
     
     if (convertedSamples < 0) {
         LOG_ERROR("音频重采样失败");
@@ -364,7 +472,7 @@ bool AudioDecoder::processPacket(AudioFrameData& frameData) {
     frameData.nbSamples = convertedSamples;
     frameData.duration = (double)convertedSamples / config_.outputSampleRate;
     frameData.pts = frame_->pts;
-    frameData.timestamp = frame_->pts * av_q2d(stream->time_base);
+    frameData.timestamp = (frame_->pts - startPts_) * av_q2d(stream->time_base);
     frameData.format = av_get_sample_fmt_name(config_.outputFormat);
     frameData.encoded = false;
     
@@ -1,4 +1,5 @@
 #include "../include/Decoder.h"
+#include "../include/ProbeCache.h"
 #include "../../Utils/Logger.h"
 #include <filesystem>
 
@@ -282,40 +283,22 @@ bool Decoder::analyzeFile(const std::string& filepath) {
     mediaInfo_.filename = std::filesystem::path(filepath).filename().string();
     mediaInfo_.fileSize = std::filesystem::file_size(filepath);
     
-    // 使用FFmpeg分析文件
-    AVFormatContext* formatCtx = nullptr;
-    if (avformat_open_input(&formatCtx, filepath.c_str(), nullptr, nullptr) < 0) {
-        LOG_ERROR("无法打开文件进行分析: " + filepath);
-        return false;
-    }
-    
-    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
-        LOG_ERROR("无法获取流信息");
-        avformat_close_input(&formatCtx);
+    // 使用FFmpeg分析文件（结果进入探测缓存，随后打开的视频/音频解码器不再重复探测）
+    auto probed = ProbeCache::getInstance().probe(filepath);
+    if (!probed) {
+        LOG_ERROR("无法分析文件: " + filepath);
         return false;
     }
     
     // 分析流类型
-    mediaInfo_.hasVideo = false;
-    mediaInfo_.hasAudio = false;
-    
-    for (unsigned int i = 0; i < formatCtx->nb_streams; i++) {
-        AVCodecParameters* codecpar = formatCtx->streams[i]->codecpar;
-        
-        if (codecpar->codec_type == AVMEDIA_TYPE_VIDEO && !mediaInfo_.hasVideo) {
-            mediaInfo_.hasVideo = true;
-        } else if (codecpar->codec_type == AVMEDIA_TYPE_AUDIO && !mediaInfo_.hasAudio) {
-            mediaInfo_.hasAudio = true;
-        }
-    }
+    mediaInfo_.hasVideo = probed->findStream(AVMEDIA_TYPE_VIDEO) >= 0;
+    mediaInfo_.hasAudio = probed->findStream(AVMEDIA_TYPE_AUDIO) >= 0;
     
     // 获取总时长
-    if (formatCtx->duration != AV_NOPTS_VALUE) {
-        mediaInfo_.duration = formatCtx->duration / (double)AV_TIME_BASE;
+    if (probed->duration != AV_NOPTS_VALUE) {
+        mediaInfo_.duration = probed->duration / (double)AV_TIME_BASE;
     }
     
-    avformat_close_input(&formatCtx);
-    
     LOG_DEBUG("文件分析完成: " + mediaInfo_.filename + 
               " 时长:" + std::to_string(mediaInfo_.duration) + "s " +
               "视频:" + (mediaInfo_.hasVideo ? "有" : "无") + " " +
@@ -0,0 +1,432 @@
+#include "../include/InputReader.h"
+#include "../../Utils/Logger.h"
+#include "../../Utils/Metrics.h"
+#include "../../Utils/Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kAlignment = 4096;
+
+double elapsedMs(Clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+}
+
+// 每个AVIOContext一个游标，共享同一个读取器
+struct IOCursor {
+    std::shared_ptr<InputReader> reader;
+    int64_t position = 0;
+};
+
+int readPacket(void* opaque, uint8_t* buf, int size) {
+    auto* cursor = static_cast<IOCursor*>(opaque);
+    int n = cursor->reader->read(cursor->position, buf, size);
+    if (n < 0) {
+        return AVERROR(EIO);
+    }
+    if (n == 0) {
+        return AVERROR_EOF;
+    }
+    cursor->position += n;
+    return n;
+}
+
+int64_t seekCursor(void* opaque, int64_t offset, int whence) {
+    auto* cursor = static_cast<IOCursor*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return cursor->reader->size();
+    }
+    int64_t target;
+    switch (whence & ~AVSEEK_FORCE) {
+        case SEEK_SET: target = offset; break;
+        case SEEK_CUR: target = cursor->position + offset; break;
+        case SEEK_END: target = cursor->reader->size() + offset; break;
+        default: return -1;
+    }
+    if (target < 0) {
+        return -1;
+    }
+    cursor->position = target;
+    return target;
+}
+
+std::mutex& registryMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<std::string, std::weak_ptr<InputReader>>& registry() {
+    static std::unordered_map<std::string, std::weak_ptr<InputReader>> readers;
+    return readers;
+}
+
+} // namespace
+
+InputReader::InputReader(const std::string& path, const InputReaderConfig& config)
+    : path_(path), config_(config) {
+    config_.blockSize = std::max(config_.blockSize, kAlignment);
+    config_.blockSize = (config_.blockSize + kAlignment - 1) / kAlignment * kAlignment;
+    config_.readAheadBlocks = std::max<size_t>(config_.readAheadBlocks, 1);
+    config_.ioThreads = std::max(config_.ioThreads, 1);
+}
+
+InputReader::~InputReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    loadCv_.notify_all();
+    for (auto& loader : loaders_) {
+        if (loader.joinable()) {
+            loader.join();
+        }
+    }
+    for (auto& block : storage_) {
+        std::free(block->data);
+    }
+    if (map_) {
+        munmap(map_, static_cast<size_t>(size_));
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+
+    LOG_DEBUG("InputReader closed " + path_ + ": " + std::to_string(stats_.bytesRead) + " bytes, " +
+              std::to_string(stats_.blockLoads) + " block loads, " + std::to_string(stats_.cacheMisses) +
+              " misses, io wait " + std::to_string(stats_.ioWaitMs) + "ms");
+}
+
+std::shared_ptr<InputReader> InputReader::acquire(const std::string& path, const InputReaderConfig& config) {
+    if (config.mode == InputReadMode::Default) {
+        return nullptr;
+    }
+
+    std::string key = std::to_string(static_cast<int>(config.mode)) + ":" + path;
+    std::lock_guard<std::mutex> lock(registryMutex());
+    auto& readers = registry();
+    auto it = readers.find(key);
+    if (it != readers.end()) {
+        if (auto reader = it->second.lock()) {
+            return reader;
+        }
+        readers.erase(it);
+    }
+
+    std::shared_ptr<InputReader> reader(new InputReader(path, config));
+    if (!reader->open()) {
+        return nullptr;
+    }
+    readers[key] = reader;
+    return reader;
+}
+
+AVIOContext* InputReader::createIOContext(const std::string& path, const InputReaderConfig& config) {
+    auto reader = acquire(path, config);
+    if (!reader) {
+        return nullptr;
+    }
+
+    int bufferSize = std::max(config.avioBufferSize, 4096);
+    auto* buffer = static_cast<unsigned char*>(av_malloc(bufferSize));
+    if (!buffer) {
+        LOG_ERROR("InputReader: failed to allocate AVIO buffer");
+        return nullptr;
+    }
+    auto* cursor = new IOCursor{reader, 0};
+    AVIOContext* context = avio_alloc_context(buffer, bufferSize, 0, cursor, readPacket, nullptr, seekCursor);
+    if (!context) {
+        LOG_ERROR("InputReader: failed to allocate AVIOContext");
+        av_free(buffer);
+        delete cursor;
+        return nullptr;
+    }
+    return context;
+}
+
+void InputReader::freeIOContext(AVIOContext** context) {
+    if (!context || !*context) {
+        return;
+    }
+    delete static_cast<IOCursor*>((*context)->opaque);
+    // 缓冲可能已被FFmpeg重新分配，以上下文里的为准
+    av_freep(&(*context)->buffer);
+    avio_context_free(context);
+}
+
+bool InputReader::open() {
+    fd_ = ::open(path_.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+        // 可能是URL等非本地路径，交给FFmpeg默认I/O
+        LOG_DEBUG("InputReader: " + path_ + " is not a local file, using default I/O");
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || !S_ISREG(st.st_mode)) {
+        LOG_DEBUG("InputReader: " + path_ + " is not a regular file, using default I/O");
+        return false;
+    }
+    size_ = st.st_size;
+    posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (config_.mode == InputReadMode::Mmap && size_ > 0) {
+        void* map = mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (map == MAP_FAILED) {
+            LOG_WARNING("InputReader: mmap failed for " + path_ + " (" + std::strerror(errno) +
+                        "), using read-ahead");
+            config_.mode = InputReadMode::ReadAhead;
+        } else {
+            map_ = static_cast<uint8_t*>(map);
+            madvise(map_, static_cast<size_t>(size_), MADV_SEQUENTIAL);
+        }
+    }
+
+    if (config_.mode == InputReadMode::ReadAhead) {
+        blockCount_ = (size_ + static_cast<int64_t>(config_.blockSize) - 1) / static_cast<int64_t>(config_.blockSize);
+        // 视频、音频两个游标可能各自占一个预读窗口
+        capacity_ = config_.readAheadBlocks * 2 + 2;
+        for (int i = 0; i < config_.ioThreads; ++i) {
+            loaders_.emplace_back(&InputReader::loaderLoop, this);
+        }
+    }
+
+    LOG_DEBUG("InputReader opened " + path_ + " (" + std::to_string(size_ >> 20) + "MiB, " +
+              (map_ ? std::string("mmap") : "read-ahead " + std::to_string(config_.readAheadBlocks) + "x" +
+               std::to_string(config_.blockSize >> 10) + "KiB") + ")");
+    return true;
+}
+
+int InputReader::read(int64_t offset, uint8_t* dst, int size) {
+    if (offset < 0 || size <= 0) {
+        return offset < 0 ? -1 : 0;
+    }
+    if (offset >= size_) {
+        return 0;
+    }
+    return map_ ? readMapped(offset, dst, size) : readCached(offset, dst, size);
+}
+
+int InputReader::readMapped(int64_t offset, uint8_t* dst, int size) {
+    int n = static_cast<int>(std::min<int64_t>(size, size_ - offset));
+
+    // 游标接近已预取区域末尾（或seek离开该区域）时，提示内核预取游标后面一个窗口
+    int64_t window = static_cast<int64_t>(config_.blockSize * config_.readAheadBlocks);
+    int64_t advisedEnd = advisedEnd_.load(std::memory_order_relaxed);
+    if (offset + static_cast<int64_t>(config_.blockSize) > advisedEnd || offset < advisedEnd - window) {
+        int64_t start = offset / static_cast<int64_t>(kAlignment) * static_cast<int64_t>(kAlignment);
+        int64_t length = std::min<int64_t>(window, size_ - start);
+        madvise(map_ + start, static_cast<size_t>(length), MADV_WILLNEED);
+        advisedEnd_.store(start + length, std::memory_order_relaxed);
+    }
+
+    std::memcpy(dst, map_ + offset, static_cast<size_t>(n));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytesRead += static_cast<uint64_t>(n);
+    return n;
+}
+
+int InputReader::readCached(int64_t offset, uint8_t* dst, int size) {
+    TRACE_SCOPE("InputReader::read", "demux");
+    int64_t index = offset / static_cast<int64_t>(config_.blockSize);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    scheduleLocked(index);
+    Block* block = obtainBlockLocked(index, true);
+    // 等待加载期间也要占住块：加载完成后、本线程醒来前，其他游标可能把空闲的块淘汰另作他用
+    ++block->pins;
+
+    if (block->state == BlockState::Loading) {
+        // 预读没跟上：还在队列里就自己读，已在读就等预读线程
+        METRICS_COUNTER_ADD("demux_io_stalls", 1);
+        ++stats_.cacheMisses;
+        auto start = Clock::now();
+        auto queued = std::find(loadQueue_.begin(), loadQueue_.end(), block);
+        if (queued != loadQueue_.end()) {
+            loadQueue_.erase(queued);
+            lock.unlock();
+            bool ok = loadBlock(block);
+            lock.lock();
+            block->state = ok ? BlockState::Ready : BlockState::Failed;
+            readyCv_.notify_all();
+        } else {
+            readyCv_.wait(lock, [block] { return block->state != BlockState::Loading; });
+        }
+        stats_.ioWaitMs += elapsedMs(start);
+    } else {
+        ++stats_.cacheHits;
+    }
+
+    if (block->state == BlockState::Failed) {
+        --block->pins;
+        // 从缓存中移除，下次读取时重试
+        if (block->index == index && block->pins == 0) {
+            blocks_.erase(index);
+            block->index = -1;
+        }
+        return -1;
+    }
+
+    size_t inner = static_cast<size_t>(offset - index * static_cast<int64_t>(config_.blockSize));
+    if (inner >= block->size) {
+        --block->pins;
+        return 0;
+    }
+    lock.unlock();
+
+    size_t n = std::min(static_cast<size_t>(size), block->size - inner);
+    std::memcpy(dst, block->data + inner, n);
+
+    lock.lock();
+    --block->pins;
+    stats_.bytesRead += n;
+    return static_cast<int>(n);
+}
+
+InputReader::Block* InputReader::obtainBlockLocked(int64_t index, bool demand) {
+    auto it = blocks_.find(index);
+    if (it != blocks_.end()) {
+        return it->second;
+    }
+
+    Block* block = nullptr;
+    if (storage_.size() < capacity_) {
+        storage_.push_back(std::make_unique<Block>());
+        block = storage_.back().get();
+    } else {
+        // 淘汰最久未用且空闲的块
+        for (auto& candidate : storage_) {
+            if (candidate->state != BlockState::Loading && candidate->pins == 0 &&
+                (!block || candidate->lastUse < block->lastUse)) {
+                block = candidate.get();
+            }
+        }
+        if (!block) {
+            if (!demand) {
+                return nullptr;
+            }
+            // 全部在读或被占用：demux读不能失败，临时超出容量
+            storage_.push_back(std::make_unique<Block>());
+            block = storage_.back().get();
+        }
+        if (block->index >= 0) {
+            blocks_.erase(block->index);
+        }
+    }
+
+    block->index = index;
+    block->size = 0;
+    block->state = BlockState::Loading;
+    block->lastUse = ++tick_;
+    blocks_[index] = block;
+    return block;
+}
+
+void InputReader::scheduleLocked(int64_t firstIndex) {
+    int64_t last = std::min<int64_t>(firstIndex + static_cast<int64_t>(config_.readAheadBlocks), blockCount_);
+    bool queued = false;
+    for (int64_t index = firstIndex; index < last; ++index) {
+        auto it = blocks_.find(index);
+        if (it != blocks_.end()) {
+            // 窗口内的块刷新使用时间，避免先于游标后方已读过的块被淘汰
+            it->second->lastUse = ++tick_;
+            continue;
+        }
+        Block* block = obtainBlockLocked(index, false);
+        if (!block) {
+            break;
+        }
+        loadQueue_.push_back(block);
+        queued = true;
+    }
+    if (queued) {
+        METRICS_GAUGE_SET("demux_io_queue_depth", loadQueue_.size());
+        loadCv_.notify_all();
+    }
+}
+
+bool InputReader::loadBlock(Block* block) {
+    TRACE_SCOPE("InputReader::loadBlock", "demux");
+    if (!block->data) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kAlignment, config_.blockSize) != 0) {
+            LOG_ERROR("InputReader: failed to allocate " + std::to_string(config_.blockSize) + " byte block");
+            return false;
+        }
+        block->data = static_cast<uint8_t*>(memory);
+    }
+
+    // Loading状态的块不会被淘汰，index在此期间不变
+    int64_t offset = block->index * static_cast<int64_t>(config_.blockSize);
+    size_t expected = static_cast<size_t>(std::min<int64_t>(config_.blockSize, size_ - offset));
+    auto start = Clock::now();
+    size_t loaded = 0;
+    bool failed = false;
+    while (loaded < expected) {
+        ssize_t n = pread(fd_, block->data + loaded, expected - loaded, offset + static_cast<int64_t>(loaded));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("InputReader: read failed for " + path_ + " at offset " + std::to_string(offset + loaded) +
+                      ": " + std::strerror(errno));
+            failed = true;
+            break;
+        }
+        if (n == 0) {
+            break;  // 文件被截短
+        }
+        loaded += static_cast<size_t>(n);
+    }
+    block->size = loaded;
+    double ms = elapsedMs(start);
+    METRICS_COUNTER_ADD("demux_io_bytes", loaded);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.blockLoads;
+    stats_.loadMs += ms;
+    return !failed;
+}
+
+void InputReader::loaderLoop() {
+    Tracer::getInstance().setThreadName("demux-reader");
+    while (true) {
+        Block* block = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            loadCv_.wait(lock, [this] { return stopping_ || !loadQueue_.empty(); });
+            if (stopping_) {
+                return;
+            }
+            block = loadQueue_.front();
+            loadQueue_.pop_front();
+        }
+
+        bool ok = loadBlock(block);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            block->state = ok ? BlockState::Ready : BlockState::Failed;
+        }
+        readyCv_.notify_all();
+    }
+}
+
+InputReader::Statistics InputReader::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
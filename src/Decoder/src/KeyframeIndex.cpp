@@ -0,0 +1,217 @@
+#include "../include/KeyframeIndex.h"
+#include "../../Utils/Logger.h"
+#include "../../Utils/Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+// 索引文件头，后跟 frameCount 个帧PTS 和 keyframeCount 个关键帧PTS（int64，本机字节序）
+struct SidecarHeader {
+    char magic[8];
+    uint64_t mediaSize;
+    int64_t mediaMtimeNs;
+    int32_t timeBaseNum;
+    int32_t timeBaseDen;
+    uint64_t frameCount;
+    uint64_t keyframeCount;
+};
+
+// 02起修改时间精确到纳秒；旧版本的索引按过期处理
+constexpr char kMagic[8] = {'V', 'S', 'R', 'K', 'F', 'I', '0', '2'};
+constexpr size_t kMagicVersionOffset = 6;
+
+bool mediaStat(const std::string& path, uint64_t& size, int64_t& mtimeNs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    // 整秒时间戳分辨不出同一秒内的改写
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+} // namespace
+
+bool KeyframeIndex::build(AVFormatContext* formatCtx, int streamIndex) {
+    TRACE_SCOPE("KeyframeIndex::build", "decode");
+    clear();
+    if (!formatCtx || streamIndex < 0 || streamIndex >= static_cast<int>(formatCtx->nb_streams)) {
+        return false;
+    }
+
+    AVStream* stream = formatCtx->streams[streamIndex];
+    int64_t startPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    if (av_seek_frame(formatCtx, streamIndex, startPts, AVSEEK_FLAG_BACKWARD) < 0) {
+        LOG_WARNING("KeyframeIndex: cannot rewind stream for indexing");
+        return false;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    if (!packet) {
+        LOG_ERROR("KeyframeIndex: failed to allocate packet");
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool complete = true;
+    // 只解复用不解码，扫描成本约等于顺序读一遍文件
+    while (av_read_frame(formatCtx, packet) >= 0) {
+        if (packet->stream_index == streamIndex && !(packet->flags & AV_PKT_FLAG_DISCARD)) {
+            if (packet->pts == AV_NOPTS_VALUE) {
+                complete = false;
+                av_packet_unref(packet);
+                break;
+            }
+            framePts_.push_back(packet->pts);
+            if (packet->flags & AV_PKT_FLAG_KEY) {
+                keyframePts_.push_back(packet->pts);
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+
+    if (!complete || framePts_.empty() || keyframePts_.empty()) {
+        LOG_WARNING("KeyframeIndex: stream has no usable PTS/keyframes, frame-accurate seek unavailable");
+        clear();
+        return false;
+    }
+
+    // 包按解码顺序到达，排序后即显示顺序
+    std::sort(framePts_.begin(), framePts_.end());
+    std::sort(keyframePts_.begin(), keyframePts_.end());
+    timeBase_ = stream->time_base;
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    LOG_INFO("KeyframeIndex: indexed " + std::to_string(framePts_.size()) + " frames, " +
+             std::to_string(keyframePts_.size()) + " keyframes in " + std::to_string(static_cast<int>(ms)) + "ms");
+    return true;
+}
+
+bool KeyframeIndex::load(const std::string& sidecarPath, const std::string& mediaPath) {
+    clear();
+    std::ifstream in(sidecarPath, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+
+    SidecarHeader header;
+    uint64_t mediaSize = 0;
+    int64_t mediaMtimeNs = 0;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, kMagicVersionOffset) != 0) {
+        LOG_WARNING("KeyframeIndex: ignoring invalid index file " + sidecarPath);
+        return false;
+    }
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        LOG_DEBUG("KeyframeIndex: index file " + sidecarPath + " has an old format");
+        return false;
+    }
+    if (!mediaStat(mediaPath, mediaSize, mediaMtimeNs) || header.mediaSize != mediaSize ||
+        header.mediaMtimeNs != mediaMtimeNs) {
+        LOG_DEBUG("KeyframeIndex: index file " + sidecarPath + " is stale");
+        return false;
+    }
+    if (header.frameCount == 0 || header.keyframeCount == 0 || header.keyframeCount > header.frameCount ||
+        header.timeBaseDen <= 0) {
+        LOG_WARNING("KeyframeIndex: ignoring invalid index file " + sidecarPath);
+        return false;
+    }
+
+    framePts_.resize(header.frameCount);
+    keyframePts_.resize(header.keyframeCount);
+    if (!in.read(reinterpret_cast<char*>(framePts_.data()), framePts_.size() * sizeof(int64_t)) ||
+        !in.read(reinterpret_cast<char*>(keyframePts_.data()), keyframePts_.size() * sizeof(int64_t))) {
+        LOG_WARNING("KeyframeIndex: truncated index file " + sidecarPath);
+        clear();
+        return false;
+    }
+    timeBase_ = AVRational{header.timeBaseNum, header.timeBaseDen};
+
+    LOG_DEBUG("KeyframeIndex: loaded " + std::to_string(framePts_.size()) + " frames from " + sidecarPath);
+    return true;
+}
+
+bool KeyframeIndex::save(const std::string& sidecarPath, const std::string& mediaPath) const {
+    if (empty()) {
+        return false;
+    }
+
+    SidecarHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    if (!mediaStat(mediaPath, header.mediaSize, header.mediaMtimeNs)) {
+        return false;
+    }
+    header.timeBaseNum = timeBase_.num;
+    header.timeBaseDen = timeBase_.den;
+    header.frameCount = framePts_.size();
+    header.keyframeCount = keyframePts_.size();
+
+    // 先写临时文件再重命名，避免并发打开同一输入时读到半个索引；
+    // 临时文件名按进程和线程区分，同时保存同一索引的写入方不会互相截断
+    std::string tempPath = sidecarPath + ".tmp" + std::to_string(getpid()) + "_" +
+                           std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            LOG_WARNING("KeyframeIndex: cannot write index file " + sidecarPath);
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(framePts_.data()), framePts_.size() * sizeof(int64_t));
+        out.write(reinterpret_cast<const char*>(keyframePts_.data()), keyframePts_.size() * sizeof(int64_t));
+        if (!out) {
+            LOG_WARNING("KeyframeIndex: failed writing index file " + sidecarPath);
+            out.close();
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), sidecarPath.c_str()) != 0) {
+        LOG_WARNING("KeyframeIndex: cannot write index file " + sidecarPath);
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void KeyframeIndex::clear() {
+    framePts_.clear();
+    keyframePts_.clear();
+    timeBase_ = AVRational{0, 1};
+}
+
+int64_t KeyframeIndex::framePts(int64_t frame) const {
+    if (frame < 0 || frame >= frameCount()) {
+        return AV_NOPTS_VALUE;
+    }
+    return framePts_[static_cast<size_t>(frame)];
+}
+
+int64_t KeyframeIndex::frameAtPts(int64_t pts) const {
+    auto it = std::upper_bound(framePts_.begin(), framePts_.end(), pts);
+    if (it == framePts_.begin()) {
+        return 0;
+    }
+    return static_cast<int64_t>(it - framePts_.begin()) - 1;
+}
+
+int64_t KeyframeIndex::keyframeAtOrBefore(int64_t pts) const {
+    if (keyframePts_.empty()) {
+        return AV_NOPTS_VALUE;
+    }
+    auto it = std::upper_bound(keyframePts_.begin(), keyframePts_.end(), pts);
+    if (it == keyframePts_.begin()) {
+        return keyframePts_.front();
+    }
+    return *(it - 1);
+}
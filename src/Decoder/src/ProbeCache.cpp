@@ -0,0 +1,481 @@
+#include "../include/ProbeCache.h"
+#include "../../Utils/Logger.h"
+#include "../../Utils/Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+namespace {
+
+constexpr char kMagic[8] = {'V', 'S', 'R', 'P', 'R', 'B', '0', '1'};
+
+bool fileKey(const std::string& path, uint64_t& size, int64_t& mtimeNs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+    size = static_cast<uint64_t>(st.st_size);
+    mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+    return true;
+}
+
+std::shared_ptr<AVCodecParameters> allocCodecParameters() {
+    AVCodecParameters* codecpar = avcodec_parameters_alloc();
+    if (!codecpar) {
+        return nullptr;
+    }
+    return std::shared_ptr<AVCodecParameters>(codecpar, [](AVCodecParameters* p) { avcodec_parameters_free(&p); });
+}
+
+// 落盘格式：本机字节序的定长字段，仅供同一台机器复用
+template <typename T>
+void put(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+class ByteReader {
+public:
+    explicit ByteReader(const std::string& data) : data_(data) {}
+
+    template <typename T>
+    T get() {
+        T value{};
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    bool read(void* dst, size_t size) {
+        if (!ok_ || data_.size() - pos_ < size) {
+            ok_ = false;
+            return false;
+        }
+        std::memcpy(dst, data_.data() + pos_, size);
+        pos_ += size;
+        return true;
+    }
+
+    bool ok() const { return ok_; }
+
+private:
+    const std::string& data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+void putRational(std::string& out, AVRational value) {
+    put<int32_t>(out, value.num);
+    put<int32_t>(out, value.den);
+}
+
+AVRational getRational(ByteReader& in) {
+    AVRational value;
+    value.num = in.get<int32_t>();
+    value.den = in.get<int32_t>();
+    return value;
+}
+
+void putCodecParameters(std::string& out, const AVCodecParameters* p) {
+    put<int32_t>(out, p->codec_type);
+    put<int32_t>(out, p->codec_id);
+    put<uint32_t>(out, p->codec_tag);
+    put<int32_t>(out, p->extradata_size);
+    out.append(reinterpret_cast<const char*>(p->extradata), p->extradata_size > 0 ? p->extradata_size : 0);
+    put<int32_t>(out, p->format);
+    put<int64_t>(out, p->bit_rate);
+    put<int32_t>(out, p->bits_per_coded_sample);
+    put<int32_t>(out, p->bits_per_raw_sample);
+    put<int32_t>(out, p->profile);
+    put<int32_t>(out, p->level);
+    put<int32_t>(out, p->width);
+    put<int32_t>(out, p->height);
+    putRational(out, p->sample_aspect_ratio);
+    put<int32_t>(out, p->field_order);
+    put<int32_t>(out, p->color_range);
+    put<int32_t>(out, p->color_primaries);
+    put<int32_t>(out, p->color_trc);
+    put<int32_t>(out, p->color_space);
+    put<int32_t>(out, p->chroma_location);
+    put<int32_t>(out, p->video_delay);
+    put<uint64_t>(out, p->channel_layout);
+    put<int32_t>(out, p->channels);
+    put<int32_t>(out, p->sample_rate);
+    put<int32_t>(out, p->block_align);
+    put<int32_t>(out, p->frame_size);
+    put<int32_t>(out, p->initial_padding);
+    put<int32_t>(out, p->trailing_padding);
+    put<int32_t>(out, p->seek_preroll);
+}
+
+bool getCodecParameters(ByteReader& in, AVCodecParameters* p) {
+    p->codec_type = static_cast<AVMediaType>(in.get<int32_t>());
+    p->codec_id = static_cast<AVCodecID>(in.get<int32_t>());
+    p->codec_tag = in.get<uint32_t>();
+    int32_t extradataSize = in.get<int32_t>();
+    if (!in.ok() || extradataSize < 0 || extradataSize > (64 << 20)) {
+        return false;
+    }
+    if (extradataSize > 0) {
+        p->extradata = static_cast<uint8_t*>(av_mallocz(extradataSize + AV_INPUT_BUFFER_PADDING_SIZE));
+        if (!p->extradata || !in.read(p->extradata, extradataSize)) {
+            return false;
+        }
+        p->extradata_size = extradataSize;
+    }
+    p->format = in.get<int32_t>();
+    p->bit_rate = in.get<int64_t>();
+    p->bits_per_coded_sample = in.get<int32_t>();
+    p->bits_per_raw_sample = in.get<int32_t>();
+    p->profile = in.get<int32_t>();
+    p->level = in.get<int32_t>();
+    p->width = in.get<int32_t>();
+    p->height = in.get<int32_t>();
+    p->sample_aspect_ratio = getRational(in);
+    p->field_order = static_cast<decltype(p->field_order)>(in.get<int32_t>());
+    p->color_range = static_cast<decltype(p->color_range)>(in.get<int32_t>());
+    p->color_primaries = static_cast<decltype(p->color_primaries)>(in.get<int32_t>());
+    p->color_trc = static_cast<decltype(p->color_trc)>(in.get<int32_t>());
+    p->color_space = static_cast<decltype(p->color_space)>(in.get<int32_t>());
+    p->chroma_location = static_cast<decltype(p->chroma_location)>(in.get<int32_t>());
+    p->video_delay = in.get<int32_t>();
+    p->channel_layout = in.get<uint64_t>();
+    p->channels = in.get<int32_t>();
+    p->sample_rate = in.get<int32_t>();
+    p->block_align = in.get<int32_t>();
+    p->frame_size = in.get<int32_t>();
+    p->initial_padding = in.get<int32_t>();
+    p->trailing_padding = in.get<int32_t>();
+    p->seek_preroll = in.get<int32_t>();
+    return in.ok();
+}
+
+} // namespace
+
+int ProbeResult::findStream(AVMediaType type) const {
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (streams[i].codecpar->codec_type == type) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+ProbeCache& ProbeCache::getInstance() {
+    static ProbeCache instance;
+    return instance;
+}
+
+bool ProbeCache::findStreamInfo(AVFormatContext* formatCtx, const std::string& path) {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    bool cacheable = fileKey(path, size, mtimeNs);
+    if (cacheable) {
+        auto cached = lookup(path, size, mtimeNs);
+        if (cached) {
+            if (apply(*cached, formatCtx)) {
+                return true;
+            }
+            // 容器头里的流与缓存不一致（如TS的流在探测时才出现），重新探测
+            LOG_DEBUG("ProbeCache: cached streams do not match " + path + ", probing again");
+        }
+    }
+
+    return runProbe(formatCtx, path, cacheable, size, mtimeNs, nullptr);
+}
+
+std::shared_ptr<const ProbeResult> ProbeCache::probe(const std::string& path) {
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    bool cacheable = fileKey(path, size, mtimeNs);
+    if (cacheable) {
+        if (auto cached = lookup(path, size, mtimeNs)) {
+            return cached;
+        }
+    }
+
+    AVFormatContext* formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, path.c_str(), nullptr, nullptr) < 0) {
+        return nullptr;
+    }
+    std::shared_ptr<const ProbeResult> result;
+    runProbe(formatCtx, path, cacheable, size, mtimeNs, &result);
+    avformat_close_input(&formatCtx);
+    return result;
+}
+
+bool ProbeCache::runProbe(AVFormatContext* formatCtx, const std::string& path, bool cacheable, uint64_t size,
+                          int64_t mtimeNs, std::shared_ptr<const ProbeResult>* probed) {
+    {
+        METRICS_SCOPED_TIMER("probe_stream_info_us");
+        if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+            return false;
+        }
+    }
+    METRICS_COUNTER_ADD("probe_cache_misses", 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.misses;
+    }
+
+    auto result = capture(formatCtx, size, mtimeNs);
+    if (result && cacheable) {
+        store(path, result);
+        saveToDisk(path, *result);
+    }
+    if (probed) {
+        *probed = result;
+    }
+    return true;
+}
+
+void ProbeCache::setDiskCacheDir(const std::string& dir) {
+    if (!dir.empty()) {
+        mkdir(dir.c_str(), 0755);
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    diskDir_ = dir;
+}
+
+void ProbeCache::setCapacity(size_t entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max<size_t>(entries, 1);
+}
+
+void ProbeCache::invalidate(const std::string& path) {
+    std::string file = diskPath(path);
+    if (!file.empty()) {
+        std::remove(file.c_str());
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.erase(path);
+}
+
+void ProbeCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+ProbeCache::Statistics ProbeCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::shared_ptr<const ProbeResult> ProbeCache::lookup(const std::string& path, uint64_t size, int64_t mtimeNs) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(path);
+        if (it != entries_.end()) {
+            const auto& result = it->second.result;
+            if (result->fileSize == size && result->mtimeNs == mtimeNs) {
+                it->second.lastUse = ++tick_;
+                ++stats_.hits;
+                METRICS_COUNTER_ADD("probe_cache_hits", 1);
+                return result;
+            }
+            entries_.erase(it);
+        }
+    }
+
+    auto result = loadFromDisk(path, size, mtimeNs);
+    if (result) {
+        store(path, result);
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.diskHits;
+        METRICS_COUNTER_ADD("probe_cache_disk_hits", 1);
+    }
+    return result;
+}
+
+void ProbeCache::store(const std::string& path, const std::shared_ptr<const ProbeResult>& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (entries_.size() >= capacity_ && entries_.find(path) == entries_.end()) {
+        // 淘汰最久未用的条目
+        auto oldest = entries_.begin();
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->second.lastUse < oldest->second.lastUse) {
+                oldest = it;
+            }
+        }
+        entries_.erase(oldest);
+    }
+    entries_[path] = Entry{result, ++tick_};
+}
+
+std::string ProbeCache::diskPath(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (diskDir_.empty()) {
+        return std::string();
+    }
+    std::ostringstream name;
+    name << diskDir_ << '/' << std::hex << std::hash<std::string>{}(path) << ".probe";
+    return name.str();
+}
+
+std::shared_ptr<const ProbeResult> ProbeCache::loadFromDisk(const std::string& path, uint64_t size,
+                                                            int64_t mtimeNs) const {
+    std::string file = diskPath(path);
+    if (file.empty()) {
+        return nullptr;
+    }
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        return nullptr;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    ByteReader reader(data);
+    char magic[sizeof(kMagic)];
+    if (!reader.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return nullptr;
+    }
+    uint32_t pathLength = reader.get<uint32_t>();
+    std::string storedPath(reader.ok() && pathLength <= data.size() ? pathLength : 0, '\0');
+    if (!reader.read(&storedPath[0], storedPath.size()) || storedPath != path) {
+        return nullptr;  // 哈希冲突或损坏
+    }
+
+    auto result = std::make_shared<ProbeResult>();
+    result->fileSize = reader.get<uint64_t>();
+    result->mtimeNs = reader.get<int64_t>();
+    if (!reader.ok() || result->fileSize != size || result->mtimeNs != mtimeNs) {
+        return nullptr;  // 文件已修改
+    }
+    result->duration = reader.get<int64_t>();
+    result->startTime = reader.get<int64_t>();
+    result->bitRate = reader.get<int64_t>();
+    uint32_t streamCount = reader.get<uint32_t>();
+    if (!reader.ok() || streamCount > 1024) {
+        return nullptr;
+    }
+    for (uint32_t i = 0; i < streamCount; ++i) {
+        ProbedStream stream;
+        stream.codecpar = allocCodecParameters();
+        if (!stream.codecpar || !getCodecParameters(reader, stream.codecpar.get())) {
+            LOG_WARNING("ProbeCache: ignoring corrupt cache file " + file);
+            return nullptr;
+        }
+        stream.timeBase = getRational(reader);
+        stream.avgFrameRate = getRational(reader);
+        stream.rFrameRate = getRational(reader);
+        stream.startTime = reader.get<int64_t>();
+        stream.duration = reader.get<int64_t>();
+        stream.nbFrames = reader.get<int64_t>();
+        result->streams.push_back(std::move(stream));
+    }
+    if (!reader.ok()) {
+        LOG_WARNING("ProbeCache: ignoring corrupt cache file " + file);
+        return nullptr;
+    }
+    return result;
+}
+
+void ProbeCache::saveToDisk(const std::string& path, const ProbeResult& result) const {
+    std::string file = diskPath(path);
+    if (file.empty()) {
+        return;
+    }
+
+    std::string data(kMagic, sizeof(kMagic));
+    put<uint32_t>(data, static_cast<uint32_t>(path.size()));
+    data += path;
+    put<uint64_t>(data, result.fileSize);
+    put<int64_t>(data, result.mtimeNs);
+    put<int64_t>(data, result.duration);
+    put<int64_t>(data, result.startTime);
+    put<int64_t>(data, result.bitRate);
+    put<uint32_t>(data, static_cast<uint32_t>(result.streams.size()));
+    for (const auto& stream : result.streams) {
+        putCodecParameters(data, stream.codecpar.get());
+        putRational(data, stream.timeBase);
+        putRational(data, stream.avgFrameRate);
+        putRational(data, stream.rFrameRate);
+        put<int64_t>(data, stream.startTime);
+        put<int64_t>(data, stream.duration);
+        put<int64_t>(data, stream.nbFrames);
+    }
+
+    // 临时文件+重命名，多个进程同时写同一条目也不会读到半个文件
+    std::string tempFile = file + ".tmp" + std::to_string(getpid()) + "_" +
+                           std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream out(tempFile, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            LOG_WARNING("ProbeCache: cannot write cache file " + file);
+            out.close();
+            std::remove(tempFile.c_str());
+            return;
+        }
+    }
+    if (std::rename(tempFile.c_str(), file.c_str()) != 0) {
+        LOG_WARNING("ProbeCache: cannot write cache file " + file);
+        std::remove(tempFile.c_str());
+    }
+}
+
+std::shared_ptr<const ProbeResult> ProbeCache::capture(const AVFormatContext* formatCtx, uint64_t size,
+                                                       int64_t mtimeNs) {
+    auto result = std::make_shared<ProbeResult>();
+    result->fileSize = size;
+    result->mtimeNs = mtimeNs;
+    result->duration = formatCtx->duration;
+    result->startTime = formatCtx->start_time;
+    result->bitRate = formatCtx->bit_rate;
+    for (unsigned int i = 0; i < formatCtx->nb_streams; ++i) {
+        const AVStream* st = formatCtx->streams[i];
+        ProbedStream stream;
+        stream.codecpar = allocCodecParameters();
+        if (!stream.codecpar || avcodec_parameters_copy(stream.codecpar.get(), st->codecpar) < 0) {
+            return nullptr;
+        }
+        stream.timeBase = st->time_base;
+        stream.avgFrameRate = st->avg_frame_rate;
+        stream.rFrameRate = st->r_frame_rate;
+        stream.startTime = st->start_time;
+        stream.duration = st->duration;
+        stream.nbFrames = st->nb_frames;
+        result->streams.push_back(std::move(stream));
+    }
+    return result;
+}
+
+bool ProbeCache::apply(const ProbeResult& result, AVFormatContext* formatCtx) {
+    if (formatCtx->nb_streams != result.streams.size()) {
+        return false;
+    }
+    // 先整体校验再写入，不一致时formatCtx保持原样交给正常探测
+    for (unsigned int i = 0; i < formatCtx->nb_streams; ++i) {
+        const AVStream* st = formatCtx->streams[i];
+        const ProbedStream& cached = result.streams[i];
+        if (st->codecpar->codec_type != cached.codecpar->codec_type ||
+            (st->codecpar->codec_id != AV_CODEC_ID_NONE && st->codecpar->codec_id != cached.codecpar->codec_id) ||
+            st->time_base.num != cached.timeBase.num || st->time_base.den != cached.timeBase.den) {
+            return false;
+        }
+    }
+
+    for (unsigned int i = 0; i < formatCtx->nb_streams; ++i) {
+        AVStream* st = formatCtx->streams[i];
+        const ProbedStream& cached = result.streams[i];
+        if (avcodec_parameters_copy(st->codecpar, cached.codecpar.get()) < 0) {
+            return false;
+        }
+        st->avg_frame_rate = cached.avgFrameRate;
+        st->r_frame_rate = cached.rFrameRate;
+        st->start_time = cached.startTime;
+        st->duration = cached.duration;
+        st->nb_frames = cached.nbFrames;
+    }
+    formatCtx->duration = result.duration;
+    formatCtx->start_time = result.startTime;
+    formatCtx->bit_rate = result.bitRate;
+    return true;
+}
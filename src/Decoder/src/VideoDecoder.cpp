@@ -1,5 +1,11 @@
 #include "../include/VideoDecoder.h"
+#include "../include/ProbeCache.h"
 #include "../../Utils/Logger.h"
+#include "../../Utils/Metrics.h"
+#include "../../Utils/Trace.h"
+#include "../../Utils/CpuTopology.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 VideoDecoder::VideoDecoder() {
@@ -74,16 +80,29 @@ bool VideoDecoder::open(const std::string& filepath) {
         close();
     }
     
-    // 打开文件
+    // 打开文件：本地文件走自定义输入I/O（mmap或预读线程），否则用FFmpeg默认I/O
+    inputIO_ = InputReader::createIOContext(filepath, config_.input);
+    if (inputIO_) {
+        formatCtx_ = avformat_alloc_context();
+        if (!formatCtx_) {
+            LOG_ERROR("无法分配格式上下文");
+            InputReader::freeIOContext(&inputIO_);
+            return false;
+        }
+        formatCtx_->pb = inputIO_;
+        formatCtx_->flags |= AVFMT_FLAG_CUSTOM_IO;
+    }
     if (avformat_open_input(&formatCtx_, filepath.c_str(), nullptr, nullptr) < 0) {
+        // 失败时formatCtx_已被释放，自定义I/O需自行释放
+        InputReader::freeIOContext(&inputIO_);
         LOG_ERROR("无法打开视频文件: " + filepath);
         return false;
     }
     
-    // 查找流信息
-    if (avformat_find_stream_info(formatCtx_, nullptr) < 0) {
+    // 查找流信息（同一文件再次打开时由探测缓存直接填充）
+    if (!ProbeCache::getInstance().findStreamInfo(formatCtx_, filepath)) {
         LOG_ERROR("无法找到流信息");
-        avformat_close_input(&formatCtx_);
+        closeInput();
         return false;
     }
     
@@ -98,17 +117,23 @@ bool VideoDecoder::open(const std::string& filepath) {
     
     if (videoStreamIndex_ == -1) {
         LOG_WARNING("未找到视频流");
-        avformat_close_input(&formatCtx_);
+        closeInput();
         return false;
     }
     
     if (!initDecoder()) {
-        avformat_close_input(&formatCtx_);
+        closeInput();
         return false;
     }
     
     // 填充视频信息
     AVStream* stream = formatCtx_->streams[videoStreamIndex_];
+    // 以整个文件的起始时间为零点（与音频解码器相同），音视频起始时间不同时保留原有的偏移
+    if (formatCtx_->start_time != AV_NOPTS_VALUE) {
+        originPts_ = av_rescale_q(formatCtx_->start_time, AV_TIME_BASE_Q, stream->time_base);
+    } else {
+        originPts_ = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    }
     videoInfo_.width = codecCtx_->width;
     videoInfo_.height = codecCtx_->height;
     videoInfo_.frameRate = av_q2d(stream->avg_frame_rate);
@@ -117,6 +142,13 @@ bool VideoDecoder::open(const std::string& filepath) {
     videoInfo_.codecName = avcodec_get_name(codecCtx_->codec_id);
     videoInfo_.pixelFormat = av_get_pix_fmt_name(codecCtx_->pix_fmt) ? av_get_pix_fmt_name(codecCtx_->pix_fmt) : "unknown";
     
+    // 关键帧索引在首次按帧号定位时建立；允许持久化时先尝试加载旁路索引文件
+    filepath_ = filepath;
+    if (config_.persistKeyframeIndex &&
+        keyframeIndex_.load(filepath + KeyframeIndex::kSidecarSuffix, filepath)) {
+        videoInfo_.totalFrames = keyframeIndex_.frameCount();
+    }
+    
     opened_ = true;
     currentTime_ = 0.0;
     currentFrame_ = 0;
@@ -136,12 +168,9 @@ void VideoDecoder::close() {
     
     LOG_DEBUG("开始关闭视频解码器...");
     
-    // 1. 首先关闭SwsContext
-    if (swsCtx_) {
-        sws_freeContext(swsCtx_);
-        swsCtx_ = nullptr;
-        LOG_DEBUG("SwsContext已释放");
-    }
+    // 1. 首先释放转换上下文
+    scaler_.clear();
+    LOG_DEBUG("SwsContext已释放");
     
     // 2. 关闭编解码器上下文
     if (codecCtx_) {
@@ -152,8 +181,7 @@ void VideoDecoder::close() {
     
     // 3. 最后关闭格式上下文
     if (formatCtx_) {
-        avformat_close_input(&formatCtx_);
-        formatCtx_ = nullptr;
+        closeInput();
         LOG_DEBUG("FormatContext已释放");
     }
     
@@ -162,6 +190,10 @@ void VideoDecoder::close() {
     opened_ = false;
     currentTime_ = 0.0;
     currentFrame_ = 0;
+    skipUntilPts_ = AV_NOPTS_VALUE;
+    keyframeIndex_.clear();
+    indexAttempted_ = false;
+    filepath_.clear();
     
     // 5. 重置视频信息
     videoInfo_ = VideoInfo();
@@ -204,41 +236,145 @@ std::vector<FrameData> VideoDecoder::getAllFrames() {
 }
 
 bool VideoDecoder::readNextFrame(FrameData& frameData) {
+    TRACE_SCOPE("VideoDecoder::readNextFrame", "decode");
+    MEMORY_STAGE_SCOPE("decode");
     if (!opened_) return false;
     
-    while (av_read_frame(formatCtx_, packet_) >= 0) {
-        if (packet_->stream_index == videoStreamIndex_) {
-            if (processPacket(frameData)) {
-                av_packet_unref(packet_);
-                return true;
+    while (decodeFrame()) {
+        int64_t pts = frame_->best_effort_timestamp != AV_NOPTS_VALUE ? frame_->best_effort_timestamp : frame_->pts;
+        // seek后从关键帧解码前进：目标之前的帧只解码，不做颜色转换
+        if (skipUntilPts_ != AV_NOPTS_VALUE) {
+            if (pts != AV_NOPTS_VALUE && pts < skipUntilPts_) {
+                METRICS_COUNTER_ADD("video_seek_skipped_frames", 1);
+                continue;
             }
+            skipUntilPts_ = AV_NOPTS_VALUE;
         }
-        av_packet_unref(packet_);
+        return convertFrame(frameData, pts);
     }
     
     return false;
 }
 
+bool VideoDecoder::decodeFrame() {
+    while (true) {
+        int ret;
+        {
+            METRICS_SCOPED_TIMER("video_decode_us");
+            ret = avcodec_receive_frame(codecCtx_, frame_);
+        }
+        if (ret == 0) {
+            METRICS_COUNTER_ADD("video_decoded_frames", 1);
+            frameMemory_.update(MemoryTracker::frameBufferBytes(frame_));
+            return true;
+        }
+        if (ret == AVERROR_EOF) {
+            return false;
+        }
+        if (ret != AVERROR(EAGAIN)) {
+            LOG_WARNING("视频帧解码失败，跳过");
+        }
+        
+        // 解码器需要更多输入
+        {
+            METRICS_SCOPED_TIMER("video_demux_us");
+            ret = av_read_frame(formatCtx_, packet_);
+        }
+        if (ret < 0) {
+            // 文件结束：送空包让解码器吐出缓存的帧（B帧重排、帧线程）
+            avcodec_send_packet(codecCtx_, nullptr);
+            continue;
+        }
+        METRICS_COUNTER_ADD("video_demux_bytes", packet_->size);
+        MemoryTracker::getInstance().recordTransient(MemoryTracker::Source::FFmpeg, packet_->size);
+        
+        if (packet_->stream_index == videoStreamIndex_) {
+            METRICS_SCOPED_TIMER("video_decode_us");
+            // receive返回EAGAIN后解码器一定能接收新包；损坏的包跳过
+            if (avcodec_send_packet(codecCtx_, packet_) < 0) {
+                LOG_WARNING("视频包送入解码器失败，跳过");
+            }
+        }
+        av_packet_unref(packet_);
+    }
+}
+
 bool VideoDecoder::seekToTime(double seconds) {
     if (!opened_) return false;
     
     AVStream* stream = formatCtx_->streams[videoStreamIndex_];
-    int64_t timestamp = av_rescale_q(seconds * AV_TIME_BASE, AV_TIME_BASE_Q, stream->time_base);
+    int64_t timestamp = av_rescale_q(seconds * AV_TIME_BASE, AV_TIME_BASE_Q, stream->time_base) + originPts_;
     
-    if (av_seek_frame(formatCtx_, videoStreamIndex_, timestamp, AVSEEK_FLAG_BACKWARD) < 0) {
+    // 已有索引时对齐到该时刻显示的帧；没有索引不为时间定位专门扫描文件，帧号按帧率估算
+    if (!keyframeIndex_.empty()) {
+        int64_t frameNumber = keyframeIndex_.frameAtPts(timestamp);
+        return seekToPts(keyframeIndex_.framePts(frameNumber), frameNumber);
+    }
+    return seekToPts(timestamp, static_cast<int64_t>(std::llround(seconds * videoInfo_.frameRate)));
+}
+
+bool VideoDecoder::seekToFrame(int64_t frameNumber) {
+    if (!opened_) return false;
+    
+    if (config_.accurateSeek && ensureKeyframeIndex()) {
+        if (frameNumber < 0 || frameNumber >= keyframeIndex_.frameCount()) {
+            LOG_WARNING("定位帧号超出范围: " + std::to_string(frameNumber));
+            return false;
+        }
+        return seekToPts(keyframeIndex_.framePts(frameNumber), frameNumber);
+    }
+    
+    double seconds = frameNumber / videoInfo_.frameRate;
+    return seekToTime(seconds);
+}
+
+bool VideoDecoder::seekToPts(int64_t targetPts, int64_t frameNumber) {
+    AVStream* stream = formatCtx_->streams[videoStreamIndex_];
+    int64_t seekPts = keyframeIndex_.empty() ? targetPts : keyframeIndex_.keyframeAtOrBefore(targetPts);
+    
+    if (av_seek_frame(formatCtx_, videoStreamIndex_, seekPts, AVSEEK_FLAG_BACKWARD) < 0) {
         return false;
     }
     
     avcodec_flush_buffers(codecCtx_);
-    currentTime_ = seconds;
+    skipUntilPts_ = config_.accurateSeek ? targetPts : AV_NOPTS_VALUE;
+    currentFrame_ = frameNumber;
+    currentTime_ = (targetPts - originPts_) * av_q2d(stream->time_base);
     return true;
 }
 
-bool VideoDecoder::seekToFrame(int64_t frameNumber) {
+bool VideoDecoder::buildKeyframeIndex() {
     if (!opened_) return false;
     
-    double seconds = frameNumber / videoInfo_.frameRate;
-    return seekToTime(seconds);
+    bool scanned = keyframeIndex_.empty();
+    if (!ensureKeyframeIndex()) {
+        return false;
+    }
+    if (!scanned) {
+        return true;
+    }
+    // 扫描移动了读位置，回到扫描前的帧
+    int64_t frameNumber = std::min(currentFrame_, keyframeIndex_.frameCount() - 1);
+    return seekToPts(keyframeIndex_.framePts(frameNumber), frameNumber);
+}
+
+bool VideoDecoder::ensureKeyframeIndex() {
+    if (!keyframeIndex_.empty()) {
+        return true;
+    }
+    if (indexAttempted_) {
+        return false;
+    }
+    indexAttempted_ = true;
+    
+    if (!keyframeIndex_.build(formatCtx_, videoStreamIndex_)) {
+        return false;
+    }
+    videoInfo_.totalFrames = keyframeIndex_.frameCount();
+    if (config_.persistKeyframeIndex) {
+        keyframeIndex_.save(filepath_ + KeyframeIndex::kSidecarSuffix, filepath_);
+    }
+    return true;
 }
 
 bool VideoDecoder::initDecoder() {
@@ -266,49 +402,19 @@ bool VideoDecoder::initDecoder() {
         codecCtx_->thread_count = config_.threadCount;
     }
     
+    // 帧/切片线程在open时创建并继承亲和性
+    ScopedNumaBinding numaBinding(config_.numaNode);
     if (avcodec_open2(codecCtx_, codec, nullptr) < 0) {
         LOG_ERROR("无法打开解码器");
         avcodec_free_context(&codecCtx_);
         return false;
     }
     
-    return initSwsContext();
-}
-
-bool VideoDecoder::initSwsContext() {
-    if (swsCtx_) {
-        sws_freeContext(swsCtx_);
-    }
-    
-    AVPixelFormat outputFormat = AV_PIX_FMT_BGR24;
+    outputFormat_ = AV_PIX_FMT_BGR24;
     if (config_.outputPixelFormat == "rgb24") {
-        outputFormat = AV_PIX_FMT_RGB24;
+        outputFormat_ = AV_PIX_FMT_RGB24;
     } else if (config_.outputPixelFormat == "gray") {
-        outputFormat = AV_PIX_FMT_GRAY8;
-    }
-    
-    int outputWidth = codecCtx_->width;
-    int outputHeight = codecCtx_->height;
-    
-    // 应用尺寸限制
-    if (config_.maxWidth > 0 && outputWidth > config_.maxWidth) {
-        outputHeight = outputHeight * config_.maxWidth / outputWidth;
-        outputWidth = config_.maxWidth;
-    }
-    if (config_.maxHeight > 0 && outputHeight > config_.maxHeight) {
-        outputWidth = outputWidth * config_.maxHeight / outputHeight;
-        outputHeight = config_.maxHeight;
-    }
-    
-    swsCtx_ = sws_getContext(
-        codecCtx_->width, codecCtx_->height, codecCtx_->pix_fmt,
-        outputWidth, outputHeight, outputFormat,
-        SWS_BILINEAR, nullptr, nullptr, nullptr
-    );
-    
-    if (!swsCtx_) {
-        LOG_ERROR("无法创建图像转换上下文");
-        return false;
+        outputFormat_ = AV_PIX_FMT_GRAY8;
     }
     
     return true;
@@ -326,51 +432,71 @@ void VideoDecoder::cleanup() {
     if (frame_) {
         av_frame_free(&frame_);
         frame_ = nullptr;
+        frameMemory_.reset();
         LOG_DEBUG("AVFrame已释放");
     }
     
     LOG_DEBUG("VideoDecoder资源清理完成");
 }
 
-bool VideoDecoder::processPacket(FrameData& frameData) {
-    if (avcodec_send_packet(codecCtx_, packet_) != 0) {
-        return false;
-    }
+void VideoDecoder::closeInput() {
+    avformat_close_input(&formatCtx_);
+    // 自定义I/O不随格式上下文释放
+    InputReader::freeIOContext(&inputIO_);
+}
+
+bool VideoDecoder::convertFrame(FrameData& frameData, int64_t pts) {
+    // 输出尺寸按当前帧计算：流中途变分辨率时跟随变化，转换上下文按尺寸缓存复用
+    int outputWidth = frame_->width;
+    int outputHeight = frame_->height;
     
-    if (avcodec_receive_frame(codecCtx_, frame_) != 0) {
-        return false;
+    // 应用尺寸限制
+    if (config_.maxWidth > 0 && outputWidth > config_.maxWidth) {
+        outputHeight = outputHeight * config_.maxWidth / outputWidth;
+        outputWidth = config_.maxWidth;
     }
-    
-    if (!swsCtx_) {
-        if (!initSwsContext()) {
-            return false;
-        }
+    if (config_.maxHeight > 0 && outputHeight > config_.maxHeight) {
+        outputWidth = outputWidth * config_.maxHeight / outputHeight;
+        outputHeight = config_.maxHeight;
     }
     
+    ScalerKey key;
+    key.srcWidth = frame_->width;
+    key.srcHeight = frame_->height;
+    key.srcFormat = static_cast<AVPixelFormat>(frame_->format);
+    key.dstWidth = outputWidth;
+    key.dstHeight = outputHeight;
+    key.dstFormat = outputFormat_;
+    key.flags = SWS_BILINEAR;
+    
     AVStream* stream = formatCtx_->streams[videoStreamIndex_];
     
     // 填充FrameData
-    frameData.width = frame_->width;
-    frameData.height = frame_->height;
-    frameData.pts = frame_->pts;
-    frameData.timestamp = frame_->pts * av_q2d(stream->time_base);
+    frameData.width = outputWidth;
+    frameData.height = outputHeight;
+    frameData.pts = pts;
+    frameData.timestamp = (pts - originPts_) * av_q2d(stream->time_base);
+    // 有索引时帧号由PTS查得，seek后也准确
+    if (!keyframeIndex_.empty() && pts != AV_NOPTS_VALUE) {
+        currentFrame_ = keyframeIndex_.frameAtPts(pts);
+    }
     frameData.frameIndex = currentFrame_++;
     frameData.sourceTag = "video";
     
     // 创建OpenCV Mat
-    int channels = 3;
-    if (config_.outputPixelFormat == "gray") {
-        channels = 1;
-    }
-    
-    frameData.image = cv::Mat(frame_->height, frame_->width, 
-                             channels == 1 ? CV_8UC1 : CV_8UC3);
+    frameData.image = cv::Mat(outputHeight, outputWidth,
+                             outputFormat_ == AV_PIX_FMT_GRAY8 ? CV_8UC1 : CV_8UC3);
     
     uint8_t* dstData[4] = { frameData.image.data, nullptr, nullptr, nullptr };
     int dstLinesize[4] = { static_cast<int>(frameData.image.step), 0, 0, 0 };
     
-    sws_scale(swsCtx_, frame_->data, frame_->linesize, 0, frame_->height,
-             dstData, dstLinesize);
+    {
+        METRICS_SCOPED_TIMER("video_decode_sws_us");
+        if (!scaler_.scale(key, frame_->data, frame_->linesize, dstData, dstLinesize, config_.swsThreads)) {
+            LOG_ERROR("图像格式转换失败");
+            return false;
+        }
+    }
     
     currentTime_ = frameData.timestamp;
     return true;
@@ -1,6 +1,7 @@
 #include "include/Decoder.h"
 #include "include/VideoDecoder.h"
 #include "include/AudioDecoder.h"
+#include "../Utils/ScalerCache.h"
 #include <iostream>
 #include <iomanip>
 #include <chrono>
@@ -14,6 +15,7 @@ void printUsage(const char* program) {
     std::cout << "  all      - 测试统一解码器 (默认)" << std::endl;
     std::cout << "  config   - 测试配置功能" << std::endl;
     std::cout << "  seek     - 测试定位功能" << std::endl;
+    std::cout << "  scaler   - 测试颜色转换的自动分带数（不读取文件）" << std::endl;
 }
 
 void testVideoDecoder(const std::string& filepath) {
@@ -296,6 +298,34 @@ void testSeeking(const std::string& filepath) {
     decoder.close();
 }
 
+bool testScalerBands() {
+    std::cout << "\n=== 测试颜色转换自动分带 ===" << std::endl;
+
+    struct Case {
+        int width;
+        int height;
+        int expected;
+    };
+    const Case cases[] = {
+        {1280, 720, 1},
+        {1920, 1080, 2},
+        {2560, 1440, 4},
+        {3840, 2160, 8},
+        {7680, 4320, 8},
+    };
+
+    bool passed = true;
+    for (const auto& c : cases) {
+        int bands = ScalerCache::autoBandCount(c.width, c.height);
+        bool ok = bands == c.expected;
+        std::cout << "  " << c.width << "x" << c.height << ": " << bands << " 带"
+                  << (ok ? "" : "，期望 " + std::to_string(c.expected)) << std::endl;
+        passed = passed && ok;
+    }
+    std::cout << (passed ? "✅ 分带测试通过" : "❌ 分带测试失败") << std::endl;
+    return passed;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 2) {
         printUsage(argv[0]);
@@ -308,8 +338,10 @@ int main(int argc, char* argv[]) {
     std::cout << "VideoSR-Lite 解码器测试程序" << std::endl;
     std::cout << "文件: " << filepath << std::endl;
     std::cout << "模式: " << mode << std::endl;
-    
-    
-    
+
+    if (mode == "scaler") {
+        return testScalerBands() ? 0 : 1;
+    }
+
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "AsyncFileWriter.h"
+#include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point from) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - from).count();
+}
+
+} // namespace
+
+AsyncFileWriter::AsyncFileWriter(const AsyncFileWriterConfig& config)
+    : config_(config) {
+    // 块大小对齐，保证顺序写的每一块都满足O_DIRECT的偏移和长度要求
+    config_.blockSize = std::max(config_.blockSize, kDirectAlignment);
+    config_.blockSize = (config_.blockSize + kDirectAlignment - 1) / kDirectAlignment * kDirectAlignment;
+    config_.maxPendingBlocks = std::max<size_t>(config_.maxPendingBlocks, 1);
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    close();
+}
+
+bool AsyncFileWriter::open(const std::string& path) {
+    if (fd_ >= 0) {
+        LOG_ERROR("AsyncFileWriter: already open: " + path_);
+        return false;
+    }
+
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("AsyncFileWriter: failed to open " + path + ": " + std::strerror(errno));
+        return false;
+    }
+    path_ = path;
+
+    if (config_.directIO) {
+        directFd_ = ::open(path.c_str(), O_WRONLY | O_DIRECT | O_CLOEXEC);
+        if (directFd_ < 0) {
+            LOG_WARNING("AsyncFileWriter: O_DIRECT not supported for " + path + " (" + std::strerror(errno) +
+                        "), using buffered writes");
+        }
+    }
+
+    if (config_.preallocateBytes > 0) {
+        // KEEP_SIZE：只预留空间不改变文件大小，关闭时截掉未用部分
+        if (fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, config_.preallocateBytes) != 0) {
+            LOG_WARNING("AsyncFileWriter: fallocate failed for " + path + ": " + std::strerror(errno));
+        }
+    }
+
+    blockStorage_.assign(config_.maxPendingBlocks + 1, Block());
+    freeBlocks_.clear();
+    for (auto& block : blockStorage_) {
+        freeBlocks_.push_back(&block);
+    }
+    position_ = 0;
+    size_ = 0;
+    stopping_ = false;
+    error_ = false;
+    stats_ = Statistics();
+
+    if (config_.writeBehind) {
+        writer_ = std::thread(&AsyncFileWriter::writerLoop, this);
+    }
+
+    LOG_DEBUG("AsyncFileWriter opened " + path + ", block " + std::to_string(config_.blockSize >> 10) + "KiB x " +
+              std::to_string(blockStorage_.size()) + (directFd_ >= 0 ? ", O_DIRECT" : ""));
+    return true;
+}
+
+bool AsyncFileWriter::write(const uint8_t* data, size_t size) {
+    if (fd_ < 0 || hasError()) {
+        return false;
+    }
+
+    while (size > 0) {
+        if (!current_) {
+            current_ = acquireBlock();
+            if (!current_) {
+                return false;
+            }
+        }
+        size_t n = std::min(size, current_->capacity - current_->size);
+        std::memcpy(current_->data + current_->size, data, n);
+        current_->size += n;
+        data += n;
+        size -= n;
+        position_ += static_cast<int64_t>(n);
+        size_ = std::max(size_, position_);
+
+        if (current_->size == current_->capacity) {
+            submitCurrent();
+        }
+    }
+    return true;
+}
+
+int64_t AsyncFileWriter::seek(int64_t offset, int whence) {
+    int64_t target;
+    switch (whence) {
+        case SEEK_SET: target = offset; break;
+        case SEEK_CUR: target = position_ + offset; break;
+        case SEEK_END: target = size_ + offset; break;
+        default: return -1;
+    }
+    if (target < 0) {
+        return -1;
+    }
+
+    if (target != position_) {
+        // 当前块只覆盖连续区间，换位置前先提交
+        submitCurrent();
+        position_ = target;
+    }
+    return position_;
+}
+
+bool AsyncFileWriter::sync() {
+    if (fd_ < 0) {
+        return true;
+    }
+    submitCurrent();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!queue_.empty() || inFlight_ > 0) {
+        auto start = Clock::now();
+        freeCv_.wait(lock, [this] { return queue_.empty() && inFlight_ == 0; });
+        stats_.ioWaitMs += elapsedMs(start);
+    }
+    return !error_;
+}
+
+bool AsyncFileWriter::close() {
+    if (fd_ < 0) {
+        return true;
+    }
+
+    bool ok = sync();
+    stopWriter();
+
+    if (config_.preallocateBytes > 0 && ftruncate(fd_, size_) != 0) {
+        LOG_WARNING("AsyncFileWriter: failed to trim preallocated space of " + path_ + ": " + std::strerror(errno));
+    }
+    if (directFd_ >= 0) {
+        ::close(directFd_);
+        directFd_ = -1;
+    }
+    if (::close(fd_) != 0) {
+        LOG_ERROR("AsyncFileWriter: close failed for " + path_ + ": " + std::strerror(errno));
+        ok = false;
+    }
+    fd_ = -1;
+
+    for (auto& block : blockStorage_) {
+        std::free(block.data);
+        block.data = nullptr;
+    }
+    blockStorage_.clear();
+    freeBlocks_.clear();
+    current_ = nullptr;
+
+    LOG_DEBUG("AsyncFileWriter closed " + path_ + ": " + std::to_string(stats_.bytesWritten) + " bytes, " +
+              std::to_string(stats_.writeCalls) + " writes (" + std::to_string(stats_.directFallbacks) +
+              " direct fallbacks), io wait " + std::to_string(stats_.ioWaitMs) + "ms");
+    return ok;
+}
+
+bool AsyncFileWriter::hasError() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+AsyncFileWriter::Statistics AsyncFileWriter::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+AsyncFileWriter::Block* AsyncFileWriter::acquireBlock() {
+    Block* block = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (freeBlocks_.empty()) {
+            // 写盘跟不上：调用线程在此等待，计入I/O等待时间
+            METRICS_COUNTER_ADD("mux_io_stalls", 1);
+            auto start = Clock::now();
+            freeCv_.wait(lock, [this] { return !freeBlocks_.empty() || error_; });
+            stats_.ioWaitMs += elapsedMs(start);
+        }
+        if (error_) {
+            return nullptr;
+        }
+        block = freeBlocks_.back();
+        freeBlocks_.pop_back();
+    }
+
+    if (!block->data) {
+        void* memory = nullptr;
+        if (posix_memalign(&memory, kDirectAlignment, config_.blockSize) != 0) {
+            LOG_ERROR("AsyncFileWriter: failed to allocate " + std::to_string(config_.blockSize) + " byte block");
+            releaseBlock(block);
+            return nullptr;
+        }
+        block->data = static_cast<uint8_t*>(memory);
+    }
+    block->size = 0;
+    block->offset = position_;
+    block->capacity = config_.blockSize - static_cast<size_t>(position_ % kDirectAlignment);
+    return block;
+}
+
+void AsyncFileWriter::submitCurrent() {
+    Block* block = current_;
+    current_ = nullptr;
+    if (!block) {
+        return;
+    }
+    if (block->size == 0) {
+        releaseBlock(block);
+        return;
+    }
+
+    if (!config_.writeBehind) {
+        auto start = Clock::now();
+        writeBlock(block);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.ioWaitMs += elapsedMs(start);
+        }
+        releaseBlock(block);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(block);
+        METRICS_GAUGE_SET("mux_io_queue_depth", queue_.size());
+    }
+    queueCv_.notify_one();
+}
+
+void AsyncFileWriter::writeBlock(Block* block) {
+    TRACE_SCOPE("AsyncFileWriter::writeBlock", "mux");
+    // 偏移和长度都对齐时走O_DIRECT；seek回写的小块、回写后补齐到对齐边界的块和文件尾走普通写
+    bool direct = directFd_ >= 0 && block->offset % kDirectAlignment == 0 && block->size % kDirectAlignment == 0;
+    int fd = direct ? directFd_ : fd_;
+    if (directFd_ >= 0 && !direct) {
+        METRICS_COUNTER_ADD("mux_io_direct_fallbacks", 1);
+    }
+
+    auto start = Clock::now();
+    const uint8_t* data = block->data;
+    size_t remaining = block->size;
+    int64_t offset = block->offset;
+    uint64_t calls = 0;
+    bool failed = false;
+    while (remaining > 0) {
+        ssize_t n = pwrite(fd, data, remaining, offset);
+        ++calls;
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("AsyncFileWriter: write failed for " + path_ + " at offset " + std::to_string(offset) + ": " +
+                      std::strerror(errno));
+            failed = true;
+            break;
+        }
+        data += n;
+        remaining -= static_cast<size_t>(n);
+        offset += n;
+    }
+    double ms = elapsedMs(start);
+    METRICS_COUNTER_ADD("mux_io_bytes", block->size - remaining);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.bytesWritten += block->size - remaining;
+    stats_.writeCalls += calls;
+    if (direct) {
+        stats_.directWrites += calls;
+    } else if (directFd_ >= 0) {
+        ++stats_.directFallbacks;
+    }
+    stats_.writeMs += ms;
+    if (failed) {
+        error_ = true;
+        freeCv_.notify_all();
+    }
+}
+
+void AsyncFileWriter::releaseBlock(Block* block) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        freeBlocks_.push_back(block);
+    }
+    freeCv_.notify_all();
+}
+
+void AsyncFileWriter::writerLoop() {
+    Tracer::getInstance().setThreadName("mux-writer");
+    while (true) {
+        Block* block = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            queueCv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            block = queue_.front();
+            queue_.pop_front();
+            ++inFlight_;
+        }
+
+        writeBlock(block);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --inFlight_;
+            freeBlocks_.push_back(block);
+        }
+        freeCv_.notify_all();
+    }
+}
+
+void AsyncFileWriter::stopWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    queueCv_.notify_all();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
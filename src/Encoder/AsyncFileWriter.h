@@ -0,0 +1,127 @@
+#ifndef ASYNC_FILE_WRITER_H
+#define ASYNC_FILE_WRITER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 写后文件输出配置
+ */
+struct AsyncFileWriterConfig {
+    size_t blockSize = 4 << 20;         // 写盘块大小（向上对齐到4KiB）
+    size_t maxPendingBlocks = 4;        // 排队等待写盘的最大块数（满时调用线程等待）
+    bool writeBehind = true;            // 在后台线程写盘（false时在调用线程同步写）
+    bool directIO = false;              // O_DIRECT对齐写，绕过页缓存（不满足对齐的写回退普通写）
+    int64_t preallocateBytes = 0;       // 打开时fallocate预分配的字节数（0=不预分配）
+};
+
+/**
+ * @brief 大块缓冲 + 后台写盘的顺序输出文件
+ *
+ * 调用线程只把数据拷进对齐的大块缓冲，写满一块交给写线程用pwrite按偏移写出，
+ * 慢速存储（NFS等）上的阻塞写不再落在编码线程上。支持seek回写（如MP4回填box大小）：
+ * seek先提交当前块，之后的数据从新偏移开始新块，写线程按提交顺序写出保证覆盖顺序正确。
+ * 从未对齐的偏移开始的块只写到下一个对齐边界，之后的块重新对齐，O_DIRECT不会因一次回写而整段失效。
+ *
+ * 非线程安全：write/seek/sync/close应在同一线程调用（封装线程）。
+ */
+class AsyncFileWriter {
+public:
+    static constexpr size_t kDirectAlignment = 4096;
+
+    explicit AsyncFileWriter(const AsyncFileWriterConfig& config = AsyncFileWriterConfig());
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * @brief 创建（截断）输出文件并启动写线程
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief 追加写入当前位置
+     * @return false 表示此前的写盘已失败
+     */
+    bool write(const uint8_t* data, size_t size);
+
+    /**
+     * @brief 移动写位置（SEEK_SET/SEEK_CUR/SEEK_END）
+     * @return 新位置，失败返回-1
+     */
+    int64_t seek(int64_t offset, int whence);
+
+    int64_t position() const { return position_; }
+    int64_t size() const { return size_; }
+
+    /**
+     * @brief 等待所有已提交的数据写盘（不fsync）
+     */
+    bool sync();
+
+    /**
+     * @brief 写出剩余数据，截掉多余的预分配空间并关闭文件
+     */
+    bool close();
+
+    bool isOpen() const { return fd_ >= 0; }
+    bool hasError() const;
+
+    struct Statistics {
+        uint64_t bytesWritten = 0;      // 已写盘字节数
+        uint64_t writeCalls = 0;        // pwrite次数
+        uint64_t directWrites = 0;      // 其中走O_DIRECT的次数
+        uint64_t directFallbacks = 0;   // 开启O_DIRECT但未对齐、改走普通写的块数
+        double ioWaitMs = 0.0;          // 调用线程等待写盘（队列满或sync）的时间
+        double writeMs = 0.0;           // 写线程实际写盘耗时
+    };
+
+    Statistics getStatistics() const;
+
+private:
+    struct Block {
+        uint8_t* data = nullptr;
+        size_t size = 0;
+        size_t capacity = 0;            // 本块可写字节数（未对齐的起始偏移只写到下一个对齐边界）
+        int64_t offset = 0;
+    };
+
+    Block* acquireBlock();
+    void submitCurrent();
+    void writeBlock(Block* block);
+    void releaseBlock(Block* block);
+    void writerLoop();
+    void stopWriter();
+
+    AsyncFileWriterConfig config_;
+    std::string path_;
+    int fd_ = -1;
+    int directFd_ = -1;                 // O_DIRECT描述符（不可用时为-1）
+
+    // 调用线程状态
+    Block* current_ = nullptr;
+    int64_t position_ = 0;
+    int64_t size_ = 0;
+
+    // 块池与写队列
+    mutable std::mutex mutex_;
+    std::condition_variable queueCv_;   // 写线程等待新块
+    std::condition_variable freeCv_;    // 调用线程等待空闲块/队列清空
+    std::vector<Block*> freeBlocks_;
+    std::deque<Block*> queue_;
+    std::vector<Block> blockStorage_;   // 固定大小，缓冲按需分配
+    size_t inFlight_ = 0;               // 已出队正在写的块数
+    bool stopping_ = false;
+    bool error_ = false;
+    std::thread writer_;
+
+    Statistics stats_;
+};
+
+#endif // ASYNC_FILE_WRITER_H
@@ -1,12 +1,19 @@
 #include "AudioEncoder.h"
 #include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/Trace.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 AudioEncoder::AudioEncoder()
     : codec_(nullptr)
     , codecContext_(nullptr)
     , frame_(nullptr)
     , swrContext_(nullptr)
+    , packet_(nullptr)
+    , copyBufferPool_(nullptr)
+    , copyBufferSize_(0)
     , initialized_(false)
     , sampleIndex_(0)
     , resampleBuffer_(nullptr)
@@ -33,6 +40,13 @@ bool AudioEncoder::init(const AudioEncoderConfig& config, AVRational timeBase) {
     LOG_INFO("Channels: " + std::to_string(config_.channels));
     LOG_INFO("Bitrate: " + std::to_string(config_.bitrate/1000) + "kbps");
     
+    // 接收包整个生命周期只分配一次
+    packet_ = av_packet_alloc();
+    if (!packet_) {
+        LOG_ERROR("Failed to allocate packet");
+        return false;
+    }
+    
     if (config_.enableStreamCopy) {
         LOG_INFO("Stream copy mode enabled");
         initialized_ = true;
@@ -46,12 +60,14 @@ bool AudioEncoder::init(const AudioEncoderConfig& config, AVRational timeBase) {
     
     initialized_ = true;
     sampleIndex_ = 0;
+    startAligned_ = false;
     
     LOG_INFO("AudioEncoder initialized successfully");
     return true;
 }
 
-bool AudioEncoder::encode(const AudioFrameData& frameData, std::vector<AVPacket*>& packets) {
+bool AudioEncoder::encode(const AudioFrameData& frameData, const PacketSink& sink) {
+    TRACE_SCOPE("AudioEncoder::encode", "encode");
     if (!initialized_) {
         LOG_ERROR("AudioEncoder not initialized");
         return false;
@@ -59,7 +75,7 @@ bool AudioEncoder::encode(const AudioFrameData& frameData, std::vector<AVPacket*
     
     // 流拷贝模式
     if (config_.enableStreamCopy) {
-        return processStreamCopy(frameData, packets);
+        return processStreamCopy(frameData, sink);
     }
     
     auto startTime = std::chrono::high_resolution_clock::now();
@@ -71,51 +87,28 @@ bool AudioEncoder::encode(const AudioFrameData& frameData, std::vector<AVPacket*
         return false;
     }
     
-    // 设置时间戳
+    // 设置时间戳：起点取首帧时间戳，保留输入中音视频起始时间的偏移
+    if (!startAligned_) {
+        sampleIndex_ = std::max<int64_t>(0, std::llround(frameData.timestamp / av_q2d(timeBase_)));
+        startAligned_ = true;
+    }
     avFrame->pts = sampleIndex_;
     sampleIndex_ += avFrame->nb_samples;
     
     // 发送帧到编码器
+    METRICS_SCOPED_TIMER("audio_encode_us");
     int ret = avcodec_send_frame(codecContext_, avFrame);
     if (ret < 0) {
         LOG_ERROR("Error sending frame to encoder: " + std::to_string(ret));
-        av_frame_free(&avFrame);
         return false;
     }
     
     // 接收编码包
-    while (ret >= 0) {
-        AVPacket* packet = av_packet_alloc();
-        if (!packet) {
-            LOG_ERROR("Failed to allocate packet");
-            av_frame_free(&avFrame);
-            return false;
-        }
-        
-        ret = avcodec_receive_packet(codecContext_, packet);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            av_packet_free(&packet);
-            break;
-        } else if (ret < 0) {
-            LOG_ERROR("Error receiving packet from encoder: " + std::to_string(ret));
-            av_packet_free(&packet);
-            av_frame_free(&avFrame);
-            return false;
-        }
-        
-        packets.push_back(packet);
-        
-        // 更新统计信息
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-        updateStatistics(duration.count() / 1000.0, packet->size, avFrame->nb_samples);
-    }
-    
-    av_frame_free(&avFrame);
-    return true;
+    // 注意：不要释放avFrame，因为它指向的是frame_成员变量
+    return drainPackets(sink, false, avFrame->nb_samples, startTime) >= 0;
 }
 
-bool AudioEncoder::flush(std::vector<AVPacket*>& packets) {
+bool AudioEncoder::flush(const PacketSink& sink) {
     if (!initialized_ || config_.enableStreamCopy) {
         return true;  // 流拷贝模式不需要刷新
     }
@@ -130,29 +123,68 @@ bool AudioEncoder::flush(std::vector<AVPacket*>& packets) {
     }
     
     // 接收剩余的编码包
-    while (ret >= 0) {
-        AVPacket* packet = av_packet_alloc();
-        if (!packet) {
-            LOG_ERROR("Failed to allocate packet");
+    int count = drainPackets(sink, true, 0, std::chrono::high_resolution_clock::now());
+    if (count < 0) {
+        return false;
+    }
+    
+    LOG_DEBUG("Audio encoder flushed, " + std::to_string(count) + " packets");
+    return true;
+}
+
+bool AudioEncoder::encode(const AudioFrameData& frameData, std::vector<AVPacket*>& packets) {
+    return encode(frameData, collectInto(packets));
+}
+
+bool AudioEncoder::flush(std::vector<AVPacket*>& packets) {
+    return flush(collectInto(packets));
+}
+
+PacketSink AudioEncoder::collectInto(std::vector<AVPacket*>& packets) {
+    return [this, &packets](AVPacket* packet) {
+        AVPacket* out = packetPool_.acquire();
+        if (!out) {
             return false;
         }
-        
-        ret = avcodec_receive_packet(codecContext_, packet);
-        if (ret == AVERROR_EOF) {
-            av_packet_free(&packet);
+        av_packet_move_ref(out, packet);
+        packets.push_back(out);
+        return true;
+    };
+}
+
+int AudioEncoder::drainPackets(const PacketSink& sink, bool flushing, int samples,
+                               std::chrono::high_resolution_clock::time_point startTime) {
+    int count = 0;
+    while (true) {
+        int ret = avcodec_receive_packet(codecContext_, packet_);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR("Error receiving packet from encoder: " + std::to_string(ret));
-            av_packet_free(&packet);
-            return false;
+            return -1;
+        }
+        
+        // sink可能取走包的引用（如av_interleaved_write_frame），先记录大小
+        int packetSize = packet_->size;
+        double encodingTime = 0.0;
+        if (!flushing) {
+            METRICS_COUNTER_ADD("audio_encoded_bytes", packetSize);
+            auto endTime = std::chrono::high_resolution_clock::now();
+            encodingTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
         }
         
-        packets.push_back(packet);
-        updateStatistics(0.0, packet->size, 0);
+        // 更新统计信息
+        updateStatistics(encodingTime, packetSize, samples);
+        
+        bool accepted = sink(packet_);
+        av_packet_unref(packet_);
+        if (!accepted) {
+            LOG_ERROR("Packet sink rejected audio packet");
+            return -1;
+        }
+        ++count;
     }
-    
-    LOG_DEBUG("Audio encoder flushed, " + std::to_string(packets.size()) + " packets");
-    return true;
+    return count;
 }
 
 void AudioEncoder::close() {
@@ -166,6 +198,16 @@ void AudioEncoder::close() {
         av_frame_free(&frame_);
     }
     
+    if (packet_) {
+        av_packet_free(&packet_);
+    }
+    
+    // 已交出的缓冲仍持有引用，池在最后一块归还后才真正释放
+    if (copyBufferPool_) {
+        av_buffer_pool_uninit(&copyBufferPool_);
+        copyBufferSize_ = 0;
+    }
+    
     if (codecContext_) {
         avcodec_free_context(&codecContext_);
     }
@@ -371,34 +413,48 @@ bool AudioEncoder::needsResampling(const AudioFrameData& frameData) const {
     return false;
 }
 
-bool AudioEncoder::processStreamCopy(const AudioFrameData& frameData, std::vector<AVPacket*>& packets) {
-    // 流拷贝模式：直接将音频数据封装为AVPacket
-    AVPacket* packet = av_packet_alloc();
-    if (!packet) {
-        LOG_ERROR("Failed to allocate packet for stream copy");
-        return false;
+bool AudioEncoder::processStreamCopy(const AudioFrameData& frameData, const PacketSink& sink) {
+    // 流拷贝模式：直接将音频数据封装为AVPacket，数据缓冲取自缓冲池
+    int dataSize = static_cast<int>(frameData.data.size());
+    int requiredSize = dataSize + AV_INPUT_BUFFER_PADDING_SIZE;
+    if (!copyBufferPool_ || requiredSize > copyBufferSize_) {
+        if (copyBufferPool_) {
+            av_buffer_pool_uninit(&copyBufferPool_);
+        }
+        copyBufferPool_ = av_buffer_pool_init(requiredSize, nullptr);
+        copyBufferSize_ = copyBufferPool_ ? requiredSize : 0;
+        if (!copyBufferPool_) {
+            LOG_ERROR("Failed to create packet buffer pool for stream copy");
+            return false;
+        }
     }
     
-    // 分配数据
-    int ret = av_new_packet(packet, frameData.data.size());
-    if (ret < 0) {
-        LOG_ERROR("Failed to allocate packet data: " + std::to_string(ret));
-        av_packet_free(&packet);
+    AVBufferRef* buffer = av_buffer_pool_get(copyBufferPool_);
+    if (!buffer) {
+        LOG_ERROR("Failed to allocate packet data for stream copy");
         return false;
     }
     
-    // 拷贝数据
-    memcpy(packet->data, frameData.data.data(), frameData.data.size());
+    // 拷贝数据，填充区清零
+    memcpy(buffer->data, frameData.data.data(), dataSize);
+    memset(buffer->data + dataSize, 0, AV_INPUT_BUFFER_PADDING_SIZE);
+    packet_->buf = buffer;
+    packet_->data = buffer->data;
+    packet_->size = dataSize;
     
     // 设置时间戳
-    packet->pts = sampleIndex_;
-    packet->dts = sampleIndex_;
+    if (!startAligned_) {
+        sampleIndex_ = std::max<int64_t>(0, std::llround(frameData.timestamp / av_q2d(timeBase_)));
+        startAligned_ = true;
+    }
+    packet_->pts = sampleIndex_;
+    packet_->dts = sampleIndex_;
     sampleIndex_ += frameData.nbSamples;
     
-    packets.push_back(packet);
-    
     // 更新统计信息
-    updateStatistics(0.0, packet->size, frameData.nbSamples);
+    updateStatistics(0.0, dataSize, frameData.nbSamples);
     
-    return true;
+    bool accepted = sink(packet_);
+    av_packet_unref(packet_);
+    return accepted;
 }
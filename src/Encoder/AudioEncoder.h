@@ -3,6 +3,8 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
+#include "PacketPool.h"
 #include "../DataStruct/AudioFrameData.h"
 
 extern "C" {
@@ -10,6 +12,7 @@ extern "C" {
 #include <libavformat/avformat.h>
 #include <libavutil/opt.h>
 #include <libavutil/channel_layout.h>
+#include <libavutil/buffer.h>
 #include <libswresample/swresample.h>
 }
 
@@ -45,21 +48,41 @@ public:
      */
     bool init(const AudioEncoderConfig& config, AVRational timeBase);
     
+    /**
+     * @brief 编码音频帧，编码包逐个交给sink（不分配，直接送封装器）
+     * @param frameData 输入音频帧
+     * @param sink 编码包回调
+     * @return true 成功，false 失败
+     */
+    bool encode(const AudioFrameData& frameData, const PacketSink& sink);
+    
+    /**
+     * @brief 刷新编码器，剩余编码包逐个交给sink
+     * @param sink 编码包回调
+     * @return true 成功，false 失败
+     */
+    bool flush(const PacketSink& sink);
+    
     /**
      * @brief 编码音频帧
      * @param frameData 输入音频帧
-     * @param packets 输出编码包列表
+     * @param packets 输出编码包列表（取自包池，用完通过releasePackets归还）
      * @return true 成功，false 失败
      */
     bool encode(const AudioFrameData& frameData, std::vector<AVPacket*>& packets);
     
     /**
      * @brief 刷新编码器，输出剩余帧
-     * @param packets 输出编码包列表
+     * @param packets 输出编码包列表（取自包池，用完通过releasePackets归还）
      * @return true 成功，false 失败
      */
     bool flush(std::vector<AVPacket*>& packets);
     
+    /**
+     * @brief 归还encode/flush输出的编码包并清空列表
+     */
+    void releasePackets(std::vector<AVPacket*>& packets) { packetPool_.release(packets); }
+    
     /**
      * @brief 关闭编码器
      */
@@ -89,6 +112,10 @@ private:
     AVCodecContext* codecContext_;
     AVFrame* frame_;
     SwrContext* swrContext_;
+    AVPacket* packet_;                  // 复用的接收包，交给sink后unref
+    PacketPool packetPool_;             // 列表接口输出包的对象池
+    AVBufferPool* copyBufferPool_;      // 流拷贝模式的包数据缓冲池
+    int copyBufferSize_;                // 缓冲池中每块的大小（含填充）
     
     // 配置
     AudioEncoderConfig config_;
@@ -97,6 +124,7 @@ private:
     // 状态
     bool initialized_;
     int64_t sampleIndex_;
+    bool startAligned_ = false;         // 首帧时间戳已换算为sampleIndex_起点
     
     // 重采样缓冲区
     uint8_t** resampleBuffer_;
@@ -111,7 +139,9 @@ private:
     AVFrame* convertAudioFrameData(const AudioFrameData& frameData);
     bool resampleAudio(const AudioFrameData& frameData, AVFrame* outputFrame);
     void updateStatistics(double encodingTime, size_t packetSize, int samples);
-    void freePackets(std::vector<AVPacket*>& packets);
+    int drainPackets(const PacketSink& sink, bool flushing, int samples,
+                     std::chrono::high_resolution_clock::time_point startTime);
+    PacketSink collectInto(std::vector<AVPacket*>& packets);
     void freeResampleBuffer();
     
     // 格式转换
@@ -120,7 +150,7 @@ private:
     bool needsResampling(const AudioFrameData& frameData) const;
     
     // 流拷贝模式
-    bool processStreamCopy(const AudioFrameData& frameData, std::vector<AVPacket*>& packets);
+    bool processStreamCopy(const AudioFrameData& frameData, const PacketSink& sink);
 };
 
 #endif // AUDIO_ENCODER_H
@@ -40,10 +40,14 @@ bool Encoder::init(const EncoderConfig& config) {
     LOG_INFO("Video: " + config_.videoCodec + " " + 
              std::to_string(config_.videoWidth) + "x" + std::to_string(config_.videoHeight) + 
              " @ " + std::to_string(config_.videoBitrate/1000) + "kbps");
-    LOG_INFO("Audio: " + config_.audioCodec + " " + 
-             std::to_string(config_.audioSampleRate) + "Hz " + 
-             std::to_string(config_.audioChannels) + "ch @ " + 
-             std::to_string(config_.audioBitrate/1000) + "kbps");
+    if (config_.audioPassthrough) {
+        LOG_INFO("Audio: passthrough (stream copy)");
+    } else {
+        LOG_INFO("Audio: " + config_.audioCodec + " " + 
+                 std::to_string(config_.audioSampleRate) + "Hz " + 
+                 std::to_string(config_.audioChannels) + "ch @ " + 
+                 std::to_string(config_.audioBitrate/1000) + "kbps");
+    }
     
     if (!initializeComponents()) {
         LOG_ERROR("Failed to initialize encoder components");
@@ -90,43 +94,63 @@ bool Encoder::push(const FrameVariant& frame) {
     return success;
 }
 
-bool Encoder::flush() {
+bool Encoder::pushAudioPacket(AVPacket* packet) {
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (!validateState(EncoderState::Running)) {
         return false;
     }
     
+    if (!config_.audioPassthrough) {
+        LOG_ERROR("Audio passthrough not enabled");
+        return false;
+    }
+    
+    if (!muxer_->writePacket(packet, 1)) {  // 音频流索引为1
+        LOG_ERROR("Failed to write passthrough audio packet");
+        return false;
+    }
+    
+    stats_.audioFramesEncoded++;
+    updateStatistics();
+    return true;
+}
+
+bool Encoder::flush() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return flushLocked();
+}
+
+bool Encoder::flushLocked() {
+    if (!validateState(EncoderState::Running)) {
+        return false;
+    }
+    
     LOG_INFO("Flushing encoders...");
     
     bool success = true;
     
     // 刷新视频编码器
     if (videoEncoder_) {
-        std::vector<AVPacket*> packets;
-        if (videoEncoder_->flush(packets)) {
-            for (auto* packet : packets) {
-                if (!muxer_->writePacket(packet, 0)) {  // 假设视频流索引为0
-                    success = false;
-                }
-                av_packet_free(&packet);
-            }
-        } else {
+        bool written = true;
+        bool flushed = videoEncoder_->flush([this, &written](AVPacket* packet) {
+            // 单个包写入失败不中止刷新，尽量写出剩余帧
+            written = muxer_->writePacket(packet, 0) && written;  // 假设视频流索引为0
+            return true;
+        });
+        if (!flushed || !written) {
             success = false;
         }
     }
     
     // 刷新音频编码器
     if (audioEncoder_) {
-        std::vector<AVPacket*> packets;
-        if (audioEncoder_->flush(packets)) {
-            for (auto* packet : packets) {
-                if (!muxer_->writePacket(packet, 1)) {  // 假设音频流索引为1
-                    success = false;
-                }
-                av_packet_free(&packet);
-            }
-        } else {
+        bool written = true;
+        bool flushed = audioEncoder_->flush([this, &written](AVPacket* packet) {
+            written = muxer_->writePacket(packet, 1) && written;  // 假设音频流索引为1
+            return true;
+        });
+        if (!flushed || !written) {
             success = false;
         }
     }
@@ -150,14 +174,19 @@ bool Encoder::close() {
     
     LOG_INFO("Closing encoder...");
     
-    // 如果还在运行状态，先刷新
+    bool success = true;
+    // 如果还在运行状态，先刷新（已持有锁，不能调用flush()）
     if (state_ == EncoderState::Running) {
-        flush();
+        success = flushLocked();
     }
     
-    // 关闭封装器
+    // 关闭封装器（写完文件尾后收集最终的时长和I/O统计）
     if (muxer_) {
-        muxer_->finalize();
+        if (!muxer_->finalize()) {
+            LOG_ERROR("Failed to finalize output: " + config_.outputPath);
+            success = false;
+        }
+        updateStatistics();
         muxer_.reset();
     }
     
@@ -175,15 +204,16 @@ bool Encoder::close() {
     setState(EncoderState::Closed);
     
     // 输出最终统计信息
-    auto finalStats = getStatistics();
+    auto finalStats = statisticsLocked();
     LOG_INFO("Encoding completed:");
     LOG_INFO("  Video frames: " + std::to_string(finalStats.videoFramesEncoded));
     LOG_INFO("  Audio frames: " + std::to_string(finalStats.audioFramesEncoded));
     LOG_INFO("  Total duration: " + std::to_string(finalStats.totalDuration) + "s");
     LOG_INFO("  Encoding speed: " + std::to_string(finalStats.encodingSpeed) + "x");
+    LOG_INFO("  I/O wait: " + std::to_string(finalStats.ioWaitMs) + "ms");
     LOG_INFO("  Output file: " + config_.outputPath);
     
-    return true;
+    return success;
 }
 
 EncoderState Encoder::getState() const {
@@ -193,7 +223,10 @@ EncoderState Encoder::getState() const {
 
 Encoder::Statistics Encoder::getStatistics() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    
+    return statisticsLocked();
+}
+
+Encoder::Statistics Encoder::statisticsLocked() const {
     auto currentStats = stats_;
     
     // 计算编码速度
@@ -247,6 +280,13 @@ bool Encoder::initializeComponents() {
     muxerConfig.outputPath = config_.outputPath;
     muxerConfig.format = config_.format;
     muxerConfig.fastStart = config_.fastStart;
+    muxerConfig.outputMode = config_.outputMode;
+    muxerConfig.fragmentDuration = config_.fragmentDuration;
+    muxerConfig.segmentDuration = config_.segmentDuration;
+    muxerConfig.segmentBaseName = config_.segmentBaseName;
+    muxerConfig.asyncIO = config_.asyncIO;
+    muxerConfig.directIO = config_.directIO;
+    muxerConfig.preallocateBytes = config_.preallocateBytes;
     
     if (!muxer_->init(muxerConfig)) {
         LOG_ERROR("Failed to initialize muxer");
@@ -264,6 +304,8 @@ bool Encoder::initializeComponents() {
     videoConfig.preset = config_.videoPreset;
     videoConfig.enableHardwareAccel = config_.enableHardwareAccel;
     videoConfig.threadCount = config_.threadCount;
+    videoConfig.numaNode = config_.numaNode;
+    videoConfig.swsThreads = config_.swsThreads;
     videoConfig.crf = config_.videoCRF;
     
                 AVRational videoTimeBase = {1, static_cast<int>(config_.videoFrameRate)};
@@ -272,9 +314,15 @@ bool Encoder::initializeComponents() {
         return false;
     }
     
-    // 创建音频编码器（如果需要）
+    // 创建音频编码器（如果需要，直通模式不需要）
     bool hasAudio = (config_.audioSampleRate > 0 && config_.audioChannels > 0);
-    if (hasAudio) {
+    if (config_.audioPassthrough) {
+        if (!config_.audioCodecParameters) {
+            LOG_ERROR("Audio passthrough requires source codec parameters");
+            return false;
+        }
+        LOG_INFO("Audio passthrough enabled, skipping audio encoder");
+    } else if (hasAudio) {
         audioEncoder_ = std::make_unique<AudioEncoder>();
         AudioEncoderConfig audioConfig;
         audioConfig.codec = config_.audioCodec;
@@ -298,8 +346,13 @@ bool Encoder::initializeComponents() {
         return false;
     }
     
-    // 只在有音频编码器时添加音频流
-    if (audioEncoder_) {
+    // 只在有音频编码器或直通时添加音频流
+    if (config_.audioPassthrough) {
+        if (muxer_->addAudioStreamCopy(config_.audioCodecParameters, config_.audioTimeBase) < 0) {
+            LOG_ERROR("Failed to add passthrough audio stream to muxer");
+            return false;
+        }
+    } else if (audioEncoder_) {
         if (muxer_->addAudioStream(audioEncoder_->getCodecContext()) < 0) {
             LOG_ERROR("Failed to add audio stream to muxer");
             return false;
@@ -340,6 +393,8 @@ bool Encoder::processVideoFrame(const FrameData& frame) {
             videoConfig.preset = config_.videoPreset;
             videoConfig.enableHardwareAccel = config_.enableHardwareAccel;
             videoConfig.threadCount = config_.threadCount;
+            videoConfig.numaNode = config_.numaNode;
+            videoConfig.swsThreads = config_.swsThreads;
             videoConfig.crf = config_.videoCRF;
             
             AVRational videoTimeBase = {1, static_cast<int>(config_.videoFrameRate)};
@@ -359,20 +414,19 @@ bool Encoder::processVideoFrame(const FrameData& frame) {
         }
     }
     
-    std::vector<AVPacket*> packets;
-    if (!videoEncoder_->encode(frame, packets)) {
-        LOG_ERROR("Failed to encode video frame");
+    // 编码包直接写入封装器，不经过中间列表
+    bool written = true;
+    bool encoded = videoEncoder_->encode(frame, [this, &written](AVPacket* packet) {
+        written = muxer_->writePacket(packet, 0);  // 视频流索引为0
+        return written;
+    });
+    if (!written) {
+        LOG_ERROR("Failed to write video packet");
         return false;
     }
-    
-    // 写入封装器
-    for (auto* packet : packets) {
-        if (!muxer_->writePacket(packet, 0)) {  // 视频流索引为0
-            LOG_ERROR("Failed to write video packet");
-            av_packet_free(&packet);
-            return false;
-        }
-        av_packet_free(&packet);
+    if (!encoded) {
+        LOG_ERROR("Failed to encode video frame");
+        return false;
     }
     
     return true;
@@ -384,20 +438,19 @@ bool Encoder::processAudioFrame(const AudioFrameData& frame) {
         return false;
     }
     
-    std::vector<AVPacket*> packets;
-    if (!audioEncoder_->encode(frame, packets)) {
-        LOG_ERROR("Failed to encode audio frame");
+    // 编码包直接写入封装器，不经过中间列表
+    bool written = true;
+    bool encoded = audioEncoder_->encode(frame, [this, &written](AVPacket* packet) {
+        written = muxer_->writePacket(packet, 1);  // 音频流索引为1
+        return written;
+    });
+    if (!written) {
+        LOG_ERROR("Failed to write audio packet");
         return false;
     }
-    
-    // 写入封装器
-    for (auto* packet : packets) {
-        if (!muxer_->writePacket(packet, 1)) {  // 音频流索引为1
-            LOG_ERROR("Failed to write audio packet");
-            av_packet_free(&packet);
-            return false;
-        }
-        av_packet_free(&packet);
+    if (!encoded) {
+        LOG_ERROR("Failed to encode audio frame");
+        return false;
     }
     
     return true;
@@ -418,6 +471,7 @@ void Encoder::updateStatistics() {
     if (muxer_) {
         auto muxerStats = muxer_->getStatistics();
         stats_.totalDuration = muxerStats.totalDuration;
+        stats_.ioWaitMs = muxerStats.ioWaitMs;
     }
 }
 
@@ -36,10 +36,26 @@ struct EncoderConfig {
     int audioSampleRate = 48000;          // 音频采样率
     int audioChannels = 2;                // 音频声道数
     
+    // 音频直通配置（流拷贝：源音频压缩包直接封装，不解码也不重新编码）
+    bool audioPassthrough = false;        // 启用音频直通（忽略上面的音频编码配置）
+    const AVCodecParameters* audioCodecParameters = nullptr;  // 源音频流参数（由调用方持有，init期间有效即可）
+    AVRational audioTimeBase = {0, 1};    // 源音频包的时间基准
+    
     // 高级配置
     bool enableHardwareAccel = false;     // 硬件加速
     int threadCount = 0;                  // 编码线程数 (0=auto)
-    bool fastStart = true;                // MP4快速启动
+    int numaNode = -1;                    // 视频编码线程绑定的NUMA节点 (-1=不绑定)
+    int swsThreads = 1;                   // 编码前色彩转换并行带数 (1=单线程, 0=auto)
+    bool fastStart = true;                // MP4快速启动（仅Standard模式）
+    MuxerOutputMode outputMode = MuxerOutputMode::Standard;  // 输出模式（普通/分片MP4/HLS分段）
+    double fragmentDuration = 0.0;        // 分片时长（秒，0=每个关键帧一片）
+    double segmentDuration = 6.0;         // HLS分段时长（秒）
+    std::string segmentBaseName;          // 分段文件名前缀（空=由输出路径推导）
+    
+    // 输出I/O
+    bool asyncIO = true;                  // 大块缓冲+后台线程写盘（false=FFmpeg默认同步写）
+    bool directIO = false;                // O_DIRECT对齐写，绕过页缓存
+    int64_t preallocateBytes = 0;         // 输出文件fallocate预分配大小（0=不预分配）
 };
 
 /**
@@ -79,6 +95,13 @@ public:
      */
     bool push(const FrameVariant& frame);
     
+    /**
+     * @brief 音频直通模式下写入源音频压缩包
+     * @param packet 音频包（时间基准为config.audioTimeBase），写入后被置空
+     * @return true 成功，false 失败
+     */
+    bool pushAudioPacket(AVPacket* packet);
+    
     /**
      * @brief 刷新编码器缓存
      * @return true 成功，false 失败
@@ -106,6 +129,7 @@ public:
         uint64_t totalBytesWritten = 0;
         double totalDuration = 0.0;
         double encodingSpeed = 0.0;  // 编码速度倍数
+        double ioWaitMs = 0.0;       // 等待写盘的时间（毫秒）
     };
     
     Statistics getStatistics() const;
@@ -144,6 +168,8 @@ private:
     
     // 内部方法
     bool initializeComponents();
+    bool flushLocked();
+    Statistics statisticsLocked() const;
     bool processVideoFrame(const FrameData& frame);
     bool processAudioFrame(const AudioFrameData& frame);
     void updateStatistics();
@@ -1,5 +1,15 @@
 #include "Muxer.h"
 #include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/MemoryTracker.h"
+#include "../Utils/Trace.h"
+
+namespace {
+
+// AVIO缓冲只用于攒小写，真正的大块缓冲在AsyncFileWriter中
+constexpr int kIOBufferSize = 256 * 1024;
+
+} // namespace
 
 Muxer::Muxer()
     : formatContext_(nullptr)
@@ -89,6 +99,38 @@ int Muxer::addAudioStream(AVCodecContext* codecContext) {
     return audioStreamIndex_;
 }
 
+int Muxer::addAudioStreamCopy(const AVCodecParameters* codecParameters, AVRational timeBase) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    
+    if (!initialized_ || !codecParameters) {
+        LOG_ERROR("Muxer not initialized or invalid codec parameters");
+        return -1;
+    }
+    
+    if (headerWritten_) {
+        LOG_ERROR("Cannot add stream after header is written");
+        return -1;
+    }
+    
+    if (!setupCopyStream(codecParameters, timeBase, false)) {
+        LOG_ERROR("Failed to setup audio stream copy");
+        return -1;
+    }
+    
+    audioStreamIndex_ = streams_.size() - 1;
+    LOG_INFO("Added audio stream copy (" + std::string(avcodec_get_name(codecParameters->codec_id)) +
+             ") at index: " + std::to_string(audioStreamIndex_));
+    return audioStreamIndex_;
+}
+
+bool Muxer::canStreamCopy(const std::string& format, AVCodecID codecId) {
+    const AVOutputFormat* outputFormat = av_guess_format(format.c_str(), nullptr, nullptr);
+    if (!outputFormat) {
+        return false;
+    }
+    return avformat_query_codec(outputFormat, codecId, FF_COMPLIANCE_NORMAL) == 1;
+}
+
 bool Muxer::writeHeader() {
     std::lock_guard<std::mutex> lock(mutex_);
     
@@ -109,13 +151,20 @@ bool Muxer::writeHeader() {
     
     LOG_INFO("Writing file header...");
     
-    // 设置MP4快速启动
-    if (config_.fastStart && config_.format == "mp4") {
-        av_dict_set(&formatContext_->metadata, "movflags", "faststart", 0);
-    }
+    // 封装器私有选项（movflags、hls_*）必须通过选项字典传给write_header
+    AVDictionary* options = nullptr;
+    buildHeaderOptions(&options);
     
     // 写入文件头
-    int ret = avformat_write_header(formatContext_, nullptr);
+    int ret = avformat_write_header(formatContext_, &options);
+    
+    // 剩下的是封装器不认识的选项
+    AVDictionaryEntry* unused = nullptr;
+    while ((unused = av_dict_get(options, "", unused, AV_DICT_IGNORE_SUFFIX))) {
+        LOG_WARNING("Muxer option not used by " + std::string(outputFormat_->name) + ": " + unused->key);
+    }
+    av_dict_free(&options);
+    
     if (ret < 0) {
         LOG_ERROR("Failed to write header: " + std::to_string(ret));
         return false;
@@ -129,6 +178,8 @@ bool Muxer::writeHeader() {
 }
 
 bool Muxer::writePacket(AVPacket* packet, int streamIndex) {
+    TRACE_SCOPE("Muxer::writePacket", "mux");
+    MEMORY_STAGE_SCOPE("mux");
     std::lock_guard<std::mutex> lock(mutex_);
     
     if (!initialized_ || !headerWritten_) {
@@ -149,12 +200,17 @@ bool Muxer::writePacket(AVPacket* packet, int streamIndex) {
     // 重新调整时间戳
     rescalePacketTimestamps(packet, streamIndex);
     
-    // 写入数据包
+    // 写入数据包（写入后packet被置空，先记录大小和时间戳）
+    int packetSize = packet->size;
+    int64_t packetPts = packet->pts;
     int ret;
-    if (config_.enableInterleaving) {
-        ret = av_interleaved_write_frame(formatContext_, packet);
-    } else {
-        ret = av_write_frame(formatContext_, packet);
+    {
+        METRICS_SCOPED_TIMER("mux_us");
+        if (config_.enableInterleaving) {
+            ret = av_interleaved_write_frame(formatContext_, packet);
+        } else {
+            ret = av_write_frame(formatContext_, packet);
+        }
     }
     
     if (ret < 0) {
@@ -162,9 +218,11 @@ bool Muxer::writePacket(AVPacket* packet, int streamIndex) {
         return false;
     }
     
+    METRICS_COUNTER_ADD("mux_bytes", packetSize);
+    
     // 更新统计信息
     bool isVideo = (streamIndex == videoStreamIndex_);
-    updateStatistics(packet, isVideo);
+    updateStatistics(packetSize, packetPts, streamIndex, isVideo);
     
     return true;
 }
@@ -190,6 +248,17 @@ bool Muxer::finalize() {
         return false;
     }
     
+    // 自定义I/O：等待后台写盘完成后才算写完
+    bool ioOk = true;
+    if (writer_) {
+        avio_flush(formatContext_->pb);
+        ioOk = writer_->close();
+        collectIOStatistics();
+        if (!ioOk) {
+            LOG_ERROR("Failed to write output file: " + config_.outputPath);
+        }
+    }
+    
     finalized_ = true;
     stats_.finalized = true;
     
@@ -200,15 +269,30 @@ bool Muxer::finalize() {
     LOG_INFO("  Audio packets: " + std::to_string(stats_.audioPackets));
     LOG_INFO("  Total bytes: " + std::to_string(stats_.totalBytes));
     LOG_INFO("  Duration: " + std::to_string(stats_.totalDuration) + "s");
+    if (writer_) {
+        LOG_INFO("  I/O wait: " + std::to_string(stats_.ioWaitMs) + "ms, write: " +
+                 std::to_string(stats_.ioWriteMs) + "ms");
+    }
     
-    return true;
+    return ioOk;
 }
 
 Muxer::Statistics Muxer::getStatistics() const {
     std::lock_guard<std::mutex> lock(mutex_);
+    collectIOStatistics();
     return stats_;
 }
 
+void Muxer::collectIOStatistics() const {
+    if (!writer_) {
+        return;
+    }
+    auto ioStats = writer_->getStatistics();
+    stats_.ioBytesWritten = ioStats.bytesWritten;
+    stats_.ioWaitMs = ioStats.ioWaitMs;
+    stats_.ioWriteMs = ioStats.writeMs;
+}
+
 std::vector<std::string> Muxer::getSupportedFormats() {
     std::vector<std::string> formats;
     
@@ -230,7 +314,61 @@ bool Muxer::isFormatSupported(const std::string& format) {
     return outputFormat != nullptr;
 }
 
+void Muxer::buildHeaderOptions(AVDictionary** options) const {
+    bool isMov = config_.format == "mp4" || config_.format == "mov";
+    
+    switch (config_.outputMode) {
+        case MuxerOutputMode::Standard:
+            // 设置MP4快速启动（结束时把moov移到文件头，需要整体重写一遍）
+            if (config_.fastStart && isMov) {
+                av_dict_set(options, "movflags", "+faststart", 0);
+            }
+            break;
+            
+        case MuxerOutputMode::Fragmented:
+            if (!isMov) {
+                LOG_WARNING("Fragmented output requires mp4/mov, got: " + config_.format);
+                break;
+            }
+            // 空moov写在文件头，之后每片moof+mdat顺序追加，结束时无需回写
+            if (config_.fragmentDuration > 0.0) {
+                av_dict_set(options, "movflags", "+empty_moov+default_base_moof", 0);
+                av_dict_set_int(options, "frag_duration", static_cast<int64_t>(config_.fragmentDuration * 1000000), 0);
+            } else {
+                av_dict_set(options, "movflags", "+frag_keyframe+empty_moov+default_base_moof", 0);
+            }
+            break;
+            
+        case MuxerOutputMode::Segmented: {
+            // 分段文件与播放列表放在同一目录，播放列表随分段完成逐步追加
+            std::string directory;
+            std::string baseName = config_.segmentBaseName;
+            size_t slash = config_.outputPath.find_last_of('/');
+            if (slash != std::string::npos) {
+                directory = config_.outputPath.substr(0, slash + 1);
+            }
+            if (baseName.empty()) {
+                std::string fileName = config_.outputPath.substr(directory.size());
+                baseName = fileName.substr(0, fileName.find_last_of('.'));
+            }
+            av_dict_set(options, "hls_time", std::to_string(config_.segmentDuration).c_str(), 0);
+            av_dict_set(options, "hls_list_size", "0", 0);
+            av_dict_set(options, "hls_playlist_type", "event", 0);
+            av_dict_set(options, "hls_segment_type", "fmp4", 0);
+            av_dict_set(options, "hls_flags", "independent_segments+temp_file", 0);
+            av_dict_set(options, "hls_segment_filename", (directory + baseName + "_%05d.m4s").c_str(), 0);
+            av_dict_set(options, "hls_fmp4_init_filename", (baseName + "_init.mp4").c_str(), 0);
+            break;
+        }
+    }
+}
+
 bool Muxer::setupOutputFormat() {
+    // 分段模式由hls封装器负责打开播放列表和各分段文件
+    if (config_.outputMode == MuxerOutputMode::Segmented) {
+        config_.format = "hls";
+    }
+    
     // 猜测输出格式
     outputFormat_ = av_guess_format(config_.format.c_str(), config_.outputPath.c_str(), nullptr);
     if (!outputFormat_) {
@@ -246,6 +384,9 @@ bool Muxer::setupOutputFormat() {
     }
     
     // 打开输出文件
+    if (!(outputFormat_->flags & AVFMT_NOFILE) && config_.asyncIO) {
+        return openAsyncIO();
+    }
     if (!(outputFormat_->flags & AVFMT_NOFILE)) {
         ret = avio_open(&formatContext_->pb, config_.outputPath.c_str(), AVIO_FLAG_WRITE);
         if (ret < 0) {
@@ -257,6 +398,76 @@ bool Muxer::setupOutputFormat() {
     return true;
 }
 
+bool Muxer::openAsyncIO() {
+    AsyncFileWriterConfig writerConfig;
+    writerConfig.blockSize = config_.ioBlockSize;
+    writerConfig.maxPendingBlocks = config_.ioMaxPendingBlocks;
+    writerConfig.directIO = config_.directIO;
+    writerConfig.preallocateBytes = config_.preallocateBytes;
+    
+    writer_ = std::make_unique<AsyncFileWriter>(writerConfig);
+    if (!writer_->open(config_.outputPath)) {
+        writer_.reset();
+        return false;
+    }
+    
+    uint8_t* buffer = static_cast<uint8_t*>(av_malloc(kIOBufferSize));
+    if (!buffer) {
+        LOG_ERROR("Failed to allocate AVIO buffer");
+        writer_.reset();
+        return false;
+    }
+    AVIOContext* pb = avio_alloc_context(buffer, kIOBufferSize, 1, writer_.get(), nullptr,
+                                         &Muxer::ioWritePacket, &Muxer::ioSeek);
+    if (!pb) {
+        LOG_ERROR("Failed to allocate AVIO context");
+        av_free(buffer);
+        writer_.reset();
+        return false;
+    }
+    
+    formatContext_->pb = pb;
+    formatContext_->flags |= AVFMT_FLAG_CUSTOM_IO;
+    // 封装器另行打开文件（如MP4 faststart回读）前先让排队的数据落盘
+    formatContext_->opaque = this;
+    formatContext_->io_open = &Muxer::ioOpen;
+    return true;
+}
+
+void Muxer::closeAsyncIO() {
+    if (formatContext_ && formatContext_->pb && (formatContext_->flags & AVFMT_FLAG_CUSTOM_IO)) {
+        av_freep(&formatContext_->pb->buffer);
+        avio_context_free(&formatContext_->pb);
+    }
+    if (writer_) {
+        writer_->close();
+        collectIOStatistics();
+        writer_.reset();
+    }
+}
+
+int Muxer::ioWritePacket(void* opaque, uint8_t* buffer, int size) {
+    auto* writer = static_cast<AsyncFileWriter*>(opaque);
+    return writer->write(buffer, static_cast<size_t>(size)) ? size : AVERROR(EIO);
+}
+
+int64_t Muxer::ioSeek(void* opaque, int64_t offset, int whence) {
+    auto* writer = static_cast<AsyncFileWriter*>(opaque);
+    if (whence & AVSEEK_SIZE) {
+        return writer->size();
+    }
+    int64_t position = writer->seek(offset, whence & ~AVSEEK_FORCE);
+    return position >= 0 ? position : AVERROR(EINVAL);
+}
+
+int Muxer::ioOpen(AVFormatContext* context, AVIOContext** pb, const char* url, int flags, AVDictionary** options) {
+    auto* muxer = static_cast<Muxer*>(context->opaque);
+    if (muxer && muxer->writer_ && !muxer->writer_->sync()) {
+        return AVERROR(EIO);
+    }
+    return avio_open2(pb, url, flags, &context->interrupt_callback, options);
+}
+
 bool Muxer::setupOutputStream(AVCodecContext* codecContext, bool isVideo) {
     // 创建流
     AVStream* stream = avformat_new_stream(formatContext_, nullptr);
@@ -280,6 +491,34 @@ bool Muxer::setupOutputStream(AVCodecContext* codecContext, bool isVideo) {
     streamInfo.index = stream->index;
     streamInfo.stream = stream;
     streamInfo.codecContext = codecContext;
+    streamInfo.packetTimeBase = codecContext->time_base;
+    streamInfo.isVideo = isVideo;
+    
+    streams_.push_back(streamInfo);
+    
+    return true;
+}
+
+bool Muxer::setupCopyStream(const AVCodecParameters* codecParameters, AVRational timeBase, bool isVideo) {
+    AVStream* stream = avformat_new_stream(formatContext_, nullptr);
+    if (!stream) {
+        LOG_ERROR("Failed to create new stream");
+        return false;
+    }
+    
+    int ret = avcodec_parameters_copy(stream->codecpar, codecParameters);
+    if (ret < 0) {
+        LOG_ERROR("Failed to copy codec parameters: " + std::to_string(ret));
+        return false;
+    }
+    // 源容器的codec_tag不一定适用于目标容器，交给封装器重新选择
+    stream->codecpar->codec_tag = 0;
+    stream->time_base = timeBase;
+    
+    StreamInfo streamInfo;
+    streamInfo.index = stream->index;
+    streamInfo.stream = stream;
+    streamInfo.packetTimeBase = timeBase;
     streamInfo.isVideo = isVideo;
     
     streams_.push_back(streamInfo);
@@ -306,9 +545,9 @@ bool Muxer::validatePacket(AVPacket* packet, int streamIndex) const {
     return true;
 }
 
-void Muxer::updateStatistics(AVPacket* packet, bool isVideo) {
+void Muxer::updateStatistics(int packetSize, int64_t pts, int streamIndex, bool isVideo) {
     stats_.totalPackets++;
-    stats_.totalBytes += packet->size;
+    stats_.totalBytes += packetSize;
     
     if (isVideo) {
         stats_.videoPackets++;
@@ -317,9 +556,9 @@ void Muxer::updateStatistics(AVPacket* packet, bool isVideo) {
     }
     
     // 更新总时长
-    if (packet->pts != AV_NOPTS_VALUE) {
-        const StreamInfo& streamInfo = streams_[packet->stream_index];
-        double timestamp = packet->pts * av_q2d(streamInfo.stream->time_base);
+    if (pts != AV_NOPTS_VALUE) {
+        const StreamInfo& streamInfo = streams_[streamIndex];
+        double timestamp = pts * av_q2d(streamInfo.stream->time_base);
         if (timestamp > stats_.totalDuration) {
             stats_.totalDuration = timestamp;
         }
@@ -332,15 +571,15 @@ void Muxer::rescalePacketTimestamps(AVPacket* packet, int streamIndex) {
     
     // 重新调整时间戳到流的时间基准
     if (packet->pts != AV_NOPTS_VALUE) {
-        packet->pts = av_rescale_q(packet->pts, streamInfo.codecContext->time_base, stream->time_base);
+        packet->pts = av_rescale_q(packet->pts, streamInfo.packetTimeBase, stream->time_base);
     }
     
     if (packet->dts != AV_NOPTS_VALUE) {
-        packet->dts = av_rescale_q(packet->dts, streamInfo.codecContext->time_base, stream->time_base);
+        packet->dts = av_rescale_q(packet->dts, streamInfo.packetTimeBase, stream->time_base);
     }
     
     if (packet->duration > 0) {
-        packet->duration = av_rescale_q(packet->duration, streamInfo.codecContext->time_base, stream->time_base);
+        packet->duration = av_rescale_q(packet->duration, streamInfo.packetTimeBase, stream->time_base);
     }
     
     // 确保DTS <= PTS
@@ -385,7 +624,9 @@ int64_t Muxer::getNextDts(int streamIndex, int64_t currentDts) {
 
 void Muxer::cleanup() {
     if (formatContext_) {
-        if (!(outputFormat_->flags & AVFMT_NOFILE)) {
+        if (writer_) {
+            closeAsyncIO();
+        } else if (!(outputFormat_->flags & AVFMT_NOFILE)) {
             avio_closep(&formatContext_->pb);
         }
         avformat_free_context(formatContext_);
@@ -5,21 +5,43 @@
 #include <vector>
 #include <mutex>
 #include <algorithm>
+#include <memory>
+#include "AsyncFileWriter.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 }
 
+/**
+ * @brief 输出模式
+ */
+enum class MuxerOutputMode {
+    Standard,       // 普通文件（MP4可选faststart，结束时整体重写一遍）
+    Fragmented,     // 分片MP4：moov在文件头，按片写出，写入过程中即可播放
+    Segmented       // 分段输出：固定时长的fMP4分段 + HLS播放列表
+};
+
 /**
  * @brief 封装器配置
  */
 struct MuxerConfig {
-    std::string outputPath;             // 输出文件路径
-    std::string format = "mp4";         // 输出格式
-    bool fastStart = true;              // MP4快速启动
+    std::string outputPath;             // 输出文件路径（Segmented模式为播放列表.m3u8）
+    std::string format = "mp4";         // 输出格式（Segmented模式固定为hls）
+    bool fastStart = true;              // MP4快速启动（仅Standard模式）
+    MuxerOutputMode outputMode = MuxerOutputMode::Standard;  // 输出模式
+    double fragmentDuration = 0.0;      // 分片时长（秒，0=每个关键帧一片，仅Fragmented）
+    double segmentDuration = 6.0;       // 分段时长（秒，仅Segmented，在关键帧处切分）
+    std::string segmentBaseName;        // 分段文件名前缀（空=播放列表文件名去扩展名）
     int64_t maxFileSize = 0;            // 最大文件大小（0=无限制）
     bool enableInterleaving = true;     // 启用时间交错
+    
+    // 输出I/O（仅对写本地/挂载文件的格式生效）
+    bool asyncIO = true;                // 大块缓冲+后台线程写盘（false=FFmpeg默认avio同步写）
+    size_t ioBlockSize = 4 << 20;       // 写盘块大小（字节）
+    size_t ioMaxPendingBlocks = 4;      // 最多排队等待写盘的块数
+    bool directIO = false;              // O_DIRECT对齐写（不满足对齐的写自动回退普通写）
+    int64_t preallocateBytes = 0;       // fallocate预分配大小（0=不预分配）
 };
 
 /**
@@ -28,7 +50,8 @@ struct MuxerConfig {
 struct StreamInfo {
     int index = -1;                     // 流索引
     AVStream* stream = nullptr;         // AVStream指针
-    AVCodecContext* codecContext = nullptr;  // 编码器上下文
+    AVCodecContext* codecContext = nullptr;  // 编码器上下文（流拷贝时为空）
+    AVRational packetTimeBase = {0, 1}; // 写入包的时间基准（编码器或源流）
     bool isVideo = false;               // 是否为视频流
     int64_t lastPts = AV_NOPTS_VALUE;   // 最后一个PTS
     int64_t lastDts = AV_NOPTS_VALUE;   // 最后一个DTS
@@ -65,6 +88,22 @@ public:
      */
     int addAudioStream(AVCodecContext* codecContext);
     
+    /**
+     * @brief 添加流拷贝音频流（源压缩包直接封装，不经过编码器）
+     * @param codecParameters 源音频流参数
+     * @param timeBase 源音频包的时间基准
+     * @return 流索引，-1表示失败
+     */
+    int addAudioStreamCopy(const AVCodecParameters* codecParameters, AVRational timeBase);
+    
+    /**
+     * @brief 检查容器格式能否直接封装指定编码的流
+     * @param format 格式名称
+     * @param codecId 编码ID
+     * @return true 支持，false 不支持
+     */
+    static bool canStreamCopy(const std::string& format, AVCodecID codecId);
+    
     /**
      * @brief 写入文件头
      * @return true 成功，false 失败
@@ -96,6 +135,9 @@ public:
         double totalDuration = 0.0;
         bool headerWritten = false;
         bool finalized = false;
+        uint64_t ioBytesWritten = 0;    // 实际写盘字节数（asyncIO）
+        double ioWaitMs = 0.0;          // 封装线程等待写盘的时间（毫秒，asyncIO）
+        double ioWriteMs = 0.0;         // 后台写盘耗时（毫秒，asyncIO）
     };
     
     Statistics getStatistics() const;
@@ -131,6 +173,9 @@ private:
     bool headerWritten_;
     bool finalized_;
     
+    // 自定义输出I/O
+    std::unique_ptr<AsyncFileWriter> writer_;
+    
     // 线程安全
     mutable std::mutex mutex_;
     
@@ -139,9 +184,17 @@ private:
     
     // 内部方法
     bool setupOutputFormat();
+    void buildHeaderOptions(AVDictionary** options) const;
+    bool openAsyncIO();
+    void closeAsyncIO();
+    void collectIOStatistics() const;
+    static int ioWritePacket(void* opaque, uint8_t* buffer, int size);
+    static int64_t ioSeek(void* opaque, int64_t offset, int whence);
+    static int ioOpen(AVFormatContext* context, AVIOContext** pb, const char* url, int flags, AVDictionary** options);
     bool setupOutputStream(AVCodecContext* codecContext, bool isVideo);
+    bool setupCopyStream(const AVCodecParameters* codecParameters, AVRational timeBase, bool isVideo);
     bool validatePacket(AVPacket* packet, int streamIndex) const;
-    void updateStatistics(AVPacket* packet, bool isVideo);
+    void updateStatistics(int packetSize, int64_t pts, int streamIndex, bool isVideo);
     void rescalePacketTimestamps(AVPacket* packet, int streamIndex);
     
     // 时间戳管理
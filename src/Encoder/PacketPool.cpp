@@ -0,0 +1,68 @@
+#include "PacketPool.h"
+#include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+
+PacketPool::PacketPool(size_t maxCached)
+    : maxCached_(maxCached) {
+    free_.reserve(maxCached_);
+}
+
+PacketPool::~PacketPool() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto* packet : free_) {
+        av_packet_free(&packet);
+    }
+    free_.clear();
+}
+
+AVPacket* PacketPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!free_.empty()) {
+            AVPacket* packet = free_.back();
+            free_.pop_back();
+            return packet;
+        }
+        ++allocations_;
+    }
+
+    METRICS_COUNTER_ADD("packet_pool_allocs", 1);
+    AVPacket* packet = av_packet_alloc();
+    if (!packet) {
+        LOG_ERROR("PacketPool: failed to allocate packet");
+    }
+    return packet;
+}
+
+void PacketPool::release(AVPacket* packet) {
+    if (!packet) {
+        return;
+    }
+    av_packet_unref(packet);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.size() < maxCached_) {
+            free_.push_back(packet);
+            return;
+        }
+    }
+    av_packet_free(&packet);
+}
+
+void PacketPool::release(std::vector<AVPacket*>& packets) {
+    for (auto* packet : packets) {
+        release(packet);
+    }
+    packets.clear();
+}
+
+size_t PacketPool::cached() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return free_.size();
+}
+
+uint64_t PacketPool::allocations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocations_;
+}
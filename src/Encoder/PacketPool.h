@@ -0,0 +1,62 @@
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 编码包接收回调
+ *
+ * packet 归编码器所有，仅在回调期间有效；回调可以取走其引用
+ * （av_packet_move_ref、av_interleaved_write_frame），返回后编码器负责unref并复用。
+ * 返回false时编码中止并报告失败。
+ */
+using PacketSink = std::function<bool(AVPacket* packet)>;
+
+/**
+ * @brief AVPacket对象池
+ *
+ * 回收AVPacket结构体本身，避免逐包av_packet_alloc/av_packet_free；
+ * 包数据仍由AVBufferRef引用计数管理。线程安全。
+ */
+class PacketPool {
+public:
+    explicit PacketPool(size_t maxCached = 64);
+    ~PacketPool();
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool& operator=(const PacketPool&) = delete;
+
+    /**
+     * @brief 取出一个空包，池为空时才新分配
+     * @return AVPacket指针，分配失败返回nullptr
+     */
+    AVPacket* acquire();
+
+    /**
+     * @brief 归还包（先unref），超过缓存上限时直接释放
+     */
+    void release(AVPacket* packet);
+
+    /**
+     * @brief 归还一组包并清空列表
+     */
+    void release(std::vector<AVPacket*>& packets);
+
+    size_t cached() const;
+    uint64_t allocations() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<AVPacket*> free_;
+    size_t maxCached_;
+    uint64_t allocations_ = 0;
+};
+
+#endif // PACKET_POOL_H
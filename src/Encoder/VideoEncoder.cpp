@@ -1,15 +1,17 @@
 #include "VideoEncoder.h"
 #include "../Utils/Logger.h"
+#include "../Utils/CpuTopology.h"
+#include "../Utils/Metrics.h"
+#include "../Utils/Trace.h"
 #include <opencv2/opencv.hpp>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 
 VideoEncoder::VideoEncoder()
     : codec_(nullptr)
     , codecContext_(nullptr)
-    , frame_(nullptr)
-    , swsContext_(nullptr)
-    , lastSrcWidth_(0)
-    , lastSrcHeight_(0)
+    , packet_(nullptr)
     , initialized_(false)
     , frameIndex_(0) {
     LOG_DEBUG("VideoEncoder created");
@@ -39,6 +41,13 @@ bool VideoEncoder::init(const VideoEncoderConfig& config, AVRational timeBase) {
         return false;
     }
     
+    // 接收包整个生命周期只分配一次
+    packet_ = av_packet_alloc();
+    if (!packet_) {
+        LOG_ERROR("Failed to allocate packet");
+        return false;
+    }
+    
     initialized_ = true;
     frameIndex_ = 0;
     
@@ -46,7 +55,9 @@ bool VideoEncoder::init(const VideoEncoderConfig& config, AVRational timeBase) {
     return true;
 }
 
-bool VideoEncoder::encode(const FrameData& frameData, std::vector<AVPacket*>& packets) {
+bool VideoEncoder::encode(const FrameData& frameData, const PacketSink& sink) {
+    TRACE_SCOPE("VideoEncoder::encode", "encode");
+    MEMORY_STAGE_SCOPE("encode");
     if (!initialized_) {
         LOG_ERROR("VideoEncoder not initialized");
         return false;
@@ -60,47 +71,24 @@ bool VideoEncoder::encode(const FrameData& frameData, std::vector<AVPacket*>& pa
         LOG_ERROR("Failed to convert frame data");
         return false;
     }
+    frameMemory_.update(MemoryTracker::frameBufferBytes(avFrame));
     
     // 时间戳已经在convertFrameData中设置了，不要重复设置
     
-    // 发送帧到编码器
+    // 发送帧到编码器（编码器按需引用帧缓冲，本地帧随即释放，缓冲在编码器用完后回池）
+    METRICS_SCOPED_TIMER("video_encode_us");
     int ret = avcodec_send_frame(codecContext_, avFrame);
+    av_frame_free(&avFrame);
     if (ret < 0) {
         LOG_ERROR("Error sending frame to encoder: " + std::to_string(ret));
         return false;
     }
     
     // 接收编码包
-    while (ret >= 0) {
-        AVPacket* packet = av_packet_alloc();
-        if (!packet) {
-            LOG_ERROR("Failed to allocate packet");
-            return false;
-        }
-        
-        ret = avcodec_receive_packet(codecContext_, packet);
-        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-            av_packet_free(&packet);
-            break;
-        } else if (ret < 0) {
-            LOG_ERROR("Error receiving packet from encoder: " + std::to_string(ret));
-            av_packet_free(&packet);
-            return false;
-        }
-        
-        packets.push_back(packet);
-        
-        // 更新统计信息
-        auto endTime = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
-        updateStatistics(duration.count() / 1000.0, packet->size);
-    }
-    
-    // 注意：不要释放avFrame，因为它指向的是frame_成员变量
-    return true;
+    return drainPackets(sink, false, startTime) >= 0;
 }
 
-bool VideoEncoder::flush(std::vector<AVPacket*>& packets) {
+bool VideoEncoder::flush(const PacketSink& sink) {
     if (!initialized_) {
         LOG_ERROR("VideoEncoder not initialized");
         return false;
@@ -116,39 +104,82 @@ bool VideoEncoder::flush(std::vector<AVPacket*>& packets) {
     }
     
     // 接收剩余的编码包
-    while (ret >= 0) {
-        AVPacket* packet = av_packet_alloc();
-        if (!packet) {
-            LOG_ERROR("Failed to allocate packet");
+    int count = drainPackets(sink, true, std::chrono::high_resolution_clock::now());
+    if (count < 0) {
+        return false;
+    }
+    
+    LOG_DEBUG("Video encoder flushed, " + std::to_string(count) + " packets");
+    return true;
+}
+
+bool VideoEncoder::encode(const FrameData& frameData, std::vector<AVPacket*>& packets) {
+    return encode(frameData, collectInto(packets));
+}
+
+bool VideoEncoder::flush(std::vector<AVPacket*>& packets) {
+    return flush(collectInto(packets));
+}
+
+PacketSink VideoEncoder::collectInto(std::vector<AVPacket*>& packets) {
+    return [this, &packets](AVPacket* packet) {
+        AVPacket* out = packetPool_.acquire();
+        if (!out) {
             return false;
         }
-        
-        ret = avcodec_receive_packet(codecContext_, packet);
-        if (ret == AVERROR_EOF) {
-            av_packet_free(&packet);
+        av_packet_move_ref(out, packet);
+        packets.push_back(out);
+        return true;
+    };
+}
+
+int VideoEncoder::drainPackets(const PacketSink& sink, bool flushing,
+                               std::chrono::high_resolution_clock::time_point startTime) {
+    int count = 0;
+    while (true) {
+        int ret = avcodec_receive_packet(codecContext_, packet_);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
             break;
         } else if (ret < 0) {
             LOG_ERROR("Error receiving packet from encoder: " + std::to_string(ret));
-            av_packet_free(&packet);
-            return false;
+            return -1;
         }
         
-        packets.push_back(packet);
-        updateStatistics(0.0, packet->size);
+        // sink可能取走包的引用（如av_interleaved_write_frame），先记录大小
+        int packetSize = packet_->size;
+        double encodingTime = 0.0;
+        if (!flushing) {
+            METRICS_COUNTER_ADD("video_encoded_bytes", packetSize);
+            MemoryTracker::getInstance().recordTransient(MemoryTracker::Source::FFmpeg, packetSize);
+            auto endTime = std::chrono::high_resolution_clock::now();
+            encodingTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count() / 1000.0;
+        }
+        
+        // 更新统计信息
+        updateStatistics(encodingTime, packetSize);
+        
+        bool accepted = sink(packet_);
+        av_packet_unref(packet_);
+        if (!accepted) {
+            LOG_ERROR("Packet sink rejected video packet");
+            return -1;
+        }
+        ++count;
     }
-    
-    LOG_DEBUG("Video encoder flushed, " + std::to_string(packets.size()) + " packets");
-    return true;
+    return count;
 }
 
 void VideoEncoder::close() {
-    if (swsContext_) {
-        sws_freeContext(swsContext_);
-        swsContext_ = nullptr;
+    if (initialized_) {
+        ScalerCache::Statistics scalerStats = scaler_.getStatistics();
+        LOG_DEBUG("VideoEncoder scaler: " + std::to_string(scalerStats.contextCreates) + " contexts created, " +
+                  std::to_string(scalerStats.contextHits) + " reused");
     }
+    scaler_.clear();
+    frameMemory_.reset();
     
-    if (frame_) {
-        av_frame_free(&frame_);
+    if (packet_) {
+        av_packet_free(&packet_);
     }
     
     if (codecContext_) {
@@ -220,115 +251,63 @@ bool VideoEncoder::setupCodec() {
         }
     }
     
-    // 打开编码器
+    // 打开编码器（x264的帧线程与lookahead线程在此创建并继承亲和性）
+    ScopedNumaBinding numaBinding(config_.numaNode);
     int ret = avcodec_open2(codecContext_, codec_, nullptr);
     if (ret < 0) {
         LOG_ERROR("Failed to open codec: " + std::to_string(ret));
         return false;
     }
     
-    // 分配帧
-    frame_ = av_frame_alloc();
-    if (!frame_) {
-        LOG_ERROR("Failed to allocate frame");
-        return false;
-    }
-    
-    frame_->format = codecContext_->pix_fmt;
-    frame_->width = codecContext_->width;
-    frame_->height = codecContext_->height;
-    
-    ret = av_frame_get_buffer(frame_, 0);
-    if (ret < 0) {
-        LOG_ERROR("Failed to allocate frame buffer: " + std::to_string(ret));
-        return false;
-    }
-    
     return true;
 }
 
 AVFrame* VideoEncoder::convertFrameData(const FrameData& frameData) {
-    if (frameData.image.empty()) {
+    const cv::Mat& image = frameData.image;
+    if (image.empty()) {
         LOG_ERROR("Input image is empty");
         return nullptr;
     }
     
-    // 重新分配frame以匹配当前尺寸
-    if (frame_->width != frameData.width || frame_->height != frameData.height) {
-        av_frame_unref(frame_);
-        frame_->format = codecContext_->pix_fmt;
-        frame_->width = frameData.width;
-        frame_->height = frameData.height;
-        
-        int ret = av_frame_get_buffer(frame_, 0);
-        if (ret < 0) {
-            LOG_ERROR("Failed to reallocate frame buffer: " + std::to_string(ret));
-            return nullptr;
-        }
-    }
-    
-    // 确保帧可写
-    if (av_frame_make_writable(frame_) < 0) {
-        LOG_ERROR("Failed to make frame writable");
-        return nullptr;
-    }
-    
-    // 使用SwScale进行转换
-    if (!setupSwsContext(frameData.width, frameData.height)) {
-        LOG_ERROR("Failed to setup SwsContext");
+    // 输入尺寸可能逐帧变化（自适应码率源），统一缩放到编码器尺寸；
+    // 不同输入尺寸各自对应一个缓存的SwsContext，来回切换时不再重建
+    ScalerKey key;
+    key.srcWidth = image.cols;
+    key.srcHeight = image.rows;
+    key.srcFormat = image.channels() == 1 ? AV_PIX_FMT_GRAY8
+                  : image.channels() == 4 ? AV_PIX_FMT_BGRA : AV_PIX_FMT_BGR24;
+    key.dstWidth = codecContext_->width;
+    key.dstHeight = codecContext_->height;
+    key.dstFormat = codecContext_->pix_fmt;
+    key.flags = SWS_BICUBIC;
+    
+    // 编码器可能仍引用上一帧，每帧从缓冲池取新缓冲而不是改写共享帧
+    AVFrame* frame = scaler_.acquireFrame(key.dstWidth, key.dstHeight, key.dstFormat);
+    if (!frame) {
+        LOG_ERROR("Failed to allocate frame");
         return nullptr;
     }
     
-    // 创建输入数据指针和行大小
-    const uint8_t* srcData[4] = {0};
-    int srcLinesize[4] = {0};
-    
-    // OpenCV Mat是连续的BGR数据
-    srcData[0] = frameData.image.data;
-    srcLinesize[0] = frameData.image.step[0];  // 使用OpenCV的step
-    
-    // 进行格式转换
-    int ret = sws_scale(swsContext_,
-                       srcData, srcLinesize, 0, frameData.height,
-                       frame_->data, frame_->linesize);
+    const uint8_t* srcData[4] = {image.data, nullptr, nullptr, nullptr};
+    int srcLinesize[4] = {static_cast<int>(image.step[0]), 0, 0, 0};
     
-    if (ret < 0) {
-        LOG_ERROR("Failed to scale frame: " + std::to_string(ret));
+    // 进行格式转换（输入已是编码尺寸时按行分带并行）
+    METRICS_SCOPED_TIMER("video_encode_sws_us");
+    if (!scaler_.scale(key, srcData, srcLinesize, frame->data, frame->linesize, config_.swsThreads)) {
+        LOG_ERROR("Failed to scale frame");
+        av_frame_free(&frame);
         return nullptr;
     }
     
-    // 设置时间戳 - 基于帧索引和时间基准
-    frame_->pts = frameIndex_++;
-    
-    LOG_DEBUG("Frame " + std::to_string(frameIndex_-1) + " PTS: " + std::to_string(frame_->pts));
-    
-    return frame_;
-}
-
-bool VideoEncoder::setupSwsContext(int srcWidth, int srcHeight) {
-    // 如果尺寸变化了，重新创建SwsContext
-    if (swsContext_ && (lastSrcWidth_ != srcWidth || lastSrcHeight_ != srcHeight)) {
-        sws_freeContext(swsContext_);
-        swsContext_ = nullptr;
+    // 设置时间戳 - 基于帧索引和时间基准，起点取首帧时间戳
+    if (frameIndex_ == 0) {
+        ptsOffset_ = std::max<int64_t>(0, std::llround(frameData.timestamp / av_q2d(timeBase_)));
     }
+    frame->pts = ptsOffset_ + frameIndex_++;
     
-    if (!swsContext_) {
-        // 输入是BGR24格式，输出是编码器要求的格式
-        swsContext_ = sws_getContext(
-            srcWidth, srcHeight, AV_PIX_FMT_BGR24,
-            frame_->width, frame_->height, codecContext_->pix_fmt,
-            SWS_BICUBIC, nullptr, nullptr, nullptr);
-        
-        if (!swsContext_) {
-            LOG_ERROR("Failed to create SwsContext");
-            return false;
-        }
-        
-        lastSrcWidth_ = srcWidth;
-        lastSrcHeight_ = srcHeight;
-    }
+    LOGF_DEBUG("Frame %lld PTS: %lld", static_cast<long long>(frameIndex_ - 1), static_cast<long long>(frame->pts));
     
-    return true;
+    return frame;
 }
 
 void VideoEncoder::updateStatistics(double encodingTime, size_t packetSize) {
@@ -3,7 +3,11 @@
 
 #include <string>
 #include <memory>
+#include <chrono>
+#include "PacketPool.h"
 #include "../DataStruct/FrameData.h"
+#include "../Utils/MemoryTracker.h"
+#include "../Utils/ScalerCache.h"
 
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -28,6 +32,8 @@ struct VideoEncoderConfig {
     AVPixelFormat pixelFormat = AV_PIX_FMT_YUV420P;  // 像素格式
     bool enableHardwareAccel = false;   // 硬件加速
     int threadCount = 0;                // 编码线程数
+    int numaNode = -1;                  // 编码线程绑定的NUMA节点（-1表示不绑定）
+    int swsThreads = 1;                 // 色彩转换并行带数（1=单线程，0=按帧尺寸自动；分带有色度接缝）
     int crf = -1;                       // CRF值 (-1=使用码率模式, 0-51=CRF模式, 0=无损)
 };
 
@@ -49,21 +55,41 @@ public:
      */
     bool init(const VideoEncoderConfig& config, AVRational timeBase);
     
+    /**
+     * @brief 编码视频帧，编码包逐个交给sink（不分配，直接送封装器）
+     * @param frameData 输入视频帧
+     * @param sink 编码包回调
+     * @return true 成功，false 失败
+     */
+    bool encode(const FrameData& frameData, const PacketSink& sink);
+    
+    /**
+     * @brief 刷新编码器，剩余编码包逐个交给sink
+     * @param sink 编码包回调
+     * @return true 成功，false 失败
+     */
+    bool flush(const PacketSink& sink);
+    
     /**
      * @brief 编码视频帧
      * @param frameData 输入视频帧
-     * @param packets 输出编码包列表
+     * @param packets 输出编码包列表（取自包池，用完通过releasePackets归还）
      * @return true 成功，false 失败
      */
     bool encode(const FrameData& frameData, std::vector<AVPacket*>& packets);
     
     /**
      * @brief 刷新编码器，输出剩余帧
-     * @param packets 输出编码包列表
+     * @param packets 输出编码包列表（取自包池，用完通过releasePackets归还）
      * @return true 成功，false 失败
      */
     bool flush(std::vector<AVPacket*>& packets);
     
+    /**
+     * @brief 归还encode/flush输出的编码包并清空列表
+     */
+    void releasePackets(std::vector<AVPacket*>& packets) { packetPool_.release(packets); }
+    
     /**
      * @brief 关闭编码器
      */
@@ -90,10 +116,10 @@ private:
     // FFmpeg组件
     const AVCodec* codec_;
     AVCodecContext* codecContext_;
-    AVFrame* frame_;
-    SwsContext* swsContext_;
-    int lastSrcWidth_;
-    int lastSrcHeight_;
+    AVPacket* packet_;                  // 复用的接收包，交给sink后unref
+    PacketPool packetPool_;             // 列表接口输出包的对象池
+    MemoryTracker::TrackedBuffer frameMemory_{MemoryTracker::Source::FFmpeg};  // 输入帧缓冲
+    ScalerCache scaler_;                // 按输入尺寸缓存的SwsContext与输入帧缓冲池
     
     // 配置
     VideoEncoderConfig config_;
@@ -102,16 +128,18 @@ private:
     // 状态
     bool initialized_;
     int64_t frameIndex_;
+    int64_t ptsOffset_ = 0;             // 首帧时间戳换算的PTS起点（保留输入中音视频起始时间的偏移）
     
     // 统计信息
     mutable Statistics stats_;
     
     // 内部方法
     bool setupCodec();
-    bool setupSwsContext(int srcWidth, int srcHeight);
-    AVFrame* convertFrameData(const FrameData& frameData);
+    AVFrame* convertFrameData(const FrameData& frameData);   // 返回的帧由调用方释放
     void updateStatistics(double encodingTime, size_t packetSize);
-    void freePackets(std::vector<AVPacket*>& packets);
+    int drainPackets(const PacketSink& sink, bool flushing,
+                     std::chrono::high_resolution_clock::time_point startTime);
+    PacketSink collectInto(std::vector<AVPacket*>& packets);
     
     // 像素格式转换
     AVPixelFormat getAVPixelFormat(const std::string& format) const;
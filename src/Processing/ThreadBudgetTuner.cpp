@@ -0,0 +1,284 @@
+#include "ThreadBudgetTuner.h"
+#include "../Decoder/include/VideoDecoder.h"
+#include "../Encoder/VideoEncoder.h"
+#include "../SuperEigen/include/SuperResEngine.h"
+#include "../Utils/Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+// 连续两个更大的线程数提升都不到2%时停止测量该阶段，缩短校准时间
+constexpr double kMinGain = 1.02;
+constexpr int kMaxStalls = 2;
+
+// 未设置测量函数的阶段（空profile）不限制帧率
+double rateAt(const ThreadBudgetTuner::StageProfile& profile, int threads) {
+    if (profile.empty()) {
+        return std::numeric_limits<double>::infinity();
+    }
+    auto it = profile.find(threads);
+    return it != profile.end() ? it->second : 0.0;
+}
+
+std::vector<int> keysOf(const ThreadBudgetTuner::StageProfile& profile) {
+    std::vector<int> keys;
+    for (const auto& [threads, fps] : profile) {
+        keys.push_back(threads);
+    }
+    if (keys.empty()) {
+        keys.push_back(1);
+    }
+    return keys;
+}
+double framesPerSecond(int frames, std::chrono::steady_clock::time_point start) {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds > 0.0 ? frames / seconds : 0.0;
+}
+} // namespace
+
+std::string ThreadBudget::toString() const {
+    return "decode=" + std::to_string(decodeThreads) +
+           " sr=" + std::to_string(srSessions) + "x" + std::to_string(srThreadsPerSession) +
+           " encode=" + std::to_string(encodeThreads) +
+           " predicted=" + std::to_string(predictedFps) + "fps";
+}
+
+ThreadBudgetTuner::ThreadBudgetTuner(const ThreadBudgetTunerConfig& config)
+    : config_(config) {
+    if (config_.totalThreads <= 0) {
+        config_.totalThreads = std::max(3u, std::thread::hardware_concurrency());
+    }
+    config_.calibrationFrames = std::max(1, config_.calibrationFrames);
+    config_.maxSrSessions = std::max(1, config_.maxSrSessions);
+}
+
+bool ThreadBudgetTuner::setVideoProbes(const VideoProbeConfig& probeConfig, SessionMap* sessions) {
+    // 采样前N帧作为超分与编码的校准输入
+    auto samples = std::make_shared<std::vector<FrameData>>();
+    {
+        VideoDecoder sampler;
+        if (!sampler.open(probeConfig.inputPath)) {
+            LOG_WARNING("Calibration: cannot open " + probeConfig.inputPath);
+            return false;
+        }
+        FrameData frame;
+        while (samples->size() < static_cast<size_t>(config_.calibrationFrames) && sampler.readNextFrame(frame)) {
+            samples->push_back(frame);
+        }
+    }
+    if (samples->empty()) {
+        LOG_WARNING("Calibration: no frames decoded from " + probeConfig.inputPath);
+        return false;
+    }
+
+    std::string inputPath = probeConfig.inputPath;
+    decodeProbe_ = [inputPath](int threads, int frames) {
+        VideoDecoderConfig config;
+        config.threadCount = threads;
+        VideoDecoder decoder;
+        if (!decoder.initialize(config) || !decoder.open(inputPath)) {
+            return 0.0;
+        }
+
+        FrameData frame;
+        int decoded = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (decoded < frames && decoder.readNextFrame(frame)) {
+            decoded++;
+        }
+        return framesPerSecond(decoded, start);
+    };
+
+    // 超分倍率在建会话后才知道，编码测量按它放大采样帧
+    auto scale = std::make_shared<int>(2);
+    auto ownedSessions = std::make_shared<SessionMap>();
+    SessionMap* engines = sessions ? sessions : ownedSessions.get();
+    superResProbe_ = [probeConfig, samples, scale, ownedSessions, engines](int threads, int frames) {
+        // ORT的intra-op线程数在建会话时固定，每个候选线程数建一次会话（在计时区间外）
+        auto& engine = (*engines)[threads];
+        if (!engine) {
+            SuperEigen::SuperResConfig config;
+            config.numThreads = threads;
+            engine = std::make_shared<SuperEigen::SuperResEngine>();
+            engine->setConfig(config);
+            std::string modelPath = probeConfig.modelPath.empty() ? SuperEigen::SuperResEngine::getDefaultModelPath()
+                                                                  : probeConfig.modelPath;
+            if (!engine->initialize(modelPath, probeConfig.useGpu, probeConfig.gpuId)) {
+                engines->erase(threads);
+                return 0.0;
+            }
+            // 首次推理含内存池分配等一次性开销，不计入吞吐
+            engine->Process((*samples)[0].image);
+        }
+        *scale = engine->getScaleFactor();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i) {
+            engine->Process((*samples)[i % samples->size()].image);
+        }
+        return framesPerSecond(frames, start);
+    };
+
+    encodeProbe_ = [probeConfig, samples, scale](int threads, int frames) {
+        // 编码器输入为超分后尺寸，直接放大采样帧代替真实超分输出
+        std::vector<FrameData> upscaled;
+        for (const auto& sample : *samples) {
+            FrameData frame = sample;
+            cv::resize(sample.image, frame.image, cv::Size(sample.image.cols * *scale, sample.image.rows * *scale));
+            frame.width = frame.image.cols;
+            frame.height = frame.image.rows;
+            upscaled.push_back(frame);
+        }
+
+        VideoEncoderConfig config;
+        config.width = upscaled[0].width;
+        config.height = upscaled[0].height;
+        config.preset = probeConfig.encoderPreset;
+        config.crf = probeConfig.encoderCRF;
+        config.threadCount = threads;
+        VideoEncoder encoder;
+        if (!encoder.init(config, AVRational{1, 30})) {
+            return 0.0;
+        }
+
+        // 只测编码吞吐，编码包直接丢弃
+        auto discard = [](AVPacket*) { return true; };
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; ++i) {
+            encoder.encode(upscaled[i % upscaled.size()], discard);
+        }
+        encoder.flush(discard);
+        return framesPerSecond(frames, start);
+    };
+    return true;
+}
+
+ThreadBudget ThreadBudgetTuner::tune() {
+    // 其余两个阶段至少各保留一个线程
+    std::vector<int> threadCounts = candidates(config_.totalThreads - 2);
+
+    LOG_INFO("Thread budget calibration: " + std::to_string(config_.totalThreads) + " threads, " +
+             std::to_string(config_.calibrationFrames) + " frames per probe");
+
+    decodeProfile_ = measure("decode", decodeProbe_, threadCounts);
+    superResProfile_ = measure("superres", superResProbe_, threadCounts);
+    encodeProfile_ = measure("encode", encodeProbe_, threadCounts);
+
+    // 设置了测量函数但所有线程数都测量失败：该阶段不可用，不能当作不限速
+    const std::pair<const char*, bool> failures[] = {
+        {"decode", decodeProbe_ && decodeProfile_.empty()},
+        {"superres", superResProbe_ && superResProfile_.empty()},
+        {"encode", encodeProbe_ && encodeProfile_.empty()},
+    };
+    for (const auto& [stage, failed] : failures) {
+        if (failed) {
+            LOG_WARNING(std::string("Thread budget calibration failed: no successful ") + stage + " probe");
+            return ThreadBudget();
+        }
+    }
+
+    ThreadBudget budget = search(decodeProfile_, superResProfile_, encodeProfile_,
+                                 config_.totalThreads, config_.maxSrSessions);
+    LOG_INFO("Thread budget selected: " + budget.toString());
+    return budget;
+}
+
+ThreadBudget ThreadBudgetTuner::search(const StageProfile& decode, const StageProfile& superRes,
+                                       const StageProfile& encode, int totalThreads, int maxSessions) {
+    ThreadBudget best;
+    // 超分是必需阶段，没有测量结果时无从分配
+    if (superRes.empty()) {
+        return best;
+    }
+    double bestFps = -1.0;
+    int bestThreads = std::numeric_limits<int>::max();
+
+    for (int d : keysOf(decode)) {
+        for (int s : keysOf(superRes)) {
+            for (int k = 1; k <= std::max(1, maxSessions); ++k) {
+                for (int e : keysOf(encode)) {
+                    int used = d + s * k + e;
+                    if (used > totalThreads) {
+                        continue;
+                    }
+
+                    double fps = std::min({rateAt(decode, d), rateAt(superRes, s) * k, rateAt(encode, e)});
+                    // 帧率相同时选线程更少的方案，把余量留给系统
+                    if (fps > bestFps || (fps == bestFps && used < bestThreads)) {
+                        bestFps = fps;
+                        bestThreads = used;
+                        best.decodeThreads = d;
+                        best.srThreadsPerSession = s;
+                        best.srSessions = k;
+                        best.encodeThreads = e;
+                    }
+                }
+            }
+        }
+    }
+
+    best.predictedFps = std::isinf(bestFps) || bestFps < 0.0 ? 0.0 : bestFps;
+    return best;
+}
+
+std::vector<int> ThreadBudgetTuner::candidates(int maxThreads) const {
+    std::vector<int> result;
+    if (!config_.candidateThreads.empty()) {
+        for (int threads : config_.candidateThreads) {
+            if (threads >= 1 && threads <= maxThreads) {
+                result.push_back(threads);
+            }
+        }
+    } else {
+        // 1,2,3,4,6,8,12,16,24,32...：小线程数密集采样，大线程数按1.5/2倍递增
+        for (int base = 1; base <= maxThreads; base *= 2) {
+            result.push_back(base);
+            int mid = base + base / 2;
+            if (base >= 2 && mid <= maxThreads) {
+                result.push_back(mid);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    if (result.empty()) {
+        result.push_back(1);
+    }
+    return result;
+}
+
+ThreadBudgetTuner::StageProfile ThreadBudgetTuner::measure(const std::string& stage, const StageProbe& probe,
+                                                           const std::vector<int>& threadCounts) const {
+    StageProfile profile;
+    if (!probe) {
+        return profile;
+    }
+
+    double best = 0.0;
+    int stalls = 0;
+    for (int threads : threadCounts) {
+        double fps = probe(threads, config_.calibrationFrames);
+        if (fps <= 0.0) {
+            LOG_WARNING("Calibration probe failed: " + stage + " @ " + std::to_string(threads) + " threads");
+            continue;
+        }
+
+        profile[threads] = fps;
+        LOG_DEBUG("Calibration " + stage + " @ " + std::to_string(threads) + " threads: " +
+                  std::to_string(fps) + " fps");
+
+        if (fps < best * kMinGain) {
+            if (++stalls >= kMaxStalls) {
+                break;
+            }
+        } else {
+            stalls = 0;
+        }
+        best = std::max(best, fps);
+    }
+    return profile;
+}
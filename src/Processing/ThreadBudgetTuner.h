@@ -0,0 +1,125 @@
+#ifndef THREAD_BUDGET_TUNER_H
+#define THREAD_BUDGET_TUNER_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace SuperEigen {
+class SuperResEngine;
+}
+
+/**
+ * @brief 线程预算分配结果
+ */
+struct ThreadBudget {
+    int decodeThreads = 1;          // 解码线程数
+    int srThreadsPerSession = 1;    // 每个超分会话的ORT线程数
+    int srSessions = 1;             // 超分会话数
+    int encodeThreads = 1;          // 编码线程数
+    double predictedFps = 0.0;      // 预测的端到端帧率
+
+    int totalThreads() const { return decodeThreads + srThreadsPerSession * srSessions + encodeThreads; }
+    std::string toString() const;
+};
+
+/**
+ * @brief 调优配置
+ */
+struct ThreadBudgetTunerConfig {
+    int totalThreads = 0;               // 线程总预算（0表示使用硬件线程数）
+    int calibrationFrames = 8;          // 每个候选线程数测量的帧数
+    int maxSrSessions = 4;              // 最多超分会话数
+    std::vector<int> candidateThreads;  // 候选线程数（空则使用1,2,3,4,6,8,12,16...直到预算）
+};
+
+/**
+ * @brief 用视频文件校准时的测量参数
+ */
+struct VideoProbeConfig {
+    std::string inputPath;                  // 校准用的输入视频
+    std::string modelPath;                  // 超分模型（空则用默认模型）
+    bool useGpu = false;                    // 超分是否用GPU
+    int gpuId = 0;
+    std::string encoderPreset = "ultrafast";  // 编码测量使用的预设
+    int encoderCRF = 18;
+};
+
+/**
+ * @brief 解码/超分/编码线程预算自动调优
+ *
+ * 在作业开始时用前N帧分别测量各阶段在不同线程数下的吞吐，
+ * 按流水线模型（端到端帧率 = 各阶段帧率的最小值，超分帧率随会话数线性叠加）
+ * 在线程总预算内搜索使端到端帧率最大的线程分配
+ */
+class ThreadBudgetTuner {
+public:
+    /**
+     * @brief 阶段测量函数
+     * 以指定线程数处理frames帧，返回该阶段单实例的吞吐（帧/秒），失败返回0
+     */
+    using StageProbe = std::function<double(int threads, int frames)>;
+
+    /**
+     * @brief 各线程数下测得的阶段吞吐
+     */
+    using StageProfile = std::map<int, double>;
+
+    explicit ThreadBudgetTuner(const ThreadBudgetTunerConfig& config = ThreadBudgetTunerConfig());
+
+    void setDecodeProbe(StageProbe probe) { decodeProbe_ = std::move(probe); }
+    void setSuperResProbe(StageProbe probe) { superResProbe_ = std::move(probe); }
+    void setEncodeProbe(StageProbe probe) { encodeProbe_ = std::move(probe); }
+
+    /**
+     * @brief 超分校准会话，按ORT线程数索引
+     */
+    using SessionMap = std::map<int, std::shared_ptr<SuperEigen::SuperResEngine>>;
+
+    /**
+     * @brief 用视频文件设置三个阶段的测量函数：解码该文件、对前几帧超分、编码超分尺寸的帧
+     * @param sessions 非空时保存各线程数建的超分会话（已预热），调用方可直接复用选中的那个
+     * @return 无法打开文件或读不到帧时返回false
+     */
+    bool setVideoProbes(const VideoProbeConfig& probeConfig, SessionMap* sessions = nullptr);
+
+    /**
+     * @brief 执行校准并搜索最优分配
+     * @return 线程分配；未设置的阶段按1线程计且不参与瓶颈计算。
+     *         已设置的阶段全部测量失败时返回默认分配（predictedFps为0）
+     */
+    ThreadBudget tune();
+
+    /**
+     * @brief 在已测得的阶段吞吐上搜索最优分配
+     * @param decode 解码吞吐（为空表示不限制）
+     * @param superRes 单会话超分吞吐（为空时返回默认分配，predictedFps为0）
+     * @param encode 编码吞吐（为空表示不限制）
+     * @param totalThreads 线程总预算
+     * @param maxSessions 最多超分会话数
+     */
+    static ThreadBudget search(const StageProfile& decode, const StageProfile& superRes,
+                               const StageProfile& encode, int totalThreads, int maxSessions);
+
+    const StageProfile& decodeProfile() const { return decodeProfile_; }
+    const StageProfile& superResProfile() const { return superResProfile_; }
+    const StageProfile& encodeProfile() const { return encodeProfile_; }
+
+private:
+    ThreadBudgetTunerConfig config_;
+    StageProbe decodeProbe_;
+    StageProbe superResProbe_;
+    StageProbe encodeProbe_;
+
+    StageProfile decodeProfile_;
+    StageProfile superResProfile_;
+    StageProfile encodeProfile_;
+
+    std::vector<int> candidates(int totalThreads) const;
+    StageProfile measure(const std::string& stage, const StageProbe& probe,
+                         const std::vector<int>& threadCounts) const;
+};
+
+#endif // THREAD_BUDGET_TUNER_H
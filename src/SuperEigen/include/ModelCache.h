@@ -0,0 +1,87 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "SuperResConfig.h"
+
+namespace SuperEigen {
+
+/**
+ * @brief 优化模型缓存
+ * 将ORT图优化后的模型以ORT格式写入缓存目录，
+ * 以模型内容哈希、ORT版本、CPU型号和会话选项作为键，后续启动直接加载，跳过图优化
+ */
+class ModelCache {
+public:
+    explicit ModelCache(const std::string& cacheDir);
+
+    /**
+     * @brief 是否启用缓存（缓存目录非空）
+     */
+    bool isEnabled() const { return !cacheDir_.empty(); }
+
+    /**
+     * @brief 计算模型对应的缓存文件路径
+     * @param modelPath 原始ONNX模型路径
+     * @param config 会话配置（参与缓存键计算）
+     * @return 缓存文件路径，失败返回空字符串
+     */
+    std::string cachePathFor(const std::string& modelPath, const SuperResConfig& config) const;
+
+    /**
+     * @brief 生成写入中的临时文件路径（同目录，提交时原子重命名；每次调用都不同）
+     */
+    static std::string temporaryPathFor(const std::string& cachePath);
+
+    /**
+     * @brief 将临时文件提交为正式缓存文件
+     * @return 是否成功
+     */
+    static bool commit(const std::string& tempPath, const std::string& cachePath);
+
+    /**
+     * @brief 计算文件内容哈希（FNV-1a 64位）
+     * @return 哈希值，读取失败返回0
+     */
+    static uint64_t hashFile(const std::string& path);
+
+private:
+    std::string cacheDir_;
+
+    static std::string cpuModelName();
+    static std::string toHex(uint64_t value);
+};
+
+/**
+ * @brief 只读映射的模型文件
+ * 以MAP_SHARED映射缓存文件，同一主机上的多个进程共享页缓存中的同一份权重
+ */
+class MappedModelFile {
+public:
+    MappedModelFile() = default;
+    ~MappedModelFile();
+
+    MappedModelFile(const MappedModelFile&) = delete;
+    MappedModelFile& operator=(const MappedModelFile&) = delete;
+
+    /**
+     * @brief 映射文件
+     * @param path 文件路径
+     * @return 是否成功
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief 解除映射
+     */
+    void close();
+
+    const void* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+} // namespace SuperEigen
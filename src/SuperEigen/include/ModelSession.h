@@ -5,6 +5,8 @@
 #include <vector>
 #include <mutex>
 #include "SuperResConfig.h"
+#include "ModelCache.h"
+#include "../../Utils/MemoryTracker.h"
 
 namespace SuperEigen {
 
@@ -76,9 +78,14 @@ private:
     // ONNX Runtime 组件
     Ort::Env env_;
     Ort::SessionOptions sessionOptions_;
+    std::unique_ptr<MappedModelFile> mappedModel_;  // 共享权重模式下的模型映射，须比session_后析构
     std::unique_ptr<Ort::Session> session_;
     Ort::MemoryInfo memoryInfo_;
     Ort::AllocatorWithDefaultOptions allocator_;
+    // ORT 1.15没有arena统计接口：会话创建时与首次推理（arena增长到工作尺寸）时
+    // 各采样一次RSS增长，近似其内存占用（只作报告，不计入内存上限）；之后的推理不再读取RSS
+    MemoryTracker::TrackedBuffer ortMemory_{MemoryTracker::Source::Ort};
+    bool ortMemorySampled_ = false;
 
     // 模型元数据
     std::vector<std::string> inputNames_;
@@ -95,6 +102,9 @@ private:
 
     // 私有方法
     void configureSession();
+    void createSession(const std::string& modelPath);
+    void buildCachedModel(const std::string& modelPath, const std::string& cachePath);
+    bool loadCachedModel(const std::string& cachePath);
     void configureCPU();
     void configureGPU();
     void extractModelMetadata();
@@ -20,7 +20,7 @@ public:
      * @brief 预处理：将cv::Mat转换为ONNX张量
      * @param input BGR格式的输入图像
      * @param memoryInfo ONNX内存信息对象
-     * @return ONNX张量
+     * @return ONNX张量（引用内部缓冲区，下次调用preprocess前有效）
      */
     Ort::Value preprocess(const cv::Mat& input, const Ort::MemoryInfo& memoryInfo);
 
@@ -41,17 +41,7 @@ public:
 private:
     const SuperResConfig& config_;
     
-    // 内部辅助方法
-    cv::Mat bgrToRgb(const cv::Mat& bgr);
-    cv::Mat rgbToBgr(const cv::Mat& rgb);
-    std::vector<float> normalize(const cv::Mat& image);
-    cv::Mat denormalize(const std::vector<float>& tensor, int width, int height);
-    
-    // 数据布局转换 (HWC <-> CHW)
-    std::vector<float> hwcToChw(const cv::Mat& image);
-    cv::Mat chwToHwc(const std::vector<float>& tensor, int channels, int height, int width);
-    
-    // 缓冲区管理
+    // 缓冲区管理（转换内核见TensorKernels.h）
     mutable std::vector<float> preprocessBuffer_;
     mutable std::vector<float> postprocessBuffer_;
 };
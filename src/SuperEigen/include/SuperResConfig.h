@@ -25,8 +25,19 @@ struct SuperResConfig {
 
     // 性能相关配置
     int numThreads = 4;             // CPU线程数
+
+    // NUMA放置策略：会话线程与权重、帧缓冲绑定到同一节点
+    enum NumaPolicy {
+        NUMA_NONE = 0,         // 不绑定
+        NUMA_FIXED = 1,        // 绑定到numaNode
+        NUMA_ROUND_ROBIN = 2   // 各引擎实例轮流分配到各节点
+    };
+    NumaPolicy numaPolicy = NUMA_NONE;
+    int numaNode = 0;               // NUMA_FIXED时绑定的节点
     bool enableOptimization = true;  // 是否启用优化
     bool enableMemoryPattern = true; // 是否启用内存模式优化
+    std::string modelCacheDir;       // 优化模型缓存目录（空表示不缓存）
+    bool sharedWeights = false;      // 从缓存文件mmap加载权重，多进程共享同一份物理内存（需设置modelCacheDir）
 
     // 处理相关配置
     float inputMean = 0.0f;         // 输入归一化均值
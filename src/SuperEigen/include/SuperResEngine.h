@@ -83,11 +83,35 @@ public:
         std::string modelPath;
         int scaleFactor;
         bool useGPU;
+        int numaNode;           // 绑定的NUMA节点（-1表示未绑定）
     };
     ProcessingStats getStats() const;
 
+    /**
+     * @brief 按NUMA节点汇总的处理统计（进程内所有引擎实例）
+     */
+    struct NodeStats {
+        int numaNode;           // NUMA节点（-1表示未绑定的引擎）
+        size_t totalFrames;
+        double busyTimeMs;      // 各引擎处理耗时之和
+        double framesPerSecond; // 节点吞吐：总帧数 / 首帧开始到末帧结束的墙钟时间
+    };
+    static std::vector<NodeStats> getNodeStats();
+
     // ========== 动态配置 ==========
     
+    /**
+     * @brief 设置引擎配置（在initialize前调用）
+     * 模型路径、设备和倍率仍由initialize决定，其余选项（线程数、缓存目录等）取自此配置
+     * @param config 配置
+     */
+    void setConfig(const SuperResConfig& config) { config_ = config; }
+
+    /**
+     * @brief 获取当前配置
+     */
+    const SuperResConfig& getConfig() const { return config_; }
+
     /**
      * @brief 切换模型
      * @param modelPath 新模型路径
@@ -129,6 +153,7 @@ public:
 private:
     SuperResConfig config_;
     bool initialized_;
+    int numaNode_;              // 按放置策略解析出的节点，-1表示不绑定
     
     // 核心组件
     std::unique_ptr<ModelSession> session_;
@@ -145,8 +170,10 @@ private:
     
     // 私有方法
     void updateFrameMetadata(FrameData& frame);
-    void collectStats(double timeMs);
+    void collectStats(double timeMs, size_t frames = 1);
+    int resolveNumaNode() const;
     cv::Mat processImageInternal(const cv::Mat& image);
+    cv::Mat runModel(const cv::Mat& image);
 };
 
 } // namespace SuperEigen 
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <vector>
+
+namespace SuperEigen {
+
+/**
+ * @brief 预处理/后处理中的像素与张量转换内核
+ * 从PrePostProcessor中拆出的无状态函数，便于单独做微基准测试
+ */
+namespace TensorKernels {
+
+/**
+ * @brief BGR <-> RGB 通道交换（8位或浮点均可）
+ */
+cv::Mat bgrToRgb(const cv::Mat& bgr);
+cv::Mat rgbToBgr(const cv::Mat& rgb);
+
+/**
+ * @brief HWC -> CHW，8位输入同时缩放到[0,1]
+ * @param image 3通道图像（CV_8UC3 或 CV_32FC3）
+ * @param chw 输出缓冲区，按需调整大小（复用调用方的缓冲区避免每帧分配）
+ */
+void hwcToChw(const cv::Mat& image, std::vector<float>& chw);
+
+/**
+ * @brief CHW -> HWC
+ * @return CV_32FC(channels) 图像
+ */
+cv::Mat chwToHwc(const float* tensor, int channels, int height, int width);
+
+/**
+ * @brief 按均值/标准差归一化：(x - mean) / std
+ */
+void normalize(float* data, size_t count, float mean, float std);
+
+/**
+ * @brief 归一化的逆运算：x * std + mean
+ */
+void denormalize(float* data, size_t count, float mean, float std);
+
+/**
+ * @brief 超出[0,1]时按实际最小/最大值线性拉伸到[0,1]，再截断到[0,1]
+ */
+void rescaleToUnitRange(float* data, size_t count);
+
+} // namespace TensorKernels
+
+} // namespace SuperEigen
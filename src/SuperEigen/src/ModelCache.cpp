@@ -0,0 +1,167 @@
+#include "../include/ModelCache.h"
+#include "../../Utils/Logger.h"
+#include <onnxruntime_cxx_api.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace SuperEigen {
+
+namespace {
+constexpr uint64_t kFnvOffset = 1469598103934665603ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t fnv1a(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+} // namespace
+
+ModelCache::ModelCache(const std::string& cacheDir)
+    : cacheDir_(cacheDir) {
+}
+
+std::string ModelCache::cachePathFor(const std::string& modelPath, const SuperResConfig& config) const {
+    if (!isEnabled()) {
+        return "";
+    }
+
+    uint64_t modelHash = hashFile(modelPath);
+    if (modelHash == 0) {
+        LOG_WARNING("Cannot hash model for cache: " + modelPath);
+        return "";
+    }
+
+    // 缓存键：模型内容 + ORT版本 + CPU型号（ORT_ENABLE_ALL的布局优化与指令集相关）+ 影响图结构的选项
+    std::string key = toHex(modelHash);
+    key += "|ort=" + Ort::GetVersionString();
+    key += "|cpu=" + cpuModelName();
+    key += "|opt=" + std::to_string(config.enableOptimization ? 99 : 0);
+    key += "|dev=" + std::to_string(config.isGPU() ? 1 : 0);
+    key += "|fp16=" + std::to_string(config.fp16Mode ? 1 : 0);
+
+    std::error_code ec;
+    std::filesystem::create_directories(cacheDir_, ec);
+    if (ec) {
+        LOG_WARNING("Cannot create model cache directory: " + cacheDir_ + " (" + ec.message() + ")");
+        return "";
+    }
+
+    std::string stem = std::filesystem::path(modelPath).stem().string();
+    std::string filename = stem + "." + toHex(fnv1a(kFnvOffset, key.data(), key.size())) + ".ort";
+    return (std::filesystem::path(cacheDir_) / filename).string();
+}
+
+std::string ModelCache::temporaryPathFor(const std::string& cachePath) {
+    // 进程号+线程号+序号：同一进程内多个会话同时冷启动也各写各的临时文件
+    static std::atomic<uint64_t> sequence{0};
+    return cachePath + ".tmp." + std::to_string(::getpid()) + "_" +
+           std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + "_" +
+           std::to_string(sequence.fetch_add(1, std::memory_order_relaxed));
+}
+
+bool ModelCache::commit(const std::string& tempPath, const std::string& cachePath) {
+    std::error_code ec;
+    if (!std::filesystem::exists(tempPath, ec)) {
+        LOG_WARNING("Optimized model was not written: " + tempPath);
+        return false;
+    }
+
+    // 同目录rename是原子的，多个worker同时冷启动时后写者覆盖，读者不会看到半个文件
+    std::filesystem::rename(tempPath, cachePath, ec);
+    if (ec) {
+        LOG_WARNING("Failed to commit optimized model cache: " + ec.message());
+        std::filesystem::remove(tempPath, ec);
+        return false;
+    }
+    return true;
+}
+
+uint64_t ModelCache::hashFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    uint64_t hash = kFnvOffset;
+    std::vector<char> buffer(1 << 20);
+    while (file) {
+        file.read(buffer.data(), buffer.size());
+        hash = fnv1a(hash, buffer.data(), static_cast<size_t>(file.gcount()));
+    }
+    return hash;
+}
+
+std::string ModelCache::cpuModelName() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t pos = line.find(':');
+            return pos != std::string::npos ? line.substr(pos + 1) : line;
+        }
+    }
+    return "unknown";
+}
+
+std::string ModelCache::toHex(uint64_t value) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        hex[i] = digits[value & 0xF];
+        value >>= 4;
+    }
+    return hex;
+}
+
+MappedModelFile::~MappedModelFile() {
+    close();
+}
+
+bool MappedModelFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_ERROR("Cannot open model file for mapping: " + path);
+        return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        LOG_ERROR("Cannot stat model file for mapping: " + path);
+        ::close(fd);
+        return false;
+    }
+
+    // 只读共享映射：权重页由内核页缓存提供，不计入各进程的私有内存
+    void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        LOG_ERROR("Failed to mmap model file: " + path);
+        return false;
+    }
+
+    data_ = addr;
+    size_ = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedModelFile::close() {
+    if (data_) {
+        ::munmap(data_, size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+}
+
+} // namespace SuperEigen
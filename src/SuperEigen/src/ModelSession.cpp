@@ -1,11 +1,32 @@
 #include "../include/ModelSession.h"
 #include "../../Utils/Logger.h"
+#include "../../Utils/MemoryTracker.h"
+#include "../../Utils/Trace.h"
+#include <onnxruntime_session_options_config_keys.h>
+#include <filesystem>
 #include <iostream>
 #include <sstream>
 #include <algorithm>
 
 namespace SuperEigen {
 
+namespace {
+std::basic_string<ORTCHAR_T> toOrtPath(const std::string& path) {
+    return std::basic_string<ORTCHAR_T>(path.begin(), path.end());
+}
+
+// 进程级预打包权重容器，同一进程内的多个会话复用预打包结果
+// 有意不释放，避免与静态对象析构顺序冲突
+OrtPrepackedWeightsContainer* sharedPrepackedWeights() {
+    static OrtPrepackedWeightsContainer* container = [] {
+        OrtPrepackedWeightsContainer* created = nullptr;
+        Ort::ThrowOnError(Ort::GetApi().CreatePrepackedWeightsContainer(&created));
+        return created;
+    }();
+    return container;
+}
+} // namespace
+
 ModelSession::ModelSession(const SuperResConfig& config)
     : config_(config)
     , initialized_(false)
@@ -19,14 +40,12 @@ ModelSession::~ModelSession() {
 }
 
 bool ModelSession::initialize(const std::string& modelPath) {
+    MEMORY_STAGE_SCOPE("model_load");
+    const bool trackMemory = MemoryTracker::getInstance().isEnabled();
+    const size_t rssBefore = trackMemory ? MemoryTracker::currentRssBytes() : 0;
     try {
-        // 加载模型
-        #ifdef _WIN32
-            std::wstring widestr = std::wstring(modelPath.begin(), modelPath.end());
-            session_ = std::make_unique<Ort::Session>(env_, widestr.c_str(), sessionOptions_);
-        #else
-            session_ = std::make_unique<Ort::Session>(env_, modelPath.c_str(), sessionOptions_);
-        #endif
+        // 加载模型（命中缓存时直接加载已优化的ORT格式模型）
+        createSession(modelPath);
         
         // 提取模型元数据
         extractModelMetadata();
@@ -36,6 +55,11 @@ bool ModelSession::initialize(const std::string& modelPath) {
             warmUp();
         }
         
+        if (trackMemory) {
+            size_t rssAfter = MemoryTracker::currentRssBytes();
+            ortMemory_.update(rssAfter > rssBefore ? rssAfter - rssBefore : 0);
+        }
+        
         initialized_ = true;
         LOG_INFO("Model loaded successfully from: " + modelPath);
         LOG_INFO("Using provider: " + getProviderName());
@@ -49,11 +73,15 @@ bool ModelSession::initialize(const std::string& modelPath) {
 }
 
 Ort::Value ModelSession::inference(const Ort::Value& inputTensor) {
+    TRACE_SCOPE("ModelSession::inference", "sr");
     if (!initialized_) {
         throw std::runtime_error("Model session not initialized");
     }
     
     std::lock_guard<std::mutex> lock(sessionMutex_);
+    // 只在首次推理采样：arena此后基本不再增长，逐次取RSS差值还会把其他线程的分配算进来
+    const bool sampleMemory = !ortMemorySampled_ && MemoryTracker::getInstance().isEnabled();
+    const size_t rssBefore = sampleMemory ? MemoryTracker::currentRssBytes() : 0;
     
     try {
         // 准备输入
@@ -70,6 +98,14 @@ Ort::Value ModelSession::inference(const Ort::Value& inputTensor) {
             outputNodeNames_.size()
         );
         
+        if (sampleMemory) {
+            size_t rssAfter = MemoryTracker::currentRssBytes();
+            if (rssAfter > rssBefore) {
+                ortMemory_.update(ortMemory_.bytes() + (rssAfter - rssBefore));
+            }
+            ortMemorySampled_ = true;
+        }
+        
         return std::move(outputTensors[0]);
     } catch (const Ort::Exception& e) {
         throw std::runtime_error("Inference failed: " + std::string(e.what()));
@@ -139,6 +175,89 @@ void ModelSession::configureSession() {
     }
 }
 
+void ModelSession::createSession(const std::string& modelPath) {
+    ModelCache cache(config_.modelCacheDir);
+    std::string cachePath;
+    if (cache.isEnabled() && config_.enableOptimization) {
+        cachePath = cache.cachePathFor(modelPath, config_);
+    }
+
+    if (cachePath.empty()) {
+        if (config_.sharedWeights) {
+            LOG_WARNING("Shared weights require an optimized model cache, loading private copy");
+        }
+        session_ = std::make_unique<Ort::Session>(env_, toOrtPath(modelPath).c_str(), sessionOptions_);
+        return;
+    }
+
+    // 未命中：正常优化并序列化；共享权重模式下随后改为从映射的缓存文件重新加载
+    bool built = false;
+    if (!std::filesystem::exists(cachePath)) {
+        buildCachedModel(modelPath, cachePath);
+        built = true;
+        if (!config_.sharedWeights) {
+            return;
+        }
+    }
+
+    if (loadCachedModel(cachePath)) {
+        return;
+    }
+
+    std::error_code ec;
+    std::filesystem::remove(cachePath, ec);
+    if (!built) {
+        buildCachedModel(modelPath, cachePath);
+    }
+}
+
+void ModelSession::buildCachedModel(const std::string& modelPath, const std::string& cachePath) {
+    std::string tempPath = ModelCache::temporaryPathFor(cachePath);
+    Ort::SessionOptions saveOptions = sessionOptions_.Clone();
+    saveOptions.SetOptimizedModelFilePath(toOrtPath(tempPath).c_str());
+    saveOptions.AddConfigEntry(kOrtSessionOptionsConfigSaveModelFormat, "ORT");
+    session_ = std::make_unique<Ort::Session>(env_, toOrtPath(modelPath).c_str(), saveOptions);
+
+    if (ModelCache::commit(tempPath, cachePath)) {
+        LOG_INFO("Optimized model cached: " + cachePath);
+    }
+}
+
+bool ModelSession::loadCachedModel(const std::string& cachePath) {
+    // 缓存模型已完成图优化，关闭优化直接加载
+    Ort::SessionOptions cachedOptions = sessionOptions_.Clone();
+    cachedOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+    cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigLoadModelFormat, "ORT");
+
+    try {
+        if (!config_.sharedWeights) {
+            session_ = std::make_unique<Ort::Session>(env_, toOrtPath(cachePath).c_str(), cachedOptions);
+            LOG_INFO("Loaded optimized model from cache: " + cachePath);
+            return true;
+        }
+
+        auto mapped = std::make_unique<MappedModelFile>();
+        if (!mapped->open(cachePath)) {
+            return false;
+        }
+
+        // 初始化器直接引用映射内存而不拷贝；预打包权重在进程内各会话间共享
+        cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesDirectly, "1");
+        cachedOptions.AddConfigEntry(kOrtSessionOptionsConfigUseORTModelBytesForInitializers, "1");
+        auto session = std::make_unique<Ort::Session>(env_, mapped->data(), mapped->size(),
+                                                      cachedOptions, sharedPrepackedWeights());
+
+        // 先替换会话再替换映射，保证旧会话析构时其引用的映射仍然有效
+        session_ = std::move(session);
+        mappedModel_ = std::move(mapped);
+        LOG_INFO("Mapped shared model weights from cache: " + cachePath);
+        return true;
+    } catch (const Ort::Exception& e) {
+        LOG_WARNING("Optimized model cache unusable, rebuilding: " + std::string(e.what()));
+        return false;
+    }
+}
+
 void ModelSession::configureCPU() {
     // CPU配置已经在基本设置中完成
     LOG_DEBUG("Configured for CPU execution with " + std::to_string(config_.numThreads) + " threads");
@@ -1,13 +1,41 @@
 #include "../include/SuperResEngine.h"
 #include "../../Utils/Logger.h"
+#include "../../Utils/CpuTopology.h"
+#include "../../Utils/MemoryTracker.h"
+#include "../../Utils/Metrics.h"
+#include "../../Utils/Trace.h"
+#include <atomic>
 #include <chrono>
+#include <cstdlib>
 #include <iostream>
 #include <filesystem>
+#include <map>
 
 namespace SuperEigen {
 
+namespace {
+// 进程级按节点统计，供多引擎部署观察各NUMA节点的吞吐
+struct NodeAccumulator {
+    size_t frames = 0;
+    double busyTimeMs = 0.0;
+    std::chrono::steady_clock::time_point firstStart;
+    std::chrono::steady_clock::time_point lastEnd;
+};
+
+std::mutex& nodeStatsMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::map<int, NodeAccumulator>& nodeStatsRegistry() {
+    static std::map<int, NodeAccumulator> registry;
+    return registry;
+}
+} // namespace
+
 SuperResEngine::SuperResEngine()
     : initialized_(false)
+    , numaNode_(-1)
     , processedFrames_(0)
     , totalProcessTime_(0.0)
     , lastProcessTime_(0.0) {
@@ -37,6 +65,16 @@ bool SuperResEngine::initialize(const std::string& modelPath, bool useGPU, int g
         config_.device = useGPU ? SuperResConfig::GPU : SuperResConfig::CPU;
         config_.deviceId = gpuId;
         
+        // 未显式配置缓存目录时，允许通过环境变量统一开启优化模型缓存
+        if (config_.modelCacheDir.empty()) {
+            if (const char* cacheDir = std::getenv("VIDEOSR_MODEL_CACHE_DIR")) {
+                config_.modelCacheDir = cacheDir;
+            }
+        }
+        if (const char* shared = std::getenv("VIDEOSR_SHARED_WEIGHTS")) {
+            config_.sharedWeights = config_.sharedWeights || std::string(shared) == "1";
+        }
+        
         // 从模型名推断倍率
         std::string filename = std::filesystem::path(actualModelPath).filename().string();
         if (filename.find("x4") != std::string::npos) {
@@ -45,6 +83,13 @@ bool SuperResEngine::initialize(const std::string& modelPath, bool useGPU, int g
             config_.scaleFactor = 2;
         }
         
+        // 在目标节点上创建会话：ORT线程池继承亲和性，权重与预打包缓冲分配在本节点
+        numaNode_ = resolveNumaNode();
+        ScopedNumaBinding numaBinding(numaNode_);
+        if (numaBinding.isActive()) {
+            LOG_INFO("SuperResEngine bound to NUMA node " + std::to_string(numaNode_));
+        }
+        
         // 创建会话
         session_ = std::make_unique<ModelSession>(config_);
         if (!session_->initialize(actualModelPath)) {
@@ -76,8 +121,15 @@ cv::Mat SuperResEngine::Process(const cv::Mat& input_bgr) {
         return input_bgr.clone();
     }
     
+    auto startTime = std::chrono::high_resolution_clock::now();
+    
     try {
-        return processImageInternal(input_bgr);
+        cv::Mat output = processImageInternal(input_bgr);
+        
+        auto endTime = std::chrono::high_resolution_clock::now();
+        collectStats(std::chrono::duration<double, std::milli>(endTime - startTime).count());
+        
+        return output;
     } catch (const std::exception& e) {
         LOG_ERROR("Processing error: " + std::string(e.what()));
         return input_bgr.clone();
@@ -147,7 +199,7 @@ std::vector<FrameData> SuperResEngine::processBatch(const std::vector<FrameData>
         // 统计
         auto endTime = std::chrono::high_resolution_clock::now();
         double timeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
-        collectStats(timeMs);
+        collectStats(timeMs, inputs.size());
         
         return outputs;
         
@@ -167,10 +219,27 @@ SuperResEngine::ProcessingStats SuperResEngine::getStats() const {
     stats.modelPath = config_.modelPath;
     stats.scaleFactor = config_.scaleFactor;
     stats.useGPU = config_.device == SuperResConfig::GPU;
+    stats.numaNode = numaNode_;
     
     return stats;
 }
 
+std::vector<SuperResEngine::NodeStats> SuperResEngine::getNodeStats() {
+    std::lock_guard<std::mutex> lock(nodeStatsMutex());
+    
+    std::vector<NodeStats> result;
+    for (const auto& [node, acc] : nodeStatsRegistry()) {
+        NodeStats stats;
+        stats.numaNode = node;
+        stats.totalFrames = acc.frames;
+        stats.busyTimeMs = acc.busyTimeMs;
+        double wallSeconds = std::chrono::duration<double>(acc.lastEnd - acc.firstStart).count();
+        stats.framesPerSecond = wallSeconds > 0.0 ? acc.frames / wallSeconds : 0.0;
+        result.push_back(stats);
+    }
+    return result;
+}
+
 bool SuperResEngine::switchModel(const std::string& modelPath) {
     if (!std::filesystem::exists(modelPath)) {
         LOG_ERROR("Model file not found: " + modelPath);
@@ -288,14 +357,63 @@ void SuperResEngine::updateFrameMetadata(FrameData& frame) {
     }
 }
 
-void SuperResEngine::collectStats(double timeMs) {
-    std::lock_guard<std::mutex> lock(statsMutex_);
-    processedFrames_++;
-    totalProcessTime_ += timeMs;
-    lastProcessTime_ = timeMs;
+void SuperResEngine::collectStats(double timeMs, size_t frames) {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex_);
+        processedFrames_ += frames;
+        totalProcessTime_ += timeMs;
+        lastProcessTime_ = timeMs;
+    }
+    
+    auto end = std::chrono::steady_clock::now();
+    auto start = end - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double, std::milli>(timeMs));
+    
+    std::lock_guard<std::mutex> lock(nodeStatsMutex());
+    NodeAccumulator& acc = nodeStatsRegistry()[numaNode_];
+    if (acc.frames == 0) {
+        acc.firstStart = start;
+    }
+    acc.frames += frames;
+    acc.busyTimeMs += timeMs;
+    acc.lastEnd = end;
+}
+
+int SuperResEngine::resolveNumaNode() const {
+    const CpuTopology& topology = CpuTopology::instance();
+    
+    switch (config_.numaPolicy) {
+        case SuperResConfig::NUMA_FIXED:
+            if (topology.cpusOfNode(config_.numaNode).empty()) {
+                LOG_WARNING("NUMA node " + std::to_string(config_.numaNode) + " not available, placement disabled");
+                return -1;
+            }
+            return config_.numaNode;
+        case SuperResConfig::NUMA_ROUND_ROBIN: {
+            // 单节点机器上轮转没有意义，避免无谓的亲和性系统调用
+            if (!topology.isNuma()) {
+                return -1;
+            }
+            static std::atomic<size_t> nextNode{0};
+            size_t index = nextNode.fetch_add(1) % topology.nodes().size();
+            return topology.nodes()[index].id;
+        }
+        case SuperResConfig::NUMA_NONE:
+        default:
+            return -1;
+    }
 }
 
 cv::Mat SuperResEngine::processImageInternal(const cv::Mat& image) {
+    TRACE_SCOPE("SuperResEngine::process", "sr");
+    MEMORY_STAGE_SCOPE("sr");
+    // 超过内存上限时等待其他在途帧释放缓冲，避免多路并发推理把进程推向OOM
+    MemoryTracker::HeadroomScope headroom;
+    // 调用线程在本次处理期间迁到会话所在节点（参与推理的调用线程与输入输出缓冲留在本地内存），
+    // 返回时恢复原亲和性和内存策略：调用方可能是GUI线程或共享的任务线程。
+    // 几次系统调用相对一帧推理可以忽略；单节点机器上不绑定
+    ScopedNumaBinding numaBinding(CpuTopology::instance().isNuma() ? numaNode_ : -1);
+    
     // 检查输入图像尺寸，如果太大则分块处理或缩放处理
     int maxSafeSize = 512; // CPU安全处理的最大尺寸
     
@@ -312,9 +430,7 @@ cv::Mat SuperResEngine::processImageInternal(const cv::Mat& image) {
         cv::resize(image, resizedInput, cv::Size(newWidth, newHeight), 0, 0, cv::INTER_LANCZOS4);
         
         // 处理缩放后的图像
-        Ort::Value inputTensor = processor_->preprocess(resizedInput, session_->getMemoryInfo());
-        Ort::Value outputTensor = session_->inference(inputTensor);
-        cv::Mat resizedOutput = processor_->postprocess(outputTensor, resizedInput.size());
+        cv::Mat resizedOutput = runModel(resizedInput);
         
         // 将结果缩放回原始比例
         cv::Mat finalOutput;
@@ -333,15 +449,32 @@ cv::Mat SuperResEngine::processImageInternal(const cv::Mat& image) {
             cv::resize(image, processImage, cv::Size(adjustedWidth, adjustedHeight));
         }
         
-        // 预处理
-        Ort::Value inputTensor = processor_->preprocess(processImage, session_->getMemoryInfo());
-        
-        // 推理
-        Ort::Value outputTensor = session_->inference(inputTensor);
-        
-        // 后处理
-        return processor_->postprocess(outputTensor, processImage.size());
+        return runModel(processImage);
     }
 }
 
+cv::Mat SuperResEngine::runModel(const cv::Mat& image) {
+    METRICS_COUNTER_ADD("sr_frames", 1);
+    
+    // 预处理
+    Ort::Value inputTensor{nullptr};
+    {
+        METRICS_SCOPED_TIMER("sr_preprocess_us");
+        TRACE_SCOPE("SuperResEngine::preprocess", "sr");
+        inputTensor = processor_->preprocess(image, session_->getMemoryInfo());
+    }
+    
+    // 推理
+    Ort::Value outputTensor{nullptr};
+    {
+        METRICS_SCOPED_TIMER("sr_inference_us");
+        outputTensor = session_->inference(inputTensor);
+    }
+    
+    // 后处理
+    METRICS_SCOPED_TIMER("sr_postprocess_us");
+    TRACE_SCOPE("SuperResEngine::postprocess", "sr");
+    return processor_->postprocess(outputTensor, image.size());
+}
+
 } // namespace SuperEigen 
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "../include/TensorKernels.h"
+#include <algorithm>
+#include <cstring>
+
+namespace SuperEigen {
+
+namespace TensorKernels {
+
+cv::Mat bgrToRgb(const cv::Mat& bgr) {
+    cv::Mat rgb;
+    cv::cvtColor(bgr, rgb, cv::COLOR_BGR2RGB);
+    return rgb;
+}
+
+cv::Mat rgbToBgr(const cv::Mat& rgb) {
+    cv::Mat bgr;
+    cv::cvtColor(rgb, bgr, cv::COLOR_RGB2BGR);
+    return bgr;
+}
+
+void hwcToChw(const cv::Mat& image, std::vector<float>& chw) {
+    // 确保是float类型
+    cv::Mat floatImage;
+    if (image.type() != CV_32FC3) {
+        image.convertTo(floatImage, CV_32FC3, 1.0 / 255.0);
+    } else {
+        floatImage = image;
+    }
+    
+    int h = floatImage.rows;
+    int w = floatImage.cols;
+    int c = floatImage.channels();
+    
+    chw.resize(static_cast<size_t>(h) * w * c);
+    
+    // HWC -> CHW转换
+    std::vector<cv::Mat> channels;
+    cv::split(floatImage, channels);
+    
+    for (int i = 0; i < c; ++i) {
+        std::memcpy(chw.data() + static_cast<size_t>(i) * h * w,
+                   channels[i].data,
+                   static_cast<size_t>(h) * w * sizeof(float));
+    }
+}
+
+cv::Mat chwToHwc(const float* tensor, int channels, int height, int width) {
+    std::vector<cv::Mat> channelMats;
+    channelMats.reserve(channels);
+    
+    size_t channelSize = static_cast<size_t>(height) * width;
+    
+    for (int c = 0; c < channels; ++c) {
+        cv::Mat channel(height, width, CV_32FC1);
+        std::memcpy(channel.data,
+                   tensor + c * channelSize,
+                   channelSize * sizeof(float));
+        channelMats.push_back(channel);
+    }
+    
+    cv::Mat result;
+    cv::merge(channelMats, result);
+    
+    return result;
+}
+
+void normalize(float* data, size_t count, float mean, float std) {
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = (data[i] - mean) / std;
+    }
+}
+
+void denormalize(float* data, size_t count, float mean, float std) {
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = data[i] * std + mean;
+    }
+}
+
+void rescaleToUnitRange(float* data, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    
+    // 检查实际输出范围，用于归一化
+    auto minmax = std::minmax_element(data, data + count);
+    float minVal = *minmax.first;
+    float maxVal = *minmax.second;
+    
+    // 如果输出不在[0,1]范围，先归一化到[0,1]
+    if (maxVal > 1.0f || minVal < 0.0f) {
+        float range = maxVal - minVal;
+        if (range > 0) {
+            for (size_t i = 0; i < count; ++i) {
+                data[i] = (data[i] - minVal) / range;
+            }
+        }
+    }
+    
+    // 确保在[0,1]范围内
+    for (size_t i = 0; i < count; ++i) {
+        data[i] = std::max(0.0f, std::min(1.0f, data[i]));
+    }
+}
+
+} // namespace TensorKernels
+
+} // namespace SuperEigen
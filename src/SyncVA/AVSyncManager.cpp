@@ -1,10 +1,15 @@
 #include "AVSyncManager.h"
 #include "../Utils/Logger.h"
+#include "../Utils/Metrics.h"
+#include <algorithm>
 #include <limits>
 #include <stdexcept>
 
-AVSyncManager::AVSyncManager() {
-    LOG_DEBUG("AVSyncManager initialized");
+AVSyncManager::AVSyncManager(const AVSyncConfig& config) {
+    initStream(video_, config.videoCapacity, config.videoHighWatermark, config.videoLowWatermark);
+    initStream(audio_, config.audioCapacity, config.audioHighWatermark, config.audioLowWatermark);
+    LOG_DEBUG("AVSyncManager initialized, video capacity: " + std::to_string(video_.capacity) +
+              ", audio capacity: " + std::to_string(audio_.capacity));
 }
 
 AVSyncManager::~AVSyncManager() {
@@ -12,57 +17,141 @@ AVSyncManager::~AVSyncManager() {
     LOG_DEBUG("AVSyncManager destroyed");
 }
 
-void AVSyncManager::pushVideo(const FrameData& frame) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool AVSyncManager::pushVideo(const FrameData& frame, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (video_.ended) {
+        LOG_WARNING("Video frame pushed after end of video stream, dropped");
+        return false;
+    }
+    if (video_.capacity > 0 && videoQueue_.size() >= video_.capacity) {
+        METRICS_COUNTER_ADD("sync_video_push_waits", 1);
+    }
+    if (!waitForSpace(lock, video_, videoQueue_, timeout)) {
+        return false;
+    }
+    
     videoQueue_.push_back(frame);
+    video_.lastPushed = std::max(video_.lastPushed, frame.timestamp);
+    METRICS_GAUGE_SET("sync_video_queue", videoQueue_.size());
+    if (updateThrottle(video_, videoQueue_.size())) {
+        LOGF_DEBUG("Video queue throttled at %zu frames", videoQueue_.size());
+    }
     
-    LOG_DEBUG("Video frame pushed, timestamp: " + std::to_string(frame.timestamp) + 
-              "s, queue size: " + std::to_string(videoQueue_.size()));
+    LOGF_DEBUG("Video frame pushed, timestamp: %fs, queue size: %zu", frame.timestamp, videoQueue_.size());
+    lock.unlock();
+    readyCv_.notify_all();
+    return true;
 }
 
-void AVSyncManager::pushAudio(const AudioFrameData& frame) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool AVSyncManager::pushAudio(const AudioFrameData& frame, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (audio_.ended) {
+        LOG_WARNING("Audio frame pushed after end of audio stream, dropped");
+        return false;
+    }
+    if (audio_.capacity > 0 && audioQueue_.size() >= audio_.capacity) {
+        METRICS_COUNTER_ADD("sync_audio_push_waits", 1);
+    }
+    if (!waitForSpace(lock, audio_, audioQueue_, timeout)) {
+        return false;
+    }
+    
     audioQueue_.push_back(frame);
+    audio_.lastPushed = std::max(audio_.lastPushed, frame.timestamp);
+    METRICS_GAUGE_SET("sync_audio_queue", audioQueue_.size());
+    if (updateThrottle(audio_, audioQueue_.size())) {
+        LOGF_DEBUG("Audio queue throttled at %zu frames", audioQueue_.size());
+    }
     
-    LOG_DEBUG("Audio frame pushed, timestamp: " + std::to_string(frame.timestamp) + 
-              "s, queue size: " + std::to_string(audioQueue_.size()));
+    LOGF_DEBUG("Audio frame pushed, timestamp: %fs, queue size: %zu", frame.timestamp, audioQueue_.size());
+    lock.unlock();
+    readyCv_.notify_all();
+    return true;
+}
+
+void AVSyncManager::endVideo() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        video_.ended = true;
+    }
+    LOG_DEBUG("Video stream ended in sync manager");
+    readyCv_.notify_all();
+}
+
+void AVSyncManager::endAudio() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        audio_.ended = true;
+    }
+    LOG_DEBUG("Audio stream ended in sync manager");
+    readyCv_.notify_all();
+}
+
+void AVSyncManager::abort() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        aborted_ = true;
+    }
+    spaceCv_.notify_all();
+    readyCv_.notify_all();
 }
 
 bool AVSyncManager::hasNext() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return !videoQueue_.empty() || !audioQueue_.empty();
+    return readyLocked() != Ready::None;
 }
 
 AVSyncManager::FrameVariant AVSyncManager::popNext() {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
     
-    if (videoQueue_.empty() && audioQueue_.empty()) {
+    Ready ready = readyLocked();
+    if (ready == Ready::None) {
         throw std::runtime_error("No frames available in sync manager");
     }
     
-    double videoTimestamp = getVideoFrontTimestamp();
-    double audioTimestamp = getAudioFrontTimestamp();
+    FrameVariant frame = popLocked(ready);
+    lock.unlock();
+    spaceCv_.notify_all();
+    return frame;
+}
+
+bool AVSyncManager::popNext(FrameVariant& frame, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
     
-    // 比较时间戳，选择更早的帧
-    if (videoTimestamp <= audioTimestamp) {
-        // 视频帧更早（或音频队列为空）
-        FrameData frame = videoQueue_.front();
-        videoQueue_.pop_front();
-        
-        LOG_DEBUG("Popped video frame, timestamp: " + std::to_string(frame.timestamp) + 
-                  "s, remaining video frames: " + std::to_string(videoQueue_.size()));
-        
-        return frame;
-    } else {
-        // 音频帧更早（或视频队列为空）
-        AudioFrameData frame = audioQueue_.front();
-        audioQueue_.pop_front();
-        
-        LOG_DEBUG("Popped audio frame, timestamp: " + std::to_string(frame.timestamp) + 
-                  "s, remaining audio frames: " + std::to_string(audioQueue_.size()));
-        
-        return frame;
+    auto done = [this]() {
+        return aborted_ || readyLocked() != Ready::None ||
+               (video_.ended && audio_.ended && videoQueue_.empty() && audioQueue_.empty());
+    };
+    if (timeout.count() < 0) {
+        readyCv_.wait(lock, done);
+    } else if (!readyCv_.wait_for(lock, timeout, done)) {
+        return false;
     }
+    
+    Ready ready = readyLocked();
+    if (aborted_ || ready == Ready::None) {
+        return false;
+    }
+    
+    frame = popLocked(ready);
+    lock.unlock();
+    spaceCv_.notify_all();
+    return true;
+}
+
+bool AVSyncManager::isFinished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return video_.ended && audio_.ended && videoQueue_.empty() && audioQueue_.empty();
+}
+
+bool AVSyncManager::isVideoThrottled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return video_.throttled;
+}
+
+bool AVSyncManager::isAudioThrottled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return audio_.throttled;
 }
 
 size_t AVSyncManager::getVideoQueueSize() const {
@@ -83,6 +172,9 @@ void AVSyncManager::clear() {
     
     videoQueue_.clear();
     audioQueue_.clear();
+    video_.throttled = false;
+    audio_.throttled = false;
+    spaceCv_.notify_all();
     
     LOG_INFO("Cleared sync manager queues - Video: " + std::to_string(videoCount) + 
              " frames, Audio: " + std::to_string(audioCount) + " frames");
@@ -129,4 +221,83 @@ double AVSyncManager::getAudioFrontTimestamp() const {
         return std::numeric_limits<double>::infinity();
     }
     return audioQueue_.front().timestamp;
-} 
\ No newline at end of file
+}
+
+void AVSyncManager::initStream(StreamState& stream, size_t capacity, size_t high, size_t low) {
+    stream.capacity = capacity;
+    // 不限容量且未指定水位时不节流
+    stream.highWatermark = high > 0 ? high : capacity * 3 / 4;
+    stream.lowWatermark = low > 0 ? low : capacity / 4;
+    if (capacity > 0) {
+        stream.highWatermark = std::min(std::max<size_t>(stream.highWatermark, 1), capacity);
+    }
+    stream.lowWatermark = std::min(stream.lowWatermark, stream.highWatermark > 0 ? stream.highWatermark - 1 : 0);
+}
+
+template <typename Queue>
+bool AVSyncManager::waitForSpace(std::unique_lock<std::mutex>& lock, const StreamState& stream, const Queue& queue,
+                                 std::chrono::milliseconds timeout) {
+    auto hasSpace = [this, &stream, &queue]() {
+        return aborted_ || stream.capacity == 0 || queue.size() < stream.capacity;
+    };
+    if (timeout.count() < 0) {
+        spaceCv_.wait(lock, hasSpace);
+    } else if (!spaceCv_.wait_for(lock, timeout, hasSpace)) {
+        return false;
+    }
+    return !aborted_;
+}
+
+bool AVSyncManager::updateThrottle(StreamState& stream, size_t queueSize) {
+    if (stream.highWatermark == 0) {
+        return false;
+    }
+    if (!stream.throttled && queueSize >= stream.highWatermark) {
+        stream.throttled = true;
+        return true;
+    }
+    if (stream.throttled && queueSize <= stream.lowWatermark) {
+        stream.throttled = false;
+    }
+    return false;
+}
+
+AVSyncManager::Ready AVSyncManager::readyLocked() const {
+    if (videoQueue_.empty() && audioQueue_.empty()) {
+        return Ready::None;
+    }
+    
+    double videoTimestamp = getVideoFrontTimestamp();
+    double audioTimestamp = getAudioFrontTimestamp();
+    
+    // 比较时间戳，选择更早的帧；另一路推进到它之后（或已结束）才输出，
+    // 否则另一路之后推入的帧可能比它更早
+    if (videoTimestamp <= audioTimestamp) {
+        return audio_.ended || audio_.lastPushed >= videoTimestamp ? Ready::Video : Ready::None;
+    }
+    return video_.ended || video_.lastPushed >= audioTimestamp ? Ready::Audio : Ready::None;
+}
+
+AVSyncManager::FrameVariant AVSyncManager::popLocked(Ready ready) {
+    if (ready == Ready::Video) {
+        FrameData frame = std::move(videoQueue_.front());
+        videoQueue_.pop_front();
+        METRICS_GAUGE_SET("sync_video_queue", videoQueue_.size());
+        updateThrottle(video_, videoQueue_.size());
+        
+        LOGF_DEBUG("Popped video frame, timestamp: %fs, remaining video frames: %zu",
+                   frame.timestamp, videoQueue_.size());
+        
+        return frame;
+    }
+    
+    AudioFrameData frame = std::move(audioQueue_.front());
+    audioQueue_.pop_front();
+    METRICS_GAUGE_SET("sync_audio_queue", audioQueue_.size());
+    updateThrottle(audio_, audioQueue_.size());
+    
+    LOGF_DEBUG("Popped audio frame, timestamp: %fs, remaining audio frames: %zu",
+               frame.timestamp, audioQueue_.size());
+    
+    return frame;
+}
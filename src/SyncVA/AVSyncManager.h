@@ -1,51 +1,105 @@
 #ifndef AVSYNC_MANAGER_H
 #define AVSYNC_MANAGER_H
 
+#include <chrono>
+#include <condition_variable>
 #include <deque>
+#include <limits>
 #include <variant>
 #include <mutex>
 #include "../DataStruct/FrameData.h"
 #include "../DataStruct/AudioFrameData.h"
 
+/**
+ * @brief 音视频同步管理器配置
+ */
+struct AVSyncConfig {
+    size_t videoCapacity = 0;           // 视频队列容量（0表示不限制）
+    size_t audioCapacity = 0;           // 音频队列容量（0表示不限制）
+    size_t videoHighWatermark = 0;      // 视频队列高水位（0表示容量的3/4）
+    size_t videoLowWatermark = 0;       // 视频队列低水位（0表示容量的1/4）
+    size_t audioHighWatermark = 0;      // 音频队列高水位（0表示容量的3/4）
+    size_t audioLowWatermark = 0;       // 音频队列低水位（0表示容量的1/4）
+};
+
 /**
  * @brief 音视频同步管理器
  * 
  * 负责基于时间戳的音视频帧同步调度，确保音画同步。
- * 核心原理：谁的时间戳更早，谁就先输出。
+ * 核心原理：谁的时间戳更早，谁就先输出；且只有另一路已推进到该时间戳之后
+ * （或已结束）时才输出，后到的另一路帧不会排到已输出的帧之前。
+ * 
+ * 每路可设容量：满时推入阻塞（或限时等待），流水线各级速度不一致时内存也有上限。
+ * 队列长度达到高水位时该路进入节流状态，回落到低水位后解除，生产者据此提前放慢。
+ * 每路数据推完后须调用 endVideo()/endAudio()，没有音频的输入在开始时即调用 endAudio()。
  */
 class AVSyncManager {
 public:
     // 统一的帧类型，可以是视频帧或音频帧
     using FrameVariant = std::variant<FrameData, AudioFrameData>;
     
-    AVSyncManager();
+    explicit AVSyncManager(const AVSyncConfig& config = AVSyncConfig());
     ~AVSyncManager();
     
     /**
-     * @brief 推入视频帧到队列
+     * @brief 推入视频帧到队列，队列满时等待
      * @param frame 视频帧数据
+     * @param timeout 等待时间，负值表示一直等待
+     * @return 超时、已调用abort()或视频已结束时返回false
      */
-    void pushVideo(const FrameData& frame);
+    bool pushVideo(const FrameData& frame, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
     
     /**
-     * @brief 推入音频帧到队列
+     * @brief 推入音频帧到队列，队列满时等待
      * @param frame 音频帧数据
+     * @param timeout 等待时间，负值表示一直等待
+     * @return 超时、已调用abort()或音频已结束时返回false
+     */
+    bool pushAudio(const AudioFrameData& frame, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+    
+    /**
+     * @brief 标记视频/音频已全部推入，另一路不再等待它推进
+     */
+    void endVideo();
+    void endAudio();
+    
+    /**
+     * @brief 中止：唤醒并拒绝所有等待中的推入/弹出
      */
-    void pushAudio(const AudioFrameData& frame);
+    void abort();
     
     /**
      * @brief 检查是否有帧可供输出
-     * @return true 如果有帧可输出，false 否则
+     * @return true 如果有满足同步条件的帧可输出，false 否则
      */
     bool hasNext() const;
     
     /**
      * @brief 弹出时间戳最早的帧
      * @return 最早的帧（视频或音频）
-     * @throws std::runtime_error 如果队列为空
+     * @throws std::runtime_error 如果没有可输出的帧
      */
     FrameVariant popNext();
     
+    /**
+     * @brief 等待并弹出下一个可输出的帧
+     * @param frame 输出帧
+     * @param timeout 等待时间，负值表示一直等待
+     * @return 超时、已中止或两路都结束且已取空时返回false
+     */
+    bool popNext(FrameVariant& frame, std::chrono::milliseconds timeout);
+    
+    /**
+     * @brief 两路都已结束且队列已取空
+     */
+    bool isFinished() const;
+    
+    /**
+     * @brief 视频/音频队列是否处于节流状态（超过高水位且尚未回落到低水位）
+     */
+    bool isVideoThrottled() const;
+    bool isAudioThrottled() const;
+    
     /**
      * @brief 获取当前视频队列大小
      * @return 视频队列中的帧数
@@ -59,7 +113,7 @@ public:
     size_t getAudioQueueSize() const;
     
     /**
-     * @brief 清空所有队列
+     * @brief 清空所有队列（结束标记保留）
      */
     void clear();
     
@@ -100,14 +154,40 @@ public:
     static const AudioFrameData& getAudioFrame(const FrameVariant& frame);
 
 private:
+    // 单路队列的容量与状态
+    struct StreamState {
+        size_t capacity = 0;
+        size_t highWatermark = 0;
+        size_t lowWatermark = 0;
+        bool ended = false;
+        bool throttled = false;
+        double lastPushed = -std::numeric_limits<double>::infinity();  // 该路已推进到的时间戳
+    };
+    
+    enum class Ready { None, Video, Audio };
+    
     // 视频帧队列
     std::deque<FrameData> videoQueue_;
     
     // 音频帧队列
     std::deque<AudioFrameData> audioQueue_;
     
+    StreamState video_;
+    StreamState audio_;
+    bool aborted_ = false;
+    
     // 线程安全保护
     mutable std::mutex mutex_;
+    std::condition_variable spaceCv_;   // 推入方等待队列空间
+    std::condition_variable readyCv_;   // 弹出方等待可输出的帧
+    
+    static void initStream(StreamState& stream, size_t capacity, size_t high, size_t low);
+    template <typename Queue>
+    bool waitForSpace(std::unique_lock<std::mutex>& lock, const StreamState& stream, const Queue& queue,
+                      std::chrono::milliseconds timeout);
+    static bool updateThrottle(StreamState& stream, size_t queueSize);
+    Ready readyLocked() const;
+    FrameVariant popLocked(Ready ready);
     
     /**
      * @brief 获取视频队列前端帧的时间戳
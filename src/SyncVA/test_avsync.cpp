@@ -0,0 +1,155 @@
+#include "AVSyncManager.h"
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+FrameData makeVideo(double timestamp) {
+    FrameData frame;
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+AudioFrameData makeAudio(double timestamp) {
+    AudioFrameData frame;
+    frame.timestamp = timestamp;
+    return frame;
+}
+
+bool check(bool condition, const std::string& message) {
+    if (!condition) {
+        std::cerr << "失败: " << message << std::endl;
+    }
+    return condition;
+}
+
+} // namespace
+
+bool testCapacity() {
+    std::cout << "\n=== 测试队列容量与限时推入 ===" << std::endl;
+    AVSyncConfig config;
+    config.videoCapacity = 2;
+    AVSyncManager sync(config);
+    sync.endAudio();
+
+    bool ok = check(sync.pushVideo(makeVideo(0.0)), "第1帧推入");
+    ok &= check(sync.pushVideo(makeVideo(0.04)), "第2帧推入");
+    auto start = std::chrono::steady_clock::now();
+    ok &= check(!sync.pushVideo(makeVideo(0.08), std::chrono::milliseconds(20)), "队列满时限时推入应超时");
+    ok &= check(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(20), "超时前应等待");
+
+    // 取出一帧后阻塞的推入继续
+    std::thread producer([&sync]() { sync.pushVideo(makeVideo(0.08)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    AVSyncManager::FrameVariant frame;
+    ok &= check(sync.popNext(frame, std::chrono::milliseconds(0)), "取出第1帧");
+    producer.join();
+    ok &= check(sync.getVideoQueueSize() == 2, "取出后阻塞的推入应完成");
+
+    // 中止唤醒阻塞的推入
+    std::thread blocked([&sync, &ok]() { ok &= check(!sync.pushVideo(makeVideo(0.12)), "中止后推入应失败"); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sync.abort();
+    blocked.join();
+    return ok;
+}
+
+bool testWatermarks() {
+    std::cout << "\n=== 测试高低水位 ===" << std::endl;
+    AVSyncConfig config;
+    config.audioCapacity = 8;  // 默认高水位6、低水位2
+    AVSyncManager sync(config);
+    sync.endVideo();
+
+    bool ok = true;
+    for (int i = 0; i < 5; ++i) {
+        sync.pushAudio(makeAudio(i * 0.02));
+    }
+    ok &= check(!sync.isAudioThrottled(), "低于高水位不节流");
+    sync.pushAudio(makeAudio(5 * 0.02));
+    ok &= check(sync.isAudioThrottled(), "达到高水位进入节流");
+
+    AVSyncManager::FrameVariant frame;
+    for (int i = 0; i < 3; ++i) {
+        sync.popNext(frame, std::chrono::milliseconds(0));
+    }
+    ok &= check(sync.isAudioThrottled(), "高于低水位保持节流");
+    sync.popNext(frame, std::chrono::milliseconds(0));
+    ok &= check(!sync.isAudioThrottled(), "回落到低水位解除节流");
+    return ok;
+}
+
+bool testGating() {
+    std::cout << "\n=== 测试另一路推进后才输出 ===" << std::endl;
+    AVSyncManager sync;
+    sync.pushVideo(makeVideo(0.10));
+    bool ok = check(!sync.hasNext(), "音频未推进到视频时间戳前视频不输出");
+    sync.pushAudio(makeAudio(0.05));
+    ok &= check(sync.hasNext(), "更早的音频可输出");
+
+    AVSyncManager::FrameVariant frame;
+    sync.popNext(frame, std::chrono::milliseconds(0));
+    ok &= check(AVSyncManager::isAudioFrame(frame), "先输出音频");
+    ok &= check(!sync.popNext(frame, std::chrono::milliseconds(10)), "视频仍须等待音频");
+    sync.pushAudio(makeAudio(0.12));
+    sync.popNext(frame, std::chrono::milliseconds(0));
+    ok &= check(AVSyncManager::isVideoFrame(frame), "音频越过视频后输出视频");
+
+    sync.endVideo();
+    sync.endAudio();
+    sync.popNext(frame, std::chrono::milliseconds(0));
+    ok &= check(!sync.popNext(frame, std::chrono::milliseconds(-1)), "两路结束且取空后不再阻塞");
+    ok &= check(sync.isFinished(), "两路结束且取空");
+    return ok;
+}
+
+bool testProducerConsumer() {
+    std::cout << "\n=== 测试独立消费线程 ===" << std::endl;
+    AVSyncConfig config;
+    config.videoCapacity = 2;
+    config.audioCapacity = 4;
+    AVSyncManager sync(config);
+
+    const int videoFrames = 200;
+    std::thread producer([&sync]() {
+        // 视频25fps，音频约47fps（1024样本@48kHz）
+        double audioTime = 0.0;
+        for (int i = 0; i < videoFrames; ++i) {
+            double videoTime = i * 0.04;
+            sync.pushVideo(makeVideo(videoTime));
+            while (audioTime <= videoTime) {
+                sync.pushAudio(makeAudio(audioTime));
+                audioTime += 1024.0 / 48000.0;
+            }
+        }
+        sync.endVideo();
+        sync.endAudio();
+    });
+
+    bool ok = true;
+    int videoCount = 0;
+    double last = -1.0;
+    AVSyncManager::FrameVariant frame;
+    while (sync.popNext(frame, std::chrono::milliseconds(1000))) {
+        double timestamp = AVSyncManager::isVideoFrame(frame) ? AVSyncManager::getVideoFrame(frame).timestamp
+                                                              : AVSyncManager::getAudioFrame(frame).timestamp;
+        ok &= check(timestamp >= last, "输出时间戳应单调");
+        last = timestamp;
+        videoCount += AVSyncManager::isVideoFrame(frame) ? 1 : 0;
+        ok &= check(sync.getVideoQueueSize() <= 2 && sync.getAudioQueueSize() <= 4, "队列不超过容量");
+    }
+    producer.join();
+    ok &= check(videoCount == videoFrames, "视频帧全部输出");
+    ok &= check(sync.isFinished(), "消费结束时两路已取空");
+    return ok;
+}
+
+int main() {
+    bool ok = testCapacity();
+    ok &= testWatermarks();
+    ok &= testGating();
+    ok &= testProducerConsumer();
+    std::cout << (ok ? "\n全部通过" : "\n存在失败") << std::endl;
+    return ok ? 0 : 1;
+}
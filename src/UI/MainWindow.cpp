@@ -45,9 +45,31 @@ MainWindow::MainWindow(QWidget *parent)
     m_statusTimer = new QTimer(this);
     m_statusTimer->setSingleShot(true);
 
-    // 初始化工作池（单线程用于图像处理）
+    // 初始化工作池（单线程用于引擎初始化和图像加载）
     m_workerPool = new WorkerPool(1, this);
 
+    // 超分作业调度器：引擎就绪后作为会话加入
+    m_jobScheduler = std::make_unique<JobScheduler>();
+
+    // 批量图像流水线：结果回到主线程更新预览和进度
+    m_imageBatch = std::make_unique<ImageBatchPipeline>(*m_jobScheduler);
+    m_imageBatch->setResultCallback([this](const ImageBatchResult& result) {
+        QString filePath = QString::fromStdString(result.item.inputPath);
+        if (result.success) {
+            cv::Mat original = result.original;
+            cv::Mat enhanced = result.enhanced;
+            qint64 processingTime = static_cast<qint64>(result.totalMs);
+            QMetaObject::invokeMethod(this, [this, filePath, original, enhanced, processingTime]() {
+                onImageProcessed(filePath, original, enhanced, processingTime);
+            }, Qt::QueuedConnection);
+        } else {
+            QString error = QString::fromStdString(result.error);
+            QMetaObject::invokeMethod(this, [this, filePath, error]() {
+                onImageProcessError(filePath, error);
+            }, Qt::QueuedConnection);
+        }
+    });
+
     // 异步初始化超分引擎
     initializeSuperResEngine();
 
@@ -67,7 +89,14 @@ MainWindow::~MainWindow()
 {
     qDebug() << "MainWindow: 开始析构";
 
-    // 停止工作池
+    // 先取消批量图像和超分作业，再停止工作池
+    if (m_imageBatch) {
+        m_imageBatch->cancel();
+    }
+    if (m_jobScheduler) {
+        m_jobScheduler->shutdown();
+    }
+    m_imageBatch.reset();
     if (m_workerPool) {
         m_workerPool->stop();
     }
@@ -590,7 +619,8 @@ void MainWindow::processCurrentImage()
     }
 
     // 异步处理当前图像
-    processImageAsync(m_currentFilePath);
+    // 当前图像为交互作业：批处理进行中也会在下一帧边界被优先调度
+    processImageAsync(m_currentFilePath, JobPriority::Interactive);
     m_isProcessing = true;
     updateProcessingStatus();
     showStatusMessage("🚀 开始处理当前图像...");
@@ -616,9 +646,17 @@ void MainWindow::processAllImages()
     m_completedTasks = 0;
     m_isProcessing = true;
 
-    // 开始批量处理
+    // 开始批量处理：解码/编码在线程池上并行，与推理重叠
+    ImageBatchConfig batchConfig;
+    batchConfig.jpegQuality = m_currentSettings.jpegQuality;
+    batchConfig.priority = JobPriority::Normal;
+    batchConfig.keepImages = true;
+    m_imageBatch->setConfig(batchConfig);
+    if (!m_currentSettings.outputPath.isEmpty()) {
+        QDir().mkpath(m_currentSettings.outputPath);
+    }
     for (const QString& filePath : filePaths) {
-        processImageAsync(filePath);
+        m_imageBatch->submit({filePath.toStdString(), batchOutputPath(filePath).toStdString()});
     }
 
     updateProcessingStatus();
@@ -632,14 +670,16 @@ void MainWindow::pauseProcessing()
     }
 
     if (m_isPaused) {
-        // 恢复处理（简化版本，实际上WorkerPool会继续处理队列中的任务）
+        // 恢复处理
         m_isPaused = false;
+        m_jobScheduler->setPaused(false);
         m_pauseBtn->setText("⏸️ 暂停");
         m_pauseAction->setText("⏸️ 暂停处理");
         showStatusMessage("▶️ 处理已恢复");
     } else {
-        // 暂停处理（简化版本，不会停止正在进行的任务，但会标记为暂停状态）
+        // 暂停处理：正在处理的图像完成后不再调度新的作业
         m_isPaused = true;
+        m_jobScheduler->setPaused(true);
         m_pauseBtn->setText("▶️ 恢复");
         m_pauseAction->setText("▶️ 恢复处理");
         showStatusMessage("⏸️ 处理已暂停");
@@ -661,8 +701,11 @@ void MainWindow::stopProcessing()
         return;
     }
 
-    // 清空处理队列
+    // 清空处理队列，取消尚未完成的作业
     m_processingQueue.clear();
+    m_imageBatch->cancel();
+    m_jobScheduler->cancelAll();
+    m_jobScheduler->setPaused(false);
 
     m_isProcessing = false;
     m_isPaused = false;
@@ -795,7 +838,7 @@ void MainWindow::initializeSuperResEngine()
     m_workerPool->submitTask([this]() {
         try {
             qDebug() << "开始初始化超分辨率引擎...";
-            m_srEngine = std::make_unique<SuperEigen::SuperResEngine>();
+            m_srEngine = std::make_shared<SuperEigen::SuperResEngine>();
 
             // 构建正确的模型路径
             QString appDir = QApplication::applicationDirPath();
@@ -805,6 +848,7 @@ void MainWindow::initializeSuperResEngine()
 
             // 尝试初始化引擎
             if (m_srEngine->initialize(modelPath.toStdString())) {
+                m_jobScheduler->addSession(m_srEngine);
                 m_engineReady = true;
                 qDebug() << "超分辨率引擎初始化成功";
 
@@ -874,14 +918,14 @@ void MainWindow::loadImageForPreview(const QString& filePath)
 }
 
 // 异步处理图像
-void MainWindow::processImageAsync(const QString& filePath)
+void MainWindow::processImageAsync(const QString& filePath, JobPriority priority)
 {
     if (!m_engineReady) {
         showStatusMessage("⚠️ 超分辨率引擎未就绪", 3000);
         return;
     }
 
-    m_workerPool->submitTask([this, filePath]() {
+    auto job = std::make_shared<FunctionJob>(filePath.toStdString(), [this, filePath](SuperEigen::SuperResEngine& engine) {
         try {
             QElapsedTimer timer;
             timer.start();
@@ -905,7 +949,7 @@ void MainWindow::processImageAsync(const QString& filePath)
             }
 
             // 执行超分辨率处理
-            cv::Mat enhancedImage = m_srEngine->Process(originalImage);
+            cv::Mat enhancedImage = engine.Process(originalImage);
             if (enhancedImage.empty()) {
                 throw std::runtime_error("超分辨率处理失败");
             }
@@ -916,14 +960,40 @@ void MainWindow::processImageAsync(const QString& filePath)
             QMetaObject::invokeMethod(this, [this, filePath, originalImage, enhancedImage, processingTime]() {
                 onImageProcessed(filePath, originalImage, enhancedImage, processingTime);
             }, Qt::QueuedConnection);
+            return true;
 
         } catch (const std::exception& e) {
             QString error = e.what();
             QMetaObject::invokeMethod(this, [this, filePath, error]() {
                 onImageProcessError(filePath, error);
             }, Qt::QueuedConnection);
+            return false;
         }
     });
+
+    JobOptions options;
+    options.priority = priority;
+    if (priority == JobPriority::Interactive) {
+        // 交互预览期望在2秒内出结果，超时计入 jobs_deadline_missed
+        options.deadline = JobOptions::Clock::now() + std::chrono::seconds(2);
+    }
+    m_jobScheduler->submit(job, options);
+}
+
+// 批量输出路径：未设置输出目录时只预览不写出
+QString MainWindow::batchOutputPath(const QString& inputPath) const
+{
+    if (m_currentSettings.outputPath.isEmpty()) {
+        return QString();
+    }
+
+    QFileInfo info(inputPath);
+    QString name = info.completeBaseName();
+    if (!m_currentSettings.preserveOriginalName) {
+        name += m_currentSettings.nameSuffix;
+    }
+    QString format = m_currentSettings.outputFormat.isEmpty() ? info.suffix() : m_currentSettings.outputFormat;
+    return QDir(m_currentSettings.outputPath).filePath(name + "." + format);
 }
 
 // 处理结果回调
@@ -37,6 +37,8 @@
 
 // 引入工作池
 #include "../WorkerPool/WorkerPool.h"
+#include "../AppController/JobScheduler.h"
+#include "../AppController/ImageBatchPipeline.h"
 #include "../SuperEigen/include/SuperResEngine.h"
 
 QT_BEGIN_NAMESPACE
@@ -141,7 +143,8 @@ private:
     // 超分引擎管理
     void initializeSuperResEngine();
     void loadImageForPreview(const QString& filePath);
-    void processImageAsync(const QString& filePath);
+    void processImageAsync(const QString& filePath, JobPriority priority = JobPriority::Normal);
+    QString batchOutputPath(const QString& inputPath) const;
 
 private:
     // 菜单和动作
@@ -175,9 +178,11 @@ private:
     ImagePreviewWidget *m_imagePreviewWidget;
     SettingsPanel *m_settingsPanel;
 
-    // 工作池和超分引擎
+    // 工作池、作业调度器和超分引擎
     WorkerPool *m_workerPool;
-    std::unique_ptr<SuperEigen::SuperResEngine> m_srEngine;
+    std::unique_ptr<JobScheduler> m_jobScheduler;  // 超分作业按优先级共享引擎
+    std::unique_ptr<ImageBatchPipeline> m_imageBatch;  // 批量处理：并行解码/编码，超分走作业调度器
+    std::shared_ptr<SuperEigen::SuperResEngine> m_srEngine;
     bool m_engineReady;
     
     // 控制面板
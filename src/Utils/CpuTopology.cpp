@@ -0,0 +1,187 @@
+#include "CpuTopology.h"
+#include "Logger.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+constexpr int kMaxNodes = 1024;
+constexpr size_t kBitsPerLong = sizeof(unsigned long) * 8;
+
+constexpr size_t kMaskLongs = kMaxNodes / kBitsPerLong;
+
+long setMemPolicy(int mode, const unsigned long* mask, unsigned long maxNode) {
+    return ::syscall(SYS_set_mempolicy, mode, mask, maxNode);
+}
+
+long getMemPolicy(int* mode, unsigned long* mask, unsigned long maxNode) {
+    return ::syscall(SYS_get_mempolicy, mode, mask, maxNode, nullptr, 0UL);
+}
+
+// 把当前线程的CPU亲和性设为节点上的CPU
+bool setNodeAffinity(const std::vector<int>& cpus) {
+    cpu_set_t nodeSet;
+    CPU_ZERO(&nodeSet);
+    for (int cpu : cpus) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &nodeSet);
+        }
+    }
+    return ::sched_setaffinity(0, sizeof(nodeSet), &nodeSet) == 0;
+}
+
+// 当前线程的内存优先从节点分配（单节点系统上没有意义）
+bool preferNode(const CpuTopology& topology, int nodeId) {
+    if (!topology.isNuma() || nodeId >= kMaxNodes) {
+        return false;
+    }
+    unsigned long mask[kMaskLongs] = {};
+    mask[nodeId / kBitsPerLong] |= 1UL << (nodeId % kBitsPerLong);
+    // 内核会将maxnode减一，因此传入位数+1
+    return setMemPolicy(MPOL_PREFERRED, mask, kMaxNodes + 1) == 0;
+}
+} // namespace
+
+const CpuTopology& CpuTopology::instance() {
+    static CpuTopology topology;
+    return topology;
+}
+
+CpuTopology::CpuTopology() {
+    detect();
+}
+
+void CpuTopology::detect() {
+    namespace fs = std::filesystem;
+    const fs::path nodeRoot = "/sys/devices/system/node";
+
+    std::error_code ec;
+    if (fs::is_directory(nodeRoot, ec)) {
+        for (const auto& entry : fs::directory_iterator(nodeRoot, ec)) {
+            std::string name = entry.path().filename().string();
+            if (name.rfind("node", 0) != 0 || name.size() <= 4 ||
+                !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+                continue;
+            }
+
+            std::ifstream cpulist(entry.path() / "cpulist");
+            std::string text;
+            std::getline(cpulist, text);
+
+            Node node;
+            node.id = std::stoi(name.substr(4));
+            node.cpus = parseCpuList(text);
+            // 无CPU的节点（纯内存节点）不参与线程放置
+            if (!node.cpus.empty()) {
+                nodes_.push_back(node);
+            }
+        }
+    }
+
+    std::sort(nodes_.begin(), nodes_.end(),
+              [](const Node& a, const Node& b) { return a.id < b.id; });
+
+    if (nodes_.empty()) {
+        Node node;
+        unsigned int count = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned int cpu = 0; cpu < count; ++cpu) {
+            node.cpus.push_back(static_cast<int>(cpu));
+        }
+        nodes_.push_back(node);
+    }
+
+    std::string summary = "CPU topology: " + std::to_string(nodes_.size()) + " NUMA node(s)";
+    for (const auto& node : nodes_) {
+        summary += ", node" + std::to_string(node.id) + "=" + std::to_string(node.cpus.size()) + " cpus";
+    }
+    LOG_DEBUG(summary);
+}
+
+std::vector<int> CpuTopology::cpusOfNode(int nodeId) const {
+    for (const auto& node : nodes_) {
+        if (node.id == nodeId) {
+            return node.cpus;
+        }
+    }
+    return {};
+}
+
+int CpuTopology::currentNode() const {
+    int cpu = ::sched_getcpu();
+    if (cpu < 0) {
+        return -1;
+    }
+    for (const auto& node : nodes_) {
+        if (std::find(node.cpus.begin(), node.cpus.end(), cpu) != node.cpus.end()) {
+            return node.id;
+        }
+    }
+    return -1;
+}
+
+std::vector<int> CpuTopology::parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        try {
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            LOG_WARNING("Malformed cpulist entry: " + range);
+        }
+    }
+    return cpus;
+}
+
+ScopedNumaBinding::ScopedNumaBinding(int nodeId) {
+    if (nodeId < 0) {
+        return;
+    }
+
+    const CpuTopology& topology = CpuTopology::instance();
+    std::vector<int> cpus = topology.cpusOfNode(nodeId);
+    if (cpus.empty()) {
+        LOG_WARNING("NUMA node " + std::to_string(nodeId) + " has no CPUs, binding skipped");
+        return;
+    }
+
+    CPU_ZERO(&previousAffinity_);
+    if (::sched_getaffinity(0, sizeof(previousAffinity_), &previousAffinity_) == 0) {
+        affinitySet_ = setNodeAffinity(cpus);
+    }
+    if (!affinitySet_) {
+        LOG_WARNING("Failed to set CPU affinity for NUMA node " + std::to_string(nodeId));
+        return;
+    }
+
+    // 记下原内存策略，析构时恢复（外层可能已有绑定，不能简单重置为MPOL_DEFAULT）
+    if (topology.isNuma()) {
+        previousNodes_.assign(kMaskLongs, 0);
+        if (getMemPolicy(&previousPolicy_, previousNodes_.data(), kMaxNodes + 1) == 0) {
+            memPolicySet_ = preferNode(topology, nodeId);
+        }
+    }
+}
+
+ScopedNumaBinding::~ScopedNumaBinding() {
+    if (memPolicySet_) {
+        bool hasNodes = previousPolicy_ != MPOL_DEFAULT;
+        setMemPolicy(previousPolicy_, hasNodes ? previousNodes_.data() : nullptr, hasNodes ? kMaxNodes + 1 : 0);
+    }
+    if (affinitySet_) {
+        ::sched_setaffinity(0, sizeof(previousAffinity_), &previousAffinity_);
+    }
+}
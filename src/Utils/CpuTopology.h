@@ -0,0 +1,84 @@
+#ifndef CPU_TOPOLOGY_H
+#define CPU_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <sched.h>
+
+/**
+ * @brief CPU/NUMA拓扑信息
+ *
+ * 启动时从 /sys/devices/system/node 读取各NUMA节点的CPU列表，
+ * 单节点或非Linux环境下退化为一个包含全部CPU的节点
+ */
+class CpuTopology {
+public:
+    struct Node {
+        int id = 0;                 // 节点编号
+        std::vector<int> cpus;      // 节点上的逻辑CPU
+    };
+
+    /**
+     * @brief 获取进程级拓扑（首次调用时探测）
+     */
+    static const CpuTopology& instance();
+
+    int nodeCount() const { return static_cast<int>(nodes_.size()); }
+    const std::vector<Node>& nodes() const { return nodes_; }
+
+    /**
+     * @brief 获取节点的CPU列表
+     * @param nodeId 节点编号
+     * @return CPU列表，节点不存在时为空
+     */
+    std::vector<int> cpusOfNode(int nodeId) const;
+
+    /**
+     * @brief 当前线程所在CPU对应的节点
+     * @return 节点编号，无法确定时返回-1
+     */
+    int currentNode() const;
+
+    /**
+     * @brief 是否为多节点系统（需要做放置决策）
+     */
+    bool isNuma() const { return nodes_.size() > 1; }
+
+    /**
+     * @brief 解析内核cpulist格式，如 "0-3,8-11"
+     */
+    static std::vector<int> parseCpuList(const std::string& text);
+
+private:
+    CpuTopology();
+    void detect();
+
+    std::vector<Node> nodes_;
+};
+
+/**
+ * @brief 作用域内将当前线程绑定到NUMA节点
+ *
+ * 同时设置CPU亲和性和首选内存节点，析构时恢复原亲和性和原内存策略（含之前的绑定）。
+ * 在此作用域内创建的线程（ORT线程池、FFmpeg编解码线程）继承亲和性，
+ * 分配并首次写入的内存落在该节点上。nodeId < 0 时不做任何事
+ */
+class ScopedNumaBinding {
+public:
+    explicit ScopedNumaBinding(int nodeId);
+    ~ScopedNumaBinding();
+
+    ScopedNumaBinding(const ScopedNumaBinding&) = delete;
+    ScopedNumaBinding& operator=(const ScopedNumaBinding&) = delete;
+
+    bool isActive() const { return affinitySet_; }
+
+private:
+    cpu_set_t previousAffinity_;
+    int previousPolicy_ = 0;                    // 绑定前的内存策略（含模式标志）
+    std::vector<unsigned long> previousNodes_;  // 绑定前策略的节点掩码
+    bool affinitySet_ = false;
+    bool memPolicySet_ = false;
+};
+
+#endif // CPU_TOPOLOGY_H
@@ -3,6 +3,10 @@
 #include <iomanip>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <ctime>
+#include <cstdarg>
+#include <vector>
 
 Logger& Logger::getInstance() {
     static Logger instance;
@@ -10,20 +14,20 @@ Logger& Logger::getInstance() {
 }
 
 Logger::Logger() 
-    : m_minLevel(LogLevel::INFO)
+    : m_minLevel(static_cast<int>(LogLevel::INFO))
     , m_logToFile(false)
     , m_logToConsole(true) {
 }
 
 Logger::~Logger() {
+    stopWriter();
     if (m_fileStream.is_open()) {
         m_fileStream.close();
     }
 }
 
 void Logger::setLogLevel(LogLevel level) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_minLevel = level;
+    m_minLevel.store(static_cast<int>(level), std::memory_order_relaxed);
 }
 
 void Logger::setLogToFile(bool enable, const std::string& filename) {
@@ -50,15 +54,352 @@ void Logger::setLogToConsole(bool enable) {
     m_logToConsole = enable;
 }
 
+void Logger::setAsync(bool enable, size_t ringCapacity) {
+    std::lock_guard<std::mutex> configLock(m_asyncMutex);
+    m_ringCapacity.store(std::max<size_t>(1, ringCapacity), std::memory_order_relaxed);
+    if (enable == m_async.load(std::memory_order_relaxed)) {
+        return;
+    }
+    
+    if (enable) {
+        {
+            std::lock_guard<std::mutex> lock(m_writerMutex);
+            m_stopWriter = false;
+        }
+        m_writer = std::thread(&Logger::writerLoop, this);
+        m_async.store(true, std::memory_order_release);
+    } else {
+        // 先切回同步，再让写线程输出剩余记录后退出
+        m_async.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(m_writerMutex);
+            m_stopWriter = true;
+        }
+        m_writerCv.notify_one();
+        m_writer.join();
+        drain();
+    }
+}
+
+void Logger::stopWriter() {
+    setAsync(false, m_ringCapacity.load(std::memory_order_relaxed));
+}
+
+void Logger::flush() {
+    if (m_async.load(std::memory_order_acquire)) {
+        drain();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_logToConsole) {
+        std::cout.flush();
+    }
+    if (m_logToFile && m_fileStream.is_open()) {
+        m_fileStream.flush();
+    }
+    if (m_binaryStream.is_open()) {
+        m_binaryStream.flush();
+    }
+}
+
 void Logger::log(LogLevel level, const std::string& message, const char* file, int line) {
-    if (level < m_minLevel) {
+    if (!isEnabled(level)) {
+        return;
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    if (!m_async.load(std::memory_order_acquire)) {
+        write(level, now, file, line, message);
+        if (!m_binary.load(std::memory_order_relaxed)) {
+            flush();
+        }
         return;
     }
     
+    Ring& ring = currentRing();
+    while (true) {
+        if (Record* slot = reserveSlot(ring)) {
+            slot->level = level;
+            slot->time = now;
+            slot->formatId = 0;
+            slot->file = file;
+            slot->line = line;
+            slot->message.assign(message);
+            commitSlot(ring);
+            return;
+        }
+        if (!waitForSlot(level)) {
+            return;
+        }
+    }
+}
+
+bool Logger::waitForSlot(LogLevel level) {
+    if (level < LogLevel::WARNING) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_writerCv.notify_one();
+    std::this_thread::yield();
+    return true;
+}
+
+Logger::Ring& Logger::currentRing() {
+    // 线程退出时标记缓冲区，写线程读空后回收，避免短命线程（std::async）累积缓冲区
+    struct RingHolder {
+        std::shared_ptr<Ring> ring;
+        ~RingHolder() {
+            if (ring) {
+                ring->orphaned.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local RingHolder holder;
+    
+    if (!holder.ring) {
+        holder.ring = std::make_shared<Ring>(m_ringCapacity.load(std::memory_order_relaxed));
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        m_rings.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+Logger::Record* Logger::reserveSlot(Ring& ring) {
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    size_t head = ring.head.load(std::memory_order_acquire);
+    if (tail - head >= ring.slots.size()) {
+        return nullptr;
+    }
+    return &ring.slots[tail % ring.slots.size()];
+}
+
+void Logger::commitSlot(Ring& ring) {
+    size_t tail = ring.tail.load(std::memory_order_relaxed) + 1;
+    ring.tail.store(tail, std::memory_order_release);
+    // 达到半满时提前唤醒写线程，不必等到下一个轮询周期
+    if (tail - ring.head.load(std::memory_order_relaxed) == ring.slots.size() / 2) {
+        m_writerCv.notify_one();
+    }
+}
+
+void Logger::writerLoop() {
+    std::unique_lock<std::mutex> lock(m_writerMutex);
+    while (!m_stopWriter) {
+        m_writerCv.wait_for(lock, std::chrono::milliseconds(5));
+        lock.unlock();
+        if (drain() > 0) {
+            std::lock_guard<std::mutex> outputLock(m_mutex);
+            if (m_logToConsole) {
+                std::cout.flush();
+            }
+            if (m_logToFile && m_fileStream.is_open()) {
+                m_fileStream.flush();
+            }
+            if (m_binaryStream.is_open()) {
+                m_binaryStream.flush();
+            }
+        }
+        lock.lock();
+    }
+}
+
+size_t Logger::drain() {
+    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+    
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        rings = m_rings;
+    }
+    
+    // 二进制模式直接从槽位写出，不复制不排序（每条记录自带时间戳）；
+    // 文本模式复制后按时间合并。复制而非移动：槽位保留字符串容量供生产者复用
+    const bool binary = m_binary.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> formatsLock(m_formatsMutex, std::defer_lock);
+    std::unique_lock<std::mutex> outputLock(m_mutex, std::defer_lock);
+    if (binary) {
+        formatsLock.lock();
+        outputLock.lock();
+    }
+    
+    std::vector<Record> batch;
+    std::vector<Ring*> finished;
+    size_t written = 0;
+    for (const auto& ring : rings) {
+        // 先读退出标记：为true时tail已是最终值
+        bool orphaned = ring->orphaned.load(std::memory_order_acquire);
+        size_t head = ring->head.load(std::memory_order_relaxed);
+        size_t tail = ring->tail.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            const Record& record = ring->slots[head % ring->slots.size()];
+            if (binary) {
+                writeRecordLocked(record);
+                ++written;
+            } else {
+                batch.push_back(record);
+            }
+        }
+        ring->head.store(head, std::memory_order_release);
+        if (orphaned) {
+            finished.push_back(ring.get());
+        }
+    }
+    if (binary) {
+        outputLock.unlock();
+        formatsLock.unlock();
+    }
+    
+    if (!finished.empty()) {
+        std::lock_guard<std::mutex> lock(m_ringsMutex);
+        m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(),
+                                     [&finished](const std::shared_ptr<Ring>& ring) {
+                                         return std::find(finished.begin(), finished.end(), ring.get()) != finished.end();
+                                     }),
+                      m_rings.end());
+    }
+    
+    // 各线程缓冲区内部有序，合并后按时间排序输出
+    std::stable_sort(batch.begin(), batch.end(), [](const Record& a, const Record& b) {
+        return a.time < b.time;
+    });
+    for (const auto& record : batch) {
+        std::lock_guard<std::mutex> lock(m_formatsMutex);
+        std::lock_guard<std::mutex> outputLock(m_mutex);
+        writeRecordLocked(record);
+    }
+    return written + batch.size();
+}
+
+void Logger::writeRecordLocked(const Record& record) {
+    if (record.formatId != 0) {
+        writeEventLocked(record.level, record.formatId, record.time, record.message);
+    } else {
+        writeLocked(record.level, record.time, record.file, record.line, record.message);
+    }
+}
+
+void Logger::write(LogLevel level, std::chrono::system_clock::time_point time,
+                   const char* file, int line, const std::string& message) {
     std::lock_guard<std::mutex> lock(m_mutex);
+    writeLocked(level, time, file, line, message);
+}
+
+void Logger::writeLocked(LogLevel level, std::chrono::system_clock::time_point time,
+                         const char* file, int line, const std::string& message) {
+    if (m_binaryStream.is_open()) {
+        const char* fileName = file ? file : "";
+        m_binaryStream.put(static_cast<char>(BinaryRecord::Text));
+        m_binaryStream.put(static_cast<char>(level));
+        int64_t timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+        uint32_t lineValue = static_cast<uint32_t>(line);
+        uint32_t fileSize = static_cast<uint32_t>(strlen(fileName));
+        uint32_t messageSize = static_cast<uint32_t>(message.size());
+        m_binaryStream.write(reinterpret_cast<const char*>(&timeNs), sizeof(timeNs));
+        m_binaryStream.write(reinterpret_cast<const char*>(&lineValue), sizeof(lineValue));
+        m_binaryStream.write(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+        m_binaryStream.write(fileName, fileSize);
+        m_binaryStream.write(reinterpret_cast<const char*>(&messageSize), sizeof(messageSize));
+        m_binaryStream.write(message.data(), messageSize);
+        
+        // 二进制模式下控制台仍显示警告和错误
+        if (m_logToConsole && level >= LogLevel::WARNING) {
+            std::cout << formatLine(level, time, file, line, message) << '\n';
+        }
+        return;
+    }
+    
+    std::string formattedMessage = formatLine(level, time, file, line, message);
+    if (m_logToConsole) {
+        std::cout << formattedMessage << '\n';
+    }
     
-    std::string timestamp = getCurrentTimestamp();
-    std::string levelStr = levelToString(level);
+    if (m_logToFile && m_fileStream.is_open()) {
+        m_fileStream << formattedMessage << '\n';
+    }
+}
+
+void Logger::writeEvent(LogLevel level, uint32_t formatId, std::chrono::system_clock::time_point time,
+                        const std::string& payload) {
+    std::lock_guard<std::mutex> formatsLock(m_formatsMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    writeEventLocked(level, formatId, time, payload);
+}
+
+void Logger::writeEventLocked(LogLevel level, uint32_t formatId, std::chrono::system_clock::time_point time,
+                              const std::string& payload) {
+    if (!m_binaryStream.is_open() || formatId == 0 || formatId > m_formats.size()) {
+        return;
+    }
+    int64_t timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    uint32_t payloadSize = static_cast<uint32_t>(payload.size());
+    m_binaryStream.put(static_cast<char>(BinaryRecord::Event));
+    m_binaryStream.write(reinterpret_cast<const char*>(&formatId), sizeof(formatId));
+    m_binaryStream.write(reinterpret_cast<const char*>(&timeNs), sizeof(timeNs));
+    m_binaryStream.write(reinterpret_cast<const char*>(&payloadSize), sizeof(payloadSize));
+    m_binaryStream.write(payload.data(), payloadSize);
+    
+    if (m_logToConsole && level >= LogLevel::WARNING) {
+        const FormatInfo& info = m_formats[formatId - 1];
+        std::cout << formatLine(level, time, info.file, info.line,
+                                formatPayload(info.format, payload.data(), payload.size())) << '\n';
+    }
+}
+
+bool Logger::setBinaryOutput(const std::string& path) {
+    // 先输出缓冲中的记录，确保它们写入切换前的目标
+    flush();
+    
+    std::lock_guard<std::mutex> formatsLock(m_formatsMutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_binaryStream.is_open()) {
+        m_binaryStream.close();
+    }
+    m_binary.store(false, std::memory_order_release);
+    if (path.empty()) {
+        return true;
+    }
+    
+    m_binaryStream.open(path, std::ios::binary | std::ios::trunc);
+    if (!m_binaryStream.is_open()) {
+        std::cerr << "Failed to open binary log file: " << path << std::endl;
+        return false;
+    }
+    m_binaryStream.write(kBinaryMagic, sizeof(kBinaryMagic));
+    // 已注册的格式先写入，保证之后的Event都能解码
+    for (size_t i = 0; i < m_formats.size(); ++i) {
+        writeFormatLocked(static_cast<uint32_t>(i + 1), m_formats[i]);
+    }
+    m_binary.store(true, std::memory_order_release);
+    return true;
+}
+
+uint32_t Logger::registerFormat(LogLevel level, const char* file, int line, const char* format) {
+    std::lock_guard<std::mutex> formatsLock(m_formatsMutex);
+    m_formats.push_back(FormatInfo{level, file ? file : "", line, format ? format : ""});
+    uint32_t id = static_cast<uint32_t>(m_formats.size());
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_binaryStream.is_open()) {
+        writeFormatLocked(id, m_formats.back());
+    }
+    return id;
+}
+
+void Logger::writeFormatLocked(uint32_t id, const FormatInfo& info) {
+    uint32_t lineValue = static_cast<uint32_t>(info.line);
+    uint32_t fileSize = static_cast<uint32_t>(strlen(info.file));
+    uint32_t formatSize = static_cast<uint32_t>(strlen(info.format));
+    m_binaryStream.put(static_cast<char>(BinaryRecord::Format));
+    m_binaryStream.write(reinterpret_cast<const char*>(&id), sizeof(id));
+    m_binaryStream.put(static_cast<char>(info.level));
+    m_binaryStream.write(reinterpret_cast<const char*>(&lineValue), sizeof(lineValue));
+    m_binaryStream.write(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+    m_binaryStream.write(info.file, fileSize);
+    m_binaryStream.write(reinterpret_cast<const char*>(&formatSize), sizeof(formatSize));
+    m_binaryStream.write(info.format, formatSize);
+}
+
+std::string Logger::formatLine(LogLevel level, std::chrono::system_clock::time_point time,
+                               const char* file, int line, const std::string& message) {
     std::string location = "";
     
     // 如果提供了文件名和行号，添加位置信息
@@ -73,16 +414,168 @@ void Logger::log(LogLevel level, const std::string& message, const char* file, i
         location = " [" + std::string(filename) + ":" + std::to_string(line) + "]";
     }
     
-    std::string formattedMessage = "[" + timestamp + "] [" + levelStr + "]" + location + " " + message;
+    return "[" + formatTimestamp(time) + "] [" + levelToString(level) + "]" + location + " " + message;
+}
+
+std::string Logger::formatText(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list copy;
+    va_copy(copy, args);
+    int size = vsnprintf(nullptr, 0, format, copy);
+    va_end(copy);
     
-    if (m_logToConsole) {
-        std::cout << formattedMessage << std::endl;
+    std::string text;
+    if (size > 0) {
+        text.resize(static_cast<size_t>(size) + 1);
+        vsnprintf(&text[0], text.size(), format, args);
+        text.resize(static_cast<size_t>(size));
     }
+    va_end(args);
+    return text;
+}
+
+namespace {
+
+// 按单个printf转换说明格式化一个值
+template <typename T>
+void appendFormatted(std::string& out, const std::string& spec, T value) {
+    char buffer[128];
+    int size = snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+    if (size < 0) {
+        return;
+    }
+    if (static_cast<size_t>(size) < sizeof(buffer)) {
+        out.append(buffer, static_cast<size_t>(size));
+    } else {
+        std::vector<char> large(static_cast<size_t>(size) + 1);
+        snprintf(large.data(), large.size(), spec.c_str(), value);
+        out.append(large.data(), static_cast<size_t>(size));
+    }
+}
+
+} // namespace
+
+std::string Logger::formatPayload(const char* format, const char* payload, size_t size) {
+    std::string out;
+    size_t offset = 0;
     
-    if (m_logToFile && m_fileStream.is_open()) {
-        m_fileStream << formattedMessage << std::endl;
-        m_fileStream.flush();
+    auto readRaw = [&](void* value, size_t bytes) {
+        if (offset + bytes > size) {
+            offset = size;
+            return false;
+        }
+        memcpy(value, payload + offset, bytes);
+        offset += bytes;
+        return true;
+    };
+    
+    for (const char* p = format ? format : ""; *p; ++p) {
+        if (*p != '%') {
+            out.push_back(*p);
+            continue;
+        }
+        if (p[1] == '%') {
+            out.push_back('%');
+            ++p;
+            continue;
+        }
+        
+        // 解析 %[flags][width][.precision][length]conversion，长度修饰按参数实际类型重写
+        std::string flags = "%";
+        const char* q = p + 1;
+        while (*q && strchr("-+ #0123456789.", *q)) {
+            flags.push_back(*q++);
+        }
+        while (*q && strchr("hlLqjzt", *q)) {
+            ++q;
+        }
+        char conversion = *q;
+        if (!conversion) {
+            out.append(p);
+            break;
+        }
+        p = q;
+        
+        uint8_t tag = 0;
+        if (!readRaw(&tag, sizeof(tag))) {
+            out += "<missing>";
+            continue;
+        }
+        
+        int64_t intValue = 0;
+        uint64_t uintValue = 0;
+        double doubleValue = 0.0;
+        std::string stringValue;
+        bool ok = true;
+        switch (static_cast<ArgTag>(tag)) {
+            case ArgTag::Int:
+                ok = readRaw(&intValue, sizeof(intValue));
+                uintValue = static_cast<uint64_t>(intValue);
+                doubleValue = static_cast<double>(intValue);
+                stringValue = std::to_string(intValue);
+                break;
+            case ArgTag::UInt:
+            case ArgTag::Pointer:
+                ok = readRaw(&uintValue, sizeof(uintValue));
+                intValue = static_cast<int64_t>(uintValue);
+                doubleValue = static_cast<double>(uintValue);
+                stringValue = std::to_string(uintValue);
+                break;
+            case ArgTag::Double:
+                ok = readRaw(&doubleValue, sizeof(doubleValue));
+                intValue = static_cast<int64_t>(doubleValue);
+                uintValue = static_cast<uint64_t>(intValue);
+                stringValue = std::to_string(doubleValue);
+                break;
+            case ArgTag::String: {
+                uint32_t length = 0;
+                ok = readRaw(&length, sizeof(length)) && offset + length <= size;
+                if (ok) {
+                    stringValue.assign(payload + offset, length);
+                    offset += length;
+                }
+                break;
+            }
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok) {
+            out += "<corrupt>";
+            break;
+        }
+        
+        bool isString = static_cast<ArgTag>(tag) == ArgTag::String;
+        switch (conversion) {
+            case 'd': case 'i':
+                if (isString) { out += stringValue; break; }
+                appendFormatted(out, flags + "lld", static_cast<long long>(intValue));
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                if (isString) { out += stringValue; break; }
+                appendFormatted(out, flags + "ll" + conversion, static_cast<unsigned long long>(uintValue));
+                break;
+            case 'c':
+                if (isString) { out += stringValue; break; }
+                appendFormatted(out, flags + "c", static_cast<int>(intValue));
+                break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+                if (isString) { out += stringValue; break; }
+                appendFormatted(out, flags + conversion, doubleValue);
+                break;
+            case 'p':
+                appendFormatted(out, flags + "p", reinterpret_cast<void*>(static_cast<uintptr_t>(uintValue)));
+                break;
+            case 's':
+                appendFormatted(out, flags + "s", stringValue.c_str());
+                break;
+            default:
+                out += stringValue;
+                break;
+        }
     }
+    return out;
 }
 
 void Logger::debug(const std::string& message, const char* file, int line) {
@@ -105,19 +598,21 @@ void Logger::critical(const std::string& message, const char* file, int line) {
     log(LogLevel::CRITICAL, message, file, line);
 }
 
-std::string Logger::getCurrentTimestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
+std::string Logger::formatTimestamp(std::chrono::system_clock::time_point time) {
+    auto time_t = std::chrono::system_clock::to_time_t(time);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+        time.time_since_epoch()) % 1000;
+    
+    std::tm localTime{};
+    localtime_r(&time_t, &localTime);
     
     std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
+    ss << std::put_time(&localTime, "%Y-%m-%d %H:%M:%S");
     ss << '.' << std::setfill('0') << std::setw(3) << ms.count();
     return ss.str();
 }
 
-std::string Logger::levelToString(LogLevel level) const {
+std::string Logger::levelToString(LogLevel level) {
     switch (level) {
         case LogLevel::DEBUG:    return "DEBUG";
         case LogLevel::INFO:     return "INFO";
@@ -6,13 +6,54 @@
 #include <mutex>
 #include <memory>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+// 编译期最低日志级别（0=DEBUG ... 4=CRITICAL），低于该级别的日志语句整体被编译器消除
+// 例如 Release 构建可定义 VIDEOSR_LOG_MIN_LEVEL=1 去掉全部 LOG_DEBUG
+#ifndef VIDEOSR_LOG_MIN_LEVEL
+#define VIDEOSR_LOG_MIN_LEVEL 0
+#endif
+
+// 先检查级别再求值消息参数：级别关闭时不会构造字符串（std::to_string等）
+#define LOG_AT_LEVEL(level, msg)                                                        \
+    do {                                                                                \
+        if (static_cast<int>(level) >= VIDEOSR_LOG_MIN_LEVEL &&                         \
+            Logger::getInstance().isEnabled(level)) {                                   \
+            Logger::getInstance().log(level, msg, __FILE__, __LINE__);                  \
+        }                                                                               \
+    } while (0)
 
 // 便捷的日志宏定义，自动包含文件名和行号
-#define LOG_DEBUG(msg) Logger::getInstance().debug(msg, __FILE__, __LINE__)
-#define LOG_INFO(msg) Logger::getInstance().info(msg, __FILE__, __LINE__)
-#define LOG_WARNING(msg) Logger::getInstance().warning(msg, __FILE__, __LINE__)
-#define LOG_ERROR(msg) Logger::getInstance().error(msg, __FILE__, __LINE__)
-#define LOG_CRITICAL(msg) Logger::getInstance().critical(msg, __FILE__, __LINE__)
+#define LOG_DEBUG(msg) LOG_AT_LEVEL(Logger::LogLevel::DEBUG, msg)
+#define LOG_INFO(msg) LOG_AT_LEVEL(Logger::LogLevel::INFO, msg)
+#define LOG_WARNING(msg) LOG_AT_LEVEL(Logger::LogLevel::WARNING, msg)
+#define LOG_ERROR(msg) LOG_AT_LEVEL(Logger::LogLevel::ERROR, msg)
+#define LOG_CRITICAL(msg) LOG_AT_LEVEL(Logger::LogLevel::CRITICAL, msg)
+
+// printf风格的结构化日志：fmt须为字符串字面量，每个调用点首次执行时注册一个格式ID。
+// 二进制模式下只记录格式ID和原始参数，由 log_decode 离线还原为文本；否则按fmt格式化输出
+#define LOGF_AT_LEVEL(level, fmt, ...)                                                  \
+    do {                                                                                \
+        if (static_cast<int>(level) >= VIDEOSR_LOG_MIN_LEVEL &&                         \
+            Logger::getInstance().isEnabled(level)) {                                   \
+            static const uint32_t logFormatId_ =                                        \
+                Logger::getInstance().registerFormat(level, __FILE__, __LINE__, fmt);   \
+            Logger::getInstance().logFormat(level, logFormatId_, fmt, __FILE__, __LINE__, ##__VA_ARGS__); \
+        }                                                                               \
+    } while (0)
+
+#define LOGF_DEBUG(fmt, ...) LOGF_AT_LEVEL(Logger::LogLevel::DEBUG, fmt, ##__VA_ARGS__)
+#define LOGF_INFO(fmt, ...) LOGF_AT_LEVEL(Logger::LogLevel::INFO, fmt, ##__VA_ARGS__)
+#define LOGF_WARNING(fmt, ...) LOGF_AT_LEVEL(Logger::LogLevel::WARNING, fmt, ##__VA_ARGS__)
+#define LOGF_ERROR(fmt, ...) LOGF_AT_LEVEL(Logger::LogLevel::ERROR, fmt, ##__VA_ARGS__)
+#define LOGF_CRITICAL(fmt, ...) LOGF_AT_LEVEL(Logger::LogLevel::CRITICAL, fmt, ##__VA_ARGS__)
 
 class Logger {
 public:
@@ -24,6 +65,31 @@ public:
         CRITICAL = 4
     };
 
+    /**
+     * @brief 二进制日志文件格式（本机字节序）
+     * 文件头为8字节kBinaryMagic，之后是连续的记录，每条以1字节BinaryRecord开头：
+     * - Format: u32 id, u8 level, u32 line, str file, str format
+     * - Event:  u32 id, i64 时间(ns, Unix纪元), u32 负载长度, 负载（参数序列）
+     * - Text:   u8 level, i64 时间, u32 line, str file, str message（LOG_*宏的文本日志）
+     * 参数为1字节ArgTag加值：Int/UInt/Pointer为8字节，Double为8字节，String为str。
+     * str 为 u32 长度加字节内容。Format记录总是先于引用它的Event
+     */
+    static constexpr char kBinaryMagic[8] = {'V', 'S', 'R', 'L', 'O', 'G', '0', '1'};
+
+    enum class BinaryRecord : uint8_t {
+        Format = 1,
+        Event = 2,
+        Text = 3
+    };
+
+    enum class ArgTag : uint8_t {
+        Int = 1,
+        UInt = 2,
+        Double = 3,
+        String = 4,
+        Pointer = 5
+    };
+
     // 获取单例实例
     static Logger& getInstance();
 
@@ -33,9 +99,14 @@ public:
 
     // 设置日志级别
     void setLogLevel(LogLevel level);
-    
+
     // 获取当前日志级别
-    LogLevel getLogLevel() const { return m_minLevel; }
+    LogLevel getLogLevel() const { return static_cast<LogLevel>(m_minLevel.load(std::memory_order_relaxed)); }
+
+    // 该级别的日志是否会输出（日志宏在求值参数前调用）
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= m_minLevel.load(std::memory_order_relaxed);
+    }
 
     // 设置是否输出到文件
     void setLogToFile(bool enable, const std::string& filename = "");
@@ -43,6 +114,92 @@ public:
     // 设置是否输出到控制台
     void setLogToConsole(bool enable);
 
+    /**
+     * @brief 开启/关闭异步模式
+     * 异步模式下调用线程只把日志记录写入本线程的无锁环形缓冲区（单生产者单消费者），
+     * 由后台写线程负责格式化和输出。缓冲区满时DEBUG/INFO被丢弃并计数，
+     * WARNING及以上等待写线程腾出空间，保证错误日志不丢失
+     * @param ringCapacity 每个线程环形缓冲区的记录数
+     */
+    void setAsync(bool enable, size_t ringCapacity = 1024);
+    bool isAsync() const { return m_async.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 输出所有已缓冲的日志（异步模式下阻塞到写完为止）
+     */
+    void flush();
+
+    // 因缓冲区满而丢弃的日志条数
+    uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 开启二进制日志，所有日志写入path（覆盖），传空字符串关闭
+     * 二进制模式下文本文件输出暂停，控制台只输出WARNING及以上，完整日志用 log_decode 查看
+     * @return 是否成功打开文件
+     */
+    bool setBinaryOutput(const std::string& path);
+    bool isBinary() const { return m_binary.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 按文本日志的行格式输出：[时间] [级别] [文件:行] 消息
+     */
+    static std::string formatLine(LogLevel level, std::chrono::system_clock::time_point time,
+                                  const char* file, int line, const std::string& message);
+
+    /**
+     * @brief 用printf格式和二进制参数序列还原日志文本（log_decode 与控制台回显共用）
+     * 长度修饰按参数实际类型处理，参数缺失或损坏时在文本中标注
+     */
+    static std::string formatPayload(const char* format, const char* payload, size_t size);
+
+    static std::string levelToString(LogLevel level);
+
+    /**
+     * @brief 注册LOGF_*调用点的格式，返回格式ID（由宏在静态局部变量中缓存）
+     */
+    uint32_t registerFormat(LogLevel level, const char* file, int line, const char* format);
+
+    /**
+     * @brief LOGF_*宏的实现：二进制模式下编码原始参数，否则按format格式化为文本
+     */
+    template <typename... Args>
+    void logFormat(LogLevel level, uint32_t formatId, const char* format,
+                   const char* file, int line, const Args&... args) {
+        if (!m_binary.load(std::memory_order_acquire)) {
+            log(level, formatText(format, printfArg(args)...), file, line);
+            return;
+        }
+
+        auto encode = [&](std::string& payload) {
+            payload.clear();
+            (appendArg(payload, args), ...);
+        };
+        if (!m_async.load(std::memory_order_acquire)) {
+            std::string payload;
+            encode(payload);
+            writeEvent(level, formatId, std::chrono::system_clock::now(), payload);
+            return;
+        }
+
+        // 直接写入环形缓冲区的槽位，复用槽位字符串的容量，稳定状态下不分配内存
+        Ring& ring = currentRing();
+        while (true) {
+            if (Record* slot = reserveSlot(ring)) {
+                slot->level = level;
+                slot->time = std::chrono::system_clock::now();
+                slot->formatId = formatId;
+                slot->file = file;
+                slot->line = line;
+                encode(slot->message);
+                commitSlot(ring);
+                return;
+            }
+            if (!waitForSlot(level)) {
+                return;
+            }
+        }
+    }
+
     // 记录日志
     void log(LogLevel level, const std::string& message, const char* file = nullptr, int line = 0);
     void debug(const std::string& message, const char* file = nullptr, int line = 0);
@@ -52,18 +209,142 @@ public:
     void critical(const std::string& message, const char* file = nullptr, int line = 0);
 
 private:
+    // 异步模式下缓冲的一条日志，格式化推迟到写线程
+    struct Record {
+        LogLevel level = LogLevel::INFO;
+        std::chrono::system_clock::time_point time;
+        uint32_t formatId = 0;    // 非0时message为LOGF_*的二进制参数
+        const char* file = nullptr;
+        int line = 0;
+        std::string message;
+    };
+
+    struct FormatInfo {
+        LogLevel level;
+        const char* file;
+        int line;
+        const char* format;
+    };
+
+    template <typename T>
+    static void appendRaw(std::string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void appendString(std::string& out, std::string_view text) {
+        appendRaw(out, static_cast<uint32_t>(text.size()));
+        out.append(text.data(), text.size());
+    }
+
+    template <typename T>
+    static void appendArg(std::string& out, const T& value) {
+        using D = std::decay_t<T>;
+        if constexpr (std::is_same_v<D, bool>) {
+            out.push_back(static_cast<char>(ArgTag::Int));
+            appendRaw(out, static_cast<int64_t>(value ? 1 : 0));
+        } else if constexpr (std::is_enum_v<D>) {
+            out.push_back(static_cast<char>(ArgTag::Int));
+            appendRaw(out, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>) {
+            out.push_back(static_cast<char>(ArgTag::Int));
+            appendRaw(out, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<D>) {
+            out.push_back(static_cast<char>(ArgTag::UInt));
+            appendRaw(out, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<D>) {
+            out.push_back(static_cast<char>(ArgTag::Double));
+            appendRaw(out, static_cast<double>(value));
+        } else if constexpr (std::is_array_v<T>) {
+            out.push_back(static_cast<char>(ArgTag::String));
+            appendString(out, std::string_view(value));
+        } else if constexpr (std::is_same_v<D, const char*> || std::is_same_v<D, char*>) {
+            out.push_back(static_cast<char>(ArgTag::String));
+            appendString(out, value ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            out.push_back(static_cast<char>(ArgTag::String));
+            appendString(out, std::string_view(value));
+        } else {
+            static_assert(std::is_pointer_v<D>, "LOGF_* argument must be arithmetic, enum, string or pointer");
+            out.push_back(static_cast<char>(ArgTag::Pointer));
+            appendRaw(out, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+        }
+    }
+
+    // 文本模式下把参数转换为printf可接受的类型
+    template <typename T>
+    static auto printfArg(const T& value) {
+        using D = std::decay_t<T>;
+        if constexpr (std::is_enum_v<D>) {
+            return static_cast<std::underlying_type_t<D>>(value);
+        } else if constexpr (std::is_same_v<D, std::string>) {
+            return value.c_str();
+        } else {
+            return value;
+        }
+    }
+
+    static std::string formatText(const char* format, ...);
+
+    // 单生产者（所属线程）单消费者（持有m_drainMutex的线程）环形缓冲区
+    struct Ring {
+        explicit Ring(size_t capacity) : slots(capacity) {}
+
+        std::vector<Record> slots;
+        std::atomic<size_t> head{0};        // 下一个读取位置（消费者写）
+        std::atomic<size_t> tail{0};        // 下一个写入位置（生产者写）
+        std::atomic<bool> orphaned{false};  // 所属线程已退出，读空后回收
+    };
+
     Logger();
     ~Logger();
 
-    std::string getCurrentTimestamp() const;
-    std::string levelToString(LogLevel level) const;
-    
-    LogLevel m_minLevel;
+    Ring& currentRing();
+    Record* reserveSlot(Ring& ring);
+    void commitSlot(Ring& ring);
+    // 缓冲区满时：DEBUG/INFO计数后返回false（丢弃），更高级别等待写线程后返回true重试
+    bool waitForSlot(LogLevel level);
+    void writerLoop();
+    size_t drain();
+    void write(LogLevel level, std::chrono::system_clock::time_point time,
+               const char* file, int line, const std::string& message);
+    // *Locked 版本要求调用方已按 m_formatsMutex -> m_mutex 的顺序加锁
+    void writeLocked(LogLevel level, std::chrono::system_clock::time_point time,
+                     const char* file, int line, const std::string& message);
+    void writeRecordLocked(const Record& record);
+    void writeEvent(LogLevel level, uint32_t formatId, std::chrono::system_clock::time_point time,
+                    const std::string& payload);
+    void writeEventLocked(LogLevel level, uint32_t formatId, std::chrono::system_clock::time_point time,
+                          const std::string& payload);
+    void writeFormatLocked(uint32_t id, const FormatInfo& info);
+    void stopWriter();
+
+    static std::string formatTimestamp(std::chrono::system_clock::time_point time);
+
+    std::atomic<int> m_minLevel;
     bool m_logToFile;
     bool m_logToConsole;
     std::string m_filename;
     std::ofstream m_fileStream;
-    std::mutex m_mutex;
+    std::mutex m_mutex;  // 保护输出目标
+
+    // 二进制输出
+    std::atomic<bool> m_binary{false};
+    std::ofstream m_binaryStream;
+    std::mutex m_formatsMutex;
+    std::vector<FormatInfo> m_formats;  // 下标+1为格式ID
+
+    // 异步后端
+    std::mutex m_asyncMutex;  // 串行化setAsync
+    std::atomic<bool> m_async{false};
+    std::atomic<size_t> m_ringCapacity{1024};
+    std::atomic<uint64_t> m_dropped{0};
+    std::mutex m_ringsMutex;
+    std::vector<std::shared_ptr<Ring>> m_rings;
+    std::mutex m_drainMutex;  // 同一时刻只有一个消费者
+    std::mutex m_writerMutex;
+    std::condition_variable m_writerCv;
+    bool m_stopWriter = false;
+    std::thread m_writer;
 };
 
 #endif // LOGGER_H
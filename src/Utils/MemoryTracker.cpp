@@ -0,0 +1,325 @@
+#include "MemoryTracker.h"
+#include "Logger.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+namespace {
+// 当前线程所处阶段及已分配字节数（用于统计单次作用域的分配量）
+thread_local MemoryTracker::StageAccount* tlsCurrentAccount = nullptr;
+thread_local uint64_t tlsAllocatedBytes = 0;
+// 本线程嵌套的HeadroomScope层数：只有最外层等待并计入在途帧，避免等待自己
+thread_local int tlsHeadroomDepth = 0;
+
+const char* sourceName(MemoryTracker::Source source) {
+    switch (source) {
+        case MemoryTracker::Source::CvMat: return "cv_mat";
+        case MemoryTracker::Source::Ort: return "ort";
+        case MemoryTracker::Source::FFmpeg: return "ffmpeg";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief 统计用cv::Mat分配器：委托给OpenCV标准分配器，记录缓冲大小
+ * 归属阶段保存在UMatData::userdata中，释放时记回同一阶段
+ */
+class TrackingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        cv::UMatData* u = base()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        if (u) {
+            // 释放时经由本分配器，才能扣减统计
+            u->prevAllocator = u->currAllocator = this;
+            if (!(u->flags & cv::UMatData::USER_ALLOCATED)) {
+                u->userdata = MemoryTracker::getInstance().allocate(MemoryTracker::Source::CvMat, u->size);
+            }
+        }
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return base()->allocate(u, accessFlags, usageFlags);
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (u && u->userdata) {
+            MemoryTracker::getInstance().release(MemoryTracker::Source::CvMat, u->size,
+                                                 static_cast<MemoryTracker::StageAccount*>(u->userdata));
+            u->userdata = nullptr;
+        }
+        base()->deallocate(u);
+    }
+
+private:
+    static cv::MatAllocator* base() { return cv::Mat::getStdAllocator(); }
+};
+} // namespace
+
+// ========== StageScope ==========
+
+MemoryTracker::StageScope::StageScope(const char* stage) {
+    MemoryTracker& tracker = MemoryTracker::getInstance();
+    if (!tracker.isEnabled()) {
+        return;
+    }
+    account_ = tracker.stageAccount(stage);
+    previous_ = tlsCurrentAccount;
+    tlsCurrentAccount = account_;
+    allocatedAtStart_ = tlsAllocatedBytes;
+}
+
+MemoryTracker::StageScope::~StageScope() {
+    if (!account_) {
+        return;
+    }
+    account_->frameBytes->set(static_cast<int64_t>(tlsAllocatedBytes - allocatedAtStart_));
+    tlsCurrentAccount = previous_;
+}
+
+// ========== HeadroomScope ==========
+
+MemoryTracker::HeadroomScope::HeadroomScope() {
+    if (tlsHeadroomDepth++ > 0) {
+        return;
+    }
+    MemoryTracker& tracker = MemoryTracker::getInstance();
+    tracker.waitForHeadroom();
+    tracker.inFlight_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+MemoryTracker::HeadroomScope::~HeadroomScope() {
+    if (--tlsHeadroomDepth > 0) {
+        return;
+    }
+    MemoryTracker& tracker = MemoryTracker::getInstance();
+    tracker.inFlight_.fetch_sub(1, std::memory_order_acq_rel);
+    if (tracker.getCeiling() > 0) {
+        std::lock_guard<std::mutex> lock(tracker.headroomMutex_);
+        tracker.headroomCv_.notify_all();
+    }
+}
+
+// ========== TrackedBuffer ==========
+
+void MemoryTracker::TrackedBuffer::update(size_t bytes) {
+    MemoryTracker& tracker = MemoryTracker::getInstance();
+    if (!account_) {
+        account_ = tracker.allocate(source_, bytes);
+        bytes_ = account_ ? bytes : 0;
+    } else if (bytes > bytes_) {
+        tracker.record(source_, account_, bytes - bytes_);
+        bytes_ = bytes;
+    } else if (bytes < bytes_) {
+        tracker.release(source_, bytes_ - bytes, account_);
+        bytes_ = bytes;
+    }
+}
+
+void MemoryTracker::TrackedBuffer::reset() {
+    if (account_) {
+        MemoryTracker::getInstance().release(source_, bytes_, account_);
+    }
+    account_ = nullptr;
+    bytes_ = 0;
+}
+
+// ========== MemoryTracker ==========
+
+MemoryTracker& MemoryTracker::getInstance() {
+    static MemoryTracker instance;
+    return instance;
+}
+
+MemoryTracker::MemoryTracker()
+    : totalBytes_(MetricsRegistry::getInstance().gauge("mem_total_bytes"))
+    , rssBytes_(MetricsRegistry::getInstance().gauge("mem_rss_bytes")) {
+    for (size_t i = 0; i < sourceBytes_.size(); ++i) {
+        sourceBytes_[i] = &MetricsRegistry::getInstance().gauge(
+            std::string("mem_") + sourceName(static_cast<Source>(i)) + "_bytes");
+    }
+}
+
+void MemoryTracker::setEnabled(bool enabled) {
+    if (enabled_.exchange(enabled) == enabled) {
+        return;
+    }
+    if (enabled) {
+        installMatAllocator();
+    } else {
+        // 恢复标准分配器；已分配的矩阵仍经由统计分配器释放
+        cv::Mat::setDefaultAllocator(nullptr);
+    }
+    LOG_INFO(std::string("Memory tracking ") + (enabled ? "enabled" : "disabled"));
+}
+
+void MemoryTracker::installMatAllocator() {
+    // 有意不释放：静态对象析构后仍可能有矩阵经由它释放
+    static TrackingMatAllocator* allocator = new TrackingMatAllocator();
+    cv::Mat::setDefaultAllocator(allocator);
+}
+
+void MemoryTracker::configureFromEnvironment() {
+    if (const char* tracking = std::getenv("VIDEOSR_MEMORY_TRACKING")) {
+        setEnabled(std::string(tracking) == "1");
+    }
+    if (const char* ceilingMb = std::getenv("VIDEOSR_MEMORY_CEILING_MB")) {
+        long long megabytes = std::atoll(ceilingMb);
+        if (megabytes > 0) {
+            setCeiling(static_cast<size_t>(megabytes) << 20);
+            LOG_INFO("Memory ceiling: " + std::to_string(megabytes) + " MB");
+            // 上限按统计到的占用判断，需要统计开启
+            if (!isEnabled()) {
+                setEnabled(true);
+            }
+        }
+    }
+}
+
+MemoryTracker::StageAccount* MemoryTracker::stageAccount(const std::string& name) {
+    std::lock_guard<std::mutex> lock(accountsMutex_);
+    auto& slot = accounts_[name];
+    if (!slot) {
+        MetricsRegistry& registry = MetricsRegistry::getInstance();
+        std::string prefix = "mem_stage_" + name;
+        slot = std::make_unique<StageAccount>();
+        slot->name = name;
+        slot->bytes = &registry.gauge(prefix + "_bytes");
+        slot->frameBytes = &registry.gauge(prefix + "_frame_bytes");
+        slot->allocated = &registry.counter(prefix + "_alloc_bytes");
+        slot->allocations = &registry.counter(prefix + "_allocs");
+    }
+    return slot.get();
+}
+
+MemoryTracker::StageAccount* MemoryTracker::currentAccount() {
+    if (tlsCurrentAccount) {
+        return tlsCurrentAccount;
+    }
+    // 不在任何阶段作用域内的分配
+    static StageAccount* other = stageAccount("other");
+    return other;
+}
+
+MemoryTracker::StageAccount* MemoryTracker::allocate(Source source, size_t bytes) {
+    if (!isEnabled() || bytes == 0) {
+        return nullptr;
+    }
+    StageAccount* account = currentAccount();
+    record(source, account, bytes);
+    return account;
+}
+
+void MemoryTracker::record(Source source, StageAccount* account, size_t bytes) {
+    int64_t delta = static_cast<int64_t>(bytes);
+    account->bytes->add(delta);
+    account->allocated->add(bytes);
+    account->allocations->add(1);
+    sourceBytes_[static_cast<size_t>(source)]->add(delta);
+    totalBytes_.add(delta);
+    tlsAllocatedBytes += bytes;
+}
+
+void MemoryTracker::release(Source source, size_t bytes, StageAccount* account) {
+    // 未记录的分配（统计关闭期间）不扣减
+    if (!account || bytes == 0) {
+        return;
+    }
+    int64_t delta = -static_cast<int64_t>(bytes);
+    account->bytes->add(delta);
+    sourceBytes_[static_cast<size_t>(source)]->add(delta);
+    totalBytes_.add(delta);
+
+    if (getCeiling() > 0) {
+        headroomCv_.notify_all();
+    }
+}
+
+void MemoryTracker::recordTransient(Source source, size_t bytes) {
+    if (!isEnabled() || bytes == 0) {
+        return;
+    }
+    (void)source;
+    StageAccount* account = currentAccount();
+    account->allocated->add(bytes);
+    account->allocations->add(1);
+    tlsAllocatedBytes += bytes;
+}
+
+size_t MemoryTracker::currentBytes() const {
+    return static_cast<size_t>(std::max<int64_t>(0, totalBytes_.value()));
+}
+
+size_t MemoryTracker::throttledBytes() const {
+    // ORT的RSS估计含共享映射的权重、预热缓冲和其他线程的分配，且无法释放，不参与上限判断
+    int64_t ortBytes = sourceBytes_[static_cast<size_t>(Source::Ort)]->value();
+    return static_cast<size_t>(std::max<int64_t>(0, totalBytes_.value() - ortBytes));
+}
+
+size_t MemoryTracker::peakBytes() const {
+    return static_cast<size_t>(std::max<int64_t>(0, totalBytes_.max()));
+}
+
+size_t MemoryTracker::currentRssBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages)) {
+        return 0;
+    }
+    return residentPages * static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+}
+
+bool MemoryTracker::isOverCeiling() const {
+    size_t ceiling = getCeiling();
+    if (ceiling == 0 || !isEnabled()) {
+        return false;
+    }
+    return throttledBytes() > ceiling;
+}
+
+bool MemoryTracker::waitForHeadroom() {
+    // 没有其他在途帧时能释放内存的只有调用者自己，等待只会空耗到超时
+    if (!isOverCeiling() || inFlightFrames() == 0) {
+        return true;
+    }
+
+    METRICS_COUNTER_ADD("mem_throttle_waits", 1);
+    METRICS_SCOPED_TIMER("mem_throttle_wait_us");
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(throttleTimeoutMs_.load(std::memory_order_relaxed));
+
+    std::unique_lock<std::mutex> lock(headroomMutex_);
+    while (isOverCeiling() && inFlightFrames() > 0) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            size_t rss = currentRssBytes();
+            rssBytes_.set(static_cast<int64_t>(rss));
+            METRICS_COUNTER_ADD("mem_throttle_timeouts", 1);
+            LOG_WARNING("Memory ceiling exceeded (tracked " + std::to_string(throttledBytes() >> 20) + " MB, rss " +
+                        std::to_string(rss >> 20) + " MB), continuing after throttle timeout");
+            return false;
+        }
+        // 释放和在途帧结束都会唤醒；定期复查以防唤醒发生在检查与等待之间
+        headroomCv_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+std::vector<MemoryTracker::StageStats> MemoryTracker::getStageStats() const {
+    std::lock_guard<std::mutex> lock(accountsMutex_);
+    std::vector<StageStats> stats;
+    for (const auto& [name, account] : accounts_) {
+        StageStats stage;
+        stage.stage = name;
+        stage.currentBytes = account->bytes->value();
+        stage.peakBytes = account->bytes->max();
+        stage.allocatedBytes = account->allocated->value();
+        stage.allocations = account->allocations->value();
+        stage.peakFrameBytes = account->frameBytes->max();
+        stats.push_back(stage);
+    }
+    return stats;
+}
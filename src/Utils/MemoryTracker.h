@@ -0,0 +1,226 @@
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include "Metrics.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 内存分配统计与内存上限节流
+ *
+ * 检测模式下（setEnabled(true) 或环境变量 VIDEOSR_MEMORY_TRACKING=1）统计三类内存：
+ * - cv::Mat：替换OpenCV默认分配器，精确记录每块矩阵缓冲
+ * - ORT：ONNX Runtime 1.15 没有arena统计接口，按会话创建和首次推理时的RSS增长近似
+ * - FFmpeg：解码器持有的帧缓冲、编码器的输入帧缓冲，以及收发包的字节数
+ *
+ * 分配按当前线程所处的流水线阶段（MEMORY_STAGE_SCOPE）归属，结果写入MetricsRegistry：
+ * mem_<source>_bytes / mem_stage_<stage>_bytes 仪表的max即峰值，
+ * mem_stage_<stage>_frame_bytes 为该阶段单次调用（即每帧）分配的字节数。
+ *
+ * 设置内存上限（setCeiling 或 VIDEOSR_MEMORY_CEILING_MB）后，统计到的在途占用超限时
+ * HeadroomScope 阻塞等待其他在途帧释放内存，流水线据此降低并发而不是被OOM杀死。
+ * 节流按统计量而不是RSS判断：RSS在释放后几乎不回落，超过一次就会让每帧都等满超时。
+ * 同理ORT一项本身是RSS估计（含共享映射的权重），只作报告，不计入上限判断。
+ * 没有其他在途帧时不等待——此时能释放内存的只有调用者自己
+ */
+class MemoryTracker {
+public:
+    enum class Source {
+        CvMat = 0,   // cv::Mat缓冲
+        Ort = 1,     // ONNX Runtime（会话权重与推理arena，RSS估计，不参与上限判断）
+        FFmpeg = 2,  // AVFrame/AVPacket缓冲
+        Count
+    };
+
+    /**
+     * @brief 单个阶段的分配统计
+     */
+    struct StageAccount {
+        std::string name;
+        MetricsRegistry::Gauge* bytes = nullptr;        // 当前占用（max为峰值）
+        MetricsRegistry::Gauge* frameBytes = nullptr;   // 单次作用域内分配量（max为最大单帧）
+        MetricsRegistry::Counter* allocated = nullptr;  // 累计分配字节
+        MetricsRegistry::Counter* allocations = nullptr; // 累计分配次数
+    };
+
+    struct StageStats {
+        std::string stage;
+        int64_t currentBytes = 0;
+        int64_t peakBytes = 0;
+        uint64_t allocatedBytes = 0;
+        uint64_t allocations = 0;
+        int64_t peakFrameBytes = 0;
+    };
+
+    /**
+     * @brief 阶段作用域：作用域内本线程的分配归属到该阶段
+     */
+    class StageScope {
+    public:
+        explicit StageScope(const char* stage);
+        ~StageScope();
+
+        StageScope(const StageScope&) = delete;
+        StageScope& operator=(const StageScope&) = delete;
+
+    private:
+        StageAccount* account_ = nullptr;
+        StageAccount* previous_ = nullptr;
+        uint64_t allocatedAtStart_ = 0;
+    };
+
+    /**
+     * @brief 在途帧作用域：构造时等待内存余量（waitForHeadroom），析构时唤醒等待者
+     * 同一线程嵌套时只有最外层等待和计数
+     */
+    class HeadroomScope {
+    public:
+        HeadroomScope();
+        ~HeadroomScope();
+
+        HeadroomScope(const HeadroomScope&) = delete;
+        HeadroomScope& operator=(const HeadroomScope&) = delete;
+    };
+
+    /**
+     * @brief 常驻缓冲的统计句柄：大小变化时更新，析构时释放
+     * 记录时的阶段保存在句柄中，释放总是记回同一阶段
+     */
+    class TrackedBuffer {
+    public:
+        explicit TrackedBuffer(Source source) : source_(source) {}
+        ~TrackedBuffer() { reset(); }
+
+        TrackedBuffer(const TrackedBuffer&) = delete;
+        TrackedBuffer& operator=(const TrackedBuffer&) = delete;
+
+        /**
+         * @brief 将登记大小改为bytes（未启用统计时忽略）
+         */
+        void update(size_t bytes);
+        void reset();
+        size_t bytes() const { return bytes_; }
+
+    private:
+        Source source_;
+        size_t bytes_ = 0;
+        StageAccount* account_ = nullptr;
+    };
+
+    static MemoryTracker& getInstance();
+
+    MemoryTracker(const MemoryTracker&) = delete;
+    MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+    /**
+     * @brief 开启/关闭统计；开启时安装cv::Mat统计分配器
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 设置内存上限（字节，0表示不限制），按throttledBytes()判断，需开启统计
+     */
+    void setCeiling(size_t bytes) { ceiling_.store(bytes, std::memory_order_relaxed); }
+    size_t getCeiling() const { return ceiling_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 超限时最长等待时间，超时后放行以免死锁
+     */
+    void setThrottleTimeout(std::chrono::milliseconds timeout) { throttleTimeoutMs_.store(timeout.count()); }
+
+    /**
+     * @brief 从环境变量读取配置：VIDEOSR_MEMORY_TRACKING=1、VIDEOSR_MEMORY_CEILING_MB=<MB>
+     */
+    void configureFromEnvironment();
+
+    // 记录分配/释放，归属到当前线程的阶段；返回归属的阶段供释放时使用
+    StageAccount* allocate(Source source, size_t bytes);
+    void release(Source source, size_t bytes, StageAccount* account);
+
+    /**
+     * @brief 记录瞬时缓冲（如编码包）：计入累计分配量，不计入当前占用
+     */
+    void recordTransient(Source source, size_t bytes);
+
+    size_t currentBytes() const;
+    size_t peakBytes() const;
+
+    /**
+     * @brief 参与上限判断的占用：cv::Mat与FFmpeg的精确统计，不含ORT的RSS估计
+     */
+    size_t throttledBytes() const;
+
+    /**
+     * @brief 当前进程RSS（读取/proc/self/statm）
+     */
+    static size_t currentRssBytes();
+
+    /**
+     * @brief throttledBytes() 是否超过上限
+     */
+    bool isOverCeiling() const;
+
+    /**
+     * @brief 超过上限且有其他在途帧时阻塞，直到有余量、其他在途帧全部结束或超时
+     * @return true 可以继续（有余量、未设上限或没有其他在途帧），false 等待超时
+     */
+    bool waitForHeadroom();
+
+    size_t inFlightFrames() const { return inFlight_.load(std::memory_order_acquire); }
+
+    std::vector<StageStats> getStageStats() const;
+
+    /**
+     * @brief 计算AVFrame引用的缓冲总大小（模板避免Utils依赖FFmpeg头文件）
+     */
+    template <typename Frame>
+    static size_t frameBufferBytes(const Frame* frame) {
+        size_t total = 0;
+        if (frame) {
+            for (const auto* buffer : frame->buf) {
+                total += buffer ? buffer->size : 0;
+            }
+        }
+        return total;
+    }
+
+private:
+    MemoryTracker();
+
+    StageAccount* stageAccount(const std::string& name);
+    StageAccount* currentAccount();
+    void record(Source source, StageAccount* account, size_t bytes);
+    void installMatAllocator();
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<size_t> ceiling_{0};
+    std::atomic<int64_t> throttleTimeoutMs_{2000};
+    std::atomic<size_t> inFlight_{0};   // HeadroomScope内的帧数
+
+    std::array<MetricsRegistry::Gauge*, static_cast<size_t>(Source::Count)> sourceBytes_{};
+    MetricsRegistry::Gauge& totalBytes_;
+    MetricsRegistry::Gauge& rssBytes_;
+
+    mutable std::mutex accountsMutex_;
+    std::map<std::string, std::unique_ptr<StageAccount>> accounts_;
+
+    // 释放内存时唤醒等待余量的线程
+    std::mutex headroomMutex_;
+    std::condition_variable headroomCv_;
+};
+
+#define MEMORY_CONCAT_INNER(a, b) a##b
+#define MEMORY_CONCAT(a, b) MEMORY_CONCAT_INNER(a, b)
+#define MEMORY_STAGE_SCOPE(stage) MemoryTracker::StageScope MEMORY_CONCAT(memoryStage_, __LINE__)(stage)
+
+#endif // MEMORY_TRACKER_H
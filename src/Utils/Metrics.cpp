@@ -0,0 +1,246 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+int bucketIndex(uint64_t micros) {
+    if (micros <= 1) {
+        return 0;
+    }
+    // ceil(log2(micros))
+    int index = 64 - __builtin_clzll(micros - 1);
+    return std::min(index, MetricsRegistry::Histogram::kBuckets - 1);
+}
+
+void atomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::string escapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Prometheus指标名只允许 [a-zA-Z0-9_:]
+std::string prometheusName(const std::string& name) {
+    std::string result = "videosr_";
+    for (char c : name) {
+        result += std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == ':' ? c : '_';
+    }
+    return result;
+}
+} // namespace
+
+// ========== Gauge ==========
+
+void MetricsRegistry::Gauge::set(int64_t value) {
+    value_.store(value, std::memory_order_relaxed);
+    updateMax(value);
+}
+
+void MetricsRegistry::Gauge::add(int64_t delta) {
+    updateMax(value_.fetch_add(delta, std::memory_order_relaxed) + delta);
+}
+
+void MetricsRegistry::Gauge::reset() {
+    value_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+void MetricsRegistry::Gauge::updateMax(int64_t value) {
+    int64_t current = max_.load(std::memory_order_relaxed);
+    while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// ========== Histogram ==========
+
+void MetricsRegistry::Histogram::observe(uint64_t micros) {
+    buckets_[bucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+    atomicMax(max_, micros);
+}
+
+uint64_t MetricsRegistry::Histogram::percentile(double q) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * total + 0.5);
+    rank = std::clamp<uint64_t>(rank, 1, total);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += bucketCount(i);
+        if (seen >= rank) {
+            // 桶上界可能超过实际最大值，取二者较小者
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+double MetricsRegistry::Histogram::mean() const {
+    uint64_t total = count();
+    return total > 0 ? static_cast<double>(sum()) / total : 0.0;
+}
+
+void MetricsRegistry::Histogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+// ========== Registry ==========
+
+MetricsRegistry& MetricsRegistry::getInstance() {
+    static MetricsRegistry instance;
+    return instance;
+}
+
+MetricsRegistry::Counter& MetricsRegistry::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) {
+        slot = std::make_unique<Counter>();
+    }
+    return *slot;
+}
+
+MetricsRegistry::Gauge& MetricsRegistry::gauge(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = gauges_[name];
+    if (!slot) {
+        slot = std::make_unique<Gauge>();
+    }
+    return *slot;
+}
+
+MetricsRegistry::Histogram& MetricsRegistry::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) {
+        slot = std::make_unique<Histogram>();
+    }
+    return *slot;
+}
+
+const MetricsRegistry::Counter* MetricsRegistry::findCounter(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = counters_.find(name);
+    return it != counters_.end() ? it->second.get() : nullptr;
+}
+
+const MetricsRegistry::Gauge* MetricsRegistry::findGauge(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = gauges_.find(name);
+    return it != gauges_.end() ? it->second.get() : nullptr;
+}
+
+const MetricsRegistry::Histogram* MetricsRegistry::findHistogram(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = histograms_.find(name);
+    return it != histograms_.end() ? it->second.get() : nullptr;
+}
+
+std::string MetricsRegistry::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+
+    out << "{\"counters\":{";
+    bool first = true;
+    for (const auto& [name, counter] : counters_) {
+        out << (first ? "" : ",") << "\"" << escapeJson(name) << "\":" << counter->value();
+        first = false;
+    }
+
+    out << "},\"gauges\":{";
+    first = true;
+    for (const auto& [name, gauge] : gauges_) {
+        out << (first ? "" : ",") << "\"" << escapeJson(name) << "\":{\"value\":" << gauge->value()
+            << ",\"max\":" << gauge->max() << "}";
+        first = false;
+    }
+
+    out << "},\"histograms\":{";
+    first = true;
+    for (const auto& [name, hist] : histograms_) {
+        out << (first ? "" : ",") << "\"" << escapeJson(name) << "\":{"
+            << "\"count\":" << hist->count()
+            << ",\"sum_us\":" << hist->sum()
+            << ",\"mean_us\":" << hist->mean()
+            << ",\"p50_us\":" << hist->percentile(0.50)
+            << ",\"p90_us\":" << hist->percentile(0.90)
+            << ",\"p99_us\":" << hist->percentile(0.99)
+            << ",\"max_us\":" << hist->max() << "}";
+        first = false;
+    }
+    out << "}}";
+    return out.str();
+}
+
+std::string MetricsRegistry::toPrometheus() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream out;
+
+    for (const auto& [name, counter] : counters_) {
+        std::string metric = prometheusName(name);
+        out << "# TYPE " << metric << " counter\n";
+        out << metric << " " << counter->value() << "\n";
+    }
+
+    for (const auto& [name, gauge] : gauges_) {
+        std::string metric = prometheusName(name);
+        out << "# TYPE " << metric << " gauge\n";
+        out << metric << " " << gauge->value() << "\n";
+        out << "# TYPE " << metric << "_max gauge\n";
+        out << metric << "_max " << gauge->max() << "\n";
+    }
+
+    for (const auto& [name, hist] : histograms_) {
+        std::string metric = prometheusName(name);
+        out << "# TYPE " << metric << " histogram\n";
+        uint64_t cumulative = 0;
+        for (int i = 0; i < Histogram::kBuckets; ++i) {
+            uint64_t inBucket = hist->bucketCount(i);
+            cumulative += inBucket;
+            // 省略空桶以减少输出，累计值保持单调
+            if (inBucket > 0) {
+                out << metric << "_bucket{le=\"" << Histogram::bucketUpperBound(i) << "\"} " << cumulative << "\n";
+            }
+        }
+        out << metric << "_bucket{le=\"+Inf\"} " << hist->count() << "\n";
+        out << metric << "_sum " << hist->sum() << "\n";
+        out << metric << "_count " << hist->count() << "\n";
+    }
+    return out.str();
+}
+
+void MetricsRegistry::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [name, counter] : counters_) {
+        counter->reset();
+    }
+    for (auto& [name, gauge] : gauges_) {
+        gauge->reset();
+    }
+    for (auto& [name, hist] : histograms_) {
+        hist->reset();
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// 便捷宏：每个调用点只在首次执行时查表注册，之后直接操作原子变量
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+// 作用域计时，耗时记入名为name的直方图（微秒）
+#define METRICS_SCOPED_TIMER(name) \
+    static MetricsRegistry::Histogram& METRICS_CONCAT(metricsHist_, __LINE__) = \
+        MetricsRegistry::getInstance().histogram(name); \
+    MetricsRegistry::ScopedTimer METRICS_CONCAT(metricsTimer_, __LINE__)(METRICS_CONCAT(metricsHist_, __LINE__))
+
+#define METRICS_COUNTER_ADD(name, delta) \
+    do { \
+        static MetricsRegistry::Counter& metricsCounter = MetricsRegistry::getInstance().counter(name); \
+        metricsCounter.add(static_cast<uint64_t>(delta)); \
+    } while (0)
+
+#define METRICS_GAUGE_SET(name, v) \
+    do { \
+        static MetricsRegistry::Gauge& metricsGauge = MetricsRegistry::getInstance().gauge(name); \
+        metricsGauge.set(static_cast<int64_t>(v)); \
+    } while (0)
+
+/**
+ * @brief 进程级指标注册表
+ *
+ * 计数器、仪表和直方图注册后地址固定，记录路径只有原子操作、不加锁；
+ * 注册和导出时才持有互斥锁。可按名称查询，或导出为JSON / Prometheus文本
+ */
+class MetricsRegistry {
+public:
+    /**
+     * @brief 单调递增计数器（帧数、字节数等）
+     */
+    class Counter {
+    public:
+        void add(uint64_t delta = 1) { value_.fetch_add(delta, std::memory_order_relaxed); }
+        uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+        void reset() { value_.store(0, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    /**
+     * @brief 瞬时值（队列深度等），同时记录历史最大值
+     */
+    class Gauge {
+    public:
+        void set(int64_t value);
+        void add(int64_t delta);
+        int64_t value() const { return value_.load(std::memory_order_relaxed); }
+        int64_t max() const { return max_.load(std::memory_order_relaxed); }
+        void reset();
+
+    private:
+        void updateMax(int64_t value);
+
+        std::atomic<int64_t> value_{0};
+        std::atomic<int64_t> max_{0};
+    };
+
+    /**
+     * @brief 以2的幂为桶边界的直方图（单位：微秒）
+     * 第i个桶统计 (2^(i-1), 2^i] 微秒，覆盖1微秒到约36分钟
+     */
+    class Histogram {
+    public:
+        static constexpr int kBuckets = 32;
+
+        void observe(uint64_t micros);
+        uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+        uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+        uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+        uint64_t bucketCount(int index) const { return buckets_[index].load(std::memory_order_relaxed); }
+        static uint64_t bucketUpperBound(int index) { return uint64_t(1) << index; }
+
+        /**
+         * @brief 估算分位数（取所在桶的上界）
+         * @param q 分位 (0, 1]
+         */
+        uint64_t percentile(double q) const;
+        double mean() const;
+        void reset();
+
+    private:
+        std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+        std::atomic<uint64_t> count_{0};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+
+    /**
+     * @brief 作用域计时器
+     */
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram& histogram)
+            : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+        ~ScopedTimer() {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            histogram_.observe(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+
+        ScopedTimer(const ScopedTimer&) = delete;
+        ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    private:
+        Histogram& histogram_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    static MetricsRegistry& getInstance();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // 获取或注册指标，返回的引用在进程生命周期内有效
+    Counter& counter(const std::string& name);
+    Gauge& gauge(const std::string& name);
+    Histogram& histogram(const std::string& name);
+
+    // 查询（不存在时返回nullptr）
+    const Counter* findCounter(const std::string& name) const;
+    const Gauge* findGauge(const std::string& name) const;
+    const Histogram* findHistogram(const std::string& name) const;
+
+    /**
+     * @brief 导出为JSON
+     */
+    std::string toJson() const;
+
+    /**
+     * @brief 导出为Prometheus文本格式（指标名自动加videosr_前缀）
+     */
+    std::string toPrometheus() const;
+
+    /**
+     * @brief 清零所有指标（保留注册）
+     */
+    void reset();
+
+private:
+    MetricsRegistry() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<Counter>> counters_;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges_;
+    std::map<std::string, std::unique_ptr<Histogram>> histograms_;
+};
+
+#endif // METRICS_H
@@ -0,0 +1,253 @@
+#include "ScalerCache.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "TaskScheduler.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+constexpr int kLineAlignment = 64;     // 行对齐，满足SIMD转换和编码器的要求
+constexpr int kBufferPadding = 64;     // 缓冲尾部余量，防止SIMD读越界
+constexpr int kAutoBandPixels = 1 << 20;   // 自动分带时每带约1M像素
+constexpr int kMaxBands = 8;
+constexpr int kMinBandRows = 64;           // 带太窄时调度开销超过收益
+
+// 格式的垂直色度子采样行数（带边界须对齐到它）
+int chromaRows(AVPixelFormat format) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    return desc ? 1 << desc->log2_chroma_h : 1;
+}
+
+// 第row行在各平面中的起始指针
+template <typename Ptr>
+void offsetPlanes(AVPixelFormat format, Ptr const data[], const int linesize[], int row, Ptr out[4]) {
+    const AVPixFmtDescriptor* desc = av_pix_fmt_desc_get(format);
+    int planes = av_pix_fmt_count_planes(format);
+    for (int plane = 0; plane < 4; ++plane) {
+        // 图像平面之外的指针（如GRAY8的伪调色板）原样传递
+        if (!data[plane] || plane >= planes) {
+            out[plane] = data[plane];
+            continue;
+        }
+        // 平面1/2是色度平面；alpha平面(3)与亮度同高
+        int planeRow = (plane == 1 || plane == 2) && desc ? row >> desc->log2_chroma_h : row;
+        out[plane] = data[plane] + static_cast<ptrdiff_t>(planeRow) * linesize[plane];
+    }
+}
+
+} // namespace
+
+ScalerCache::ScalerCache(size_t maxContexts, size_t maxFramePools)
+    : maxContexts_(std::max<size_t>(maxContexts, 1))
+    , maxFramePools_(std::max<size_t>(maxFramePools, 1)) {
+}
+
+ScalerCache::~ScalerCache() {
+    clear();
+}
+
+SwsContext* ScalerCache::getContext(const ScalerKey& key) {
+    for (auto& entry : contexts_) {
+        if (entry.key == key) {
+            entry.lastUse = ++tick_;
+            ++stats_.contextHits;
+            return entry.context;
+        }
+    }
+
+    SwsContext* context = sws_getContext(key.srcWidth, key.srcHeight, key.srcFormat,
+                                         key.dstWidth, key.dstHeight, key.dstFormat,
+                                         key.flags, nullptr, nullptr, nullptr);
+    if (!context) {
+        LOG_ERROR("ScalerCache: failed to create SwsContext " + std::to_string(key.srcWidth) + "x" +
+                  std::to_string(key.srcHeight) + " -> " + std::to_string(key.dstWidth) + "x" +
+                  std::to_string(key.dstHeight));
+        return nullptr;
+    }
+    ++stats_.contextCreates;
+    METRICS_COUNTER_ADD("sws_context_creates", 1);
+
+    if (contexts_.size() >= maxContexts_) {
+        auto oldest = std::min_element(contexts_.begin(), contexts_.end(),
+                                       [](const ContextEntry& a, const ContextEntry& b) { return a.lastUse < b.lastUse; });
+        sws_freeContext(oldest->context);
+        contexts_.erase(oldest);
+    }
+    contexts_.push_back(ContextEntry{key, context, ++tick_});
+
+    if (stats_.contextCreates > 1) {
+        LOG_DEBUG("ScalerCache: new scaler for " + std::to_string(key.srcWidth) + "x" + std::to_string(key.srcHeight) +
+                  " -> " + std::to_string(key.dstWidth) + "x" + std::to_string(key.dstHeight));
+    }
+    return context;
+}
+
+bool ScalerCache::scale(const ScalerKey& key, const uint8_t* const srcData[], const int srcLinesize[],
+                        uint8_t* const dstData[], const int dstLinesize[], int threads) {
+    int bandHeight = 0;
+    int bands = bandCount(key, threads, bandHeight);
+    if (bands <= 1) {
+        SwsContext* context = getContext(key);
+        if (!context) {
+            return false;
+        }
+        return sws_scale(context, srcData, srcLinesize, 0, key.srcHeight, dstData, dstLinesize) >= 0;
+    }
+
+    // 每带一个上下文，容量至少容纳两种分辨率的全部带，本帧取到的上下文不会被淘汰
+    maxContexts_ = std::max(maxContexts_, static_cast<size_t>(bands) * 2);
+    std::vector<SwsContext*> contexts(bands);
+    for (int band = 0; band < bands; ++band) {
+        ScalerKey bandKey = key;
+        bandKey.band = band;
+        bandKey.srcHeight = bandKey.dstHeight = std::min(bandHeight, key.srcHeight - band * bandHeight);
+        contexts[band] = getContext(bandKey);
+        if (!contexts[band]) {
+            return false;
+        }
+    }
+
+    TRACE_SCOPE("ScalerCache::scale", "convert");
+    std::atomic<bool> ok{true};
+    auto runBand = [&](int band) {
+        int row = band * bandHeight;
+        int rows = std::min(bandHeight, key.srcHeight - row);
+        const uint8_t* src[4];
+        uint8_t* dst[4];
+        offsetPlanes(key.srcFormat, srcData, srcLinesize, row, src);
+        offsetPlanes(key.dstFormat, dstData, dstLinesize, row, dst);
+        if (sws_scale(contexts[band], src, srcLinesize, 0, rows, dst, dstLinesize) < 0) {
+            ok.store(false, std::memory_order_relaxed);
+        }
+    };
+
+    // 第0带在调用线程上做，其余交给共享调度器；等待时帮忙执行本帧尚未开始的分带
+    TaskGroup group(TaskScheduler::shared());
+    for (int band = 1; band < bands; ++band) {
+        if (!group.run([&runBand, band]() { runBand(band); }, TaskScheduler::Priority::High)) {
+            runBand(band);
+        }
+    }
+    runBand(0);
+    group.wait();
+
+    ++stats_.bandedScales;
+    return ok.load(std::memory_order_relaxed);
+}
+
+AVFrame* ScalerCache::acquireFrame(int width, int height, AVPixelFormat format) {
+    FramePool* pool = getPool(width, height, format);
+    if (!pool) {
+        return nullptr;
+    }
+
+    AVFrame* frame = av_frame_alloc();
+    if (!frame) {
+        LOG_ERROR("ScalerCache: failed to allocate frame");
+        return nullptr;
+    }
+    frame->buf[0] = av_buffer_pool_get(pool->pool);
+    if (!frame->buf[0]) {
+        LOG_ERROR("ScalerCache: failed to get pooled frame buffer");
+        av_frame_free(&frame);
+        return nullptr;
+    }
+
+    frame->width = width;
+    frame->height = height;
+    frame->format = format;
+    std::copy(pool->linesize, pool->linesize + 4, frame->linesize);
+    av_image_fill_pointers(frame->data, format, height, frame->buf[0]->data, pool->linesize);
+    frame->extended_data = frame->data;
+    ++stats_.framesAcquired;
+    return frame;
+}
+
+void ScalerCache::clear() {
+    for (auto& entry : contexts_) {
+        sws_freeContext(entry.context);
+    }
+    contexts_.clear();
+    // 已取出的帧持有池的引用，池在最后一个缓冲归还后才真正释放
+    for (auto& pool : pools_) {
+        av_buffer_pool_uninit(&pool.pool);
+    }
+    pools_.clear();
+}
+
+ScalerCache::FramePool* ScalerCache::getPool(int width, int height, AVPixelFormat format) {
+    for (auto& pool : pools_) {
+        if (pool.width == width && pool.height == height && pool.format == format) {
+            pool.lastUse = ++tick_;
+            return &pool;
+        }
+    }
+
+    FramePool pool;
+    pool.width = width;
+    pool.height = height;
+    pool.format = format;
+    if (av_image_fill_linesizes(pool.linesize, format, width) < 0) {
+        LOG_ERROR("ScalerCache: unsupported frame format " + std::to_string(format));
+        return nullptr;
+    }
+    for (int& linesize : pool.linesize) {
+        linesize = (linesize + kLineAlignment - 1) / kLineAlignment * kLineAlignment;
+    }
+    uint8_t* planes[4];
+    int size = av_image_fill_pointers(planes, format, height, nullptr, pool.linesize);
+    if (size < 0) {
+        LOG_ERROR("ScalerCache: invalid frame size " + std::to_string(width) + "x" + std::to_string(height));
+        return nullptr;
+    }
+    pool.pool = av_buffer_pool_init(size + kBufferPadding, nullptr);
+    if (!pool.pool) {
+        LOG_ERROR("ScalerCache: failed to create frame buffer pool");
+        return nullptr;
+    }
+    pool.lastUse = ++tick_;
+    ++stats_.poolCreates;
+
+    if (pools_.size() >= maxFramePools_) {
+        auto oldest = std::min_element(pools_.begin(), pools_.end(),
+                                       [](const FramePool& a, const FramePool& b) { return a.lastUse < b.lastUse; });
+        av_buffer_pool_uninit(&oldest->pool);
+        pools_.erase(oldest);
+    }
+    pools_.push_back(pool);
+    return &pools_.back();
+}
+
+int ScalerCache::autoBandCount(int width, int height) {
+    // 四舍五入：1080p约1.98M像素取两带，4K约7.9M像素取八带
+    int64_t pixels = static_cast<int64_t>(width) * height;
+    int bands = static_cast<int>((pixels + kAutoBandPixels / 2) / kAutoBandPixels);
+    return std::max(1, std::min(bands, kMaxBands));
+}
+
+int ScalerCache::bandCount(const ScalerKey& key, int threads, int& bandHeight) const {
+    // 垂直缩放的滤波器跨带取行，分带结果会错，只对等高转换分带
+    if (threads == 1 || key.srcHeight != key.dstHeight) {
+        return 1;
+    }
+    int bands = threads;
+    if (bands <= 0) {
+        bands = std::min(autoBandCount(key.dstWidth, key.dstHeight), TaskScheduler::shared().threadCount());
+    }
+    bands = std::min({bands, kMaxBands, key.srcHeight / kMinBandRows});
+    if (bands <= 1) {
+        return 1;
+    }
+
+    int align = std::max(chromaRows(key.srcFormat), chromaRows(key.dstFormat));
+    bandHeight = (key.srcHeight + bands - 1) / bands;
+    bandHeight = (bandHeight + align - 1) / align * align;
+    return (key.srcHeight + bandHeight - 1) / bandHeight;
+}
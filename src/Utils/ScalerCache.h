@@ -0,0 +1,121 @@
+#ifndef SCALER_CACHE_H
+#define SCALER_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief 缩放/像素格式转换上下文的键
+ */
+struct ScalerKey {
+    int srcWidth = 0;
+    int srcHeight = 0;
+    AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+    int dstWidth = 0;
+    int dstHeight = 0;
+    AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
+    int flags = SWS_BILINEAR;
+    int band = 0;                   // 分带并行时的带序号（各带需独立的上下文）
+
+    bool operator==(const ScalerKey& other) const {
+        return srcWidth == other.srcWidth && srcHeight == other.srcHeight && srcFormat == other.srcFormat &&
+               dstWidth == other.dstWidth && dstHeight == other.dstHeight && dstFormat == other.dstFormat &&
+               flags == other.flags && band == other.band;
+    }
+};
+
+/**
+ * @brief SwsContext 与帧缓冲的小型键控缓存
+ *
+ * 按 (源尺寸/格式, 目标尺寸/格式) 保留最近用过的几个SwsContext，分辨率在几档之间来回切换
+ * （自适应码率源）时直接复用，不再逐次释放重建；帧缓冲按 (尺寸, 格式) 走AVBufferPool，
+ * 帧释放后缓冲回池，下一帧直接取用。
+ *
+ * scale() 可把整帧按行切成若干带，每带用独立的SwsContext在共享任务调度器上并行转换
+ * （只在不做垂直缩放时分带）。色度的垂直重采样滤波器在带边界处截断，yuv420p与BGR互转时
+ * 每个带边界都会留下色度接缝，调用线程每帧还要等待全部分带，因此分带须由调用方显式开启。
+ *
+ * 非线程安全：SwsContext本身不能并发使用，每个编码器/解码器各持有一个实例。
+ */
+class ScalerCache {
+public:
+    explicit ScalerCache(size_t maxContexts = 4, size_t maxFramePools = 4);
+    ~ScalerCache();
+
+    ScalerCache(const ScalerCache&) = delete;
+    ScalerCache& operator=(const ScalerCache&) = delete;
+
+    /**
+     * @brief 取键对应的SwsContext，不存在时创建（超出容量淘汰最久未用的）
+     * @return 上下文归缓存所有，创建失败返回nullptr
+     */
+    SwsContext* getContext(const ScalerKey& key);
+
+    /**
+     * @brief 转换整帧，可分带并行
+     * @param threads 并行带数（1=单线程，0=按目标尺寸自动选择）；需要垂直缩放时总是单线程
+     * @return 上下文创建失败或转换失败返回false
+     */
+    bool scale(const ScalerKey& key, const uint8_t* const srcData[], const int srcLinesize[],
+               uint8_t* const dstData[], const int dstLinesize[], int threads);
+
+    /**
+     * @brief 取一个池化缓冲的帧，调用方用av_frame_free释放（缓冲回池）
+     * @return 分配失败返回nullptr
+     */
+    AVFrame* acquireFrame(int width, int height, AVPixelFormat format);
+
+    /**
+     * @brief 释放全部上下文和缓冲池（已取出的帧仍然有效）
+     */
+    void clear();
+
+    struct Statistics {
+        uint64_t contextCreates = 0;    // 新建SwsContext次数
+        uint64_t contextHits = 0;       // 复用SwsContext次数
+        uint64_t poolCreates = 0;       // 新建帧缓冲池次数
+        uint64_t framesAcquired = 0;    // 取出的帧数
+        uint64_t bandedScales = 0;      // 分带并行转换的帧数
+    };
+
+    Statistics getStatistics() const { return stats_; }
+
+    /**
+     * @brief threads=0时按帧尺寸选的带数（每带约1M像素，四舍五入），实际带数还受线程数和带高限制
+     */
+    static int autoBandCount(int width, int height);
+
+private:
+    struct ContextEntry {
+        ScalerKey key;
+        SwsContext* context = nullptr;
+        uint64_t lastUse = 0;
+    };
+
+    struct FramePool {
+        int width = 0;
+        int height = 0;
+        AVPixelFormat format = AV_PIX_FMT_NONE;
+        int linesize[4] = {0, 0, 0, 0};
+        AVBufferPool* pool = nullptr;
+        uint64_t lastUse = 0;
+    };
+
+    FramePool* getPool(int width, int height, AVPixelFormat format);
+    int bandCount(const ScalerKey& key, int threads, int& bandHeight) const;
+
+    std::vector<ContextEntry> contexts_;
+    std::vector<FramePool> pools_;
+    size_t maxContexts_;
+    size_t maxFramePools_;
+    uint64_t tick_ = 0;
+    Statistics stats_;
+};
+
+#endif // SCALER_CACHE_H
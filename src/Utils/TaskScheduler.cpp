@@ -0,0 +1,305 @@
+#include "TaskScheduler.h"
+#include "Logger.h"
+#include "Metrics.h"
+#include "Trace.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+namespace {
+constexpr size_t kNoWorker = std::numeric_limits<size_t>::max();
+
+// 当前线程所属的调度器及工作线程下标
+thread_local const TaskScheduler* tlsScheduler = nullptr;
+thread_local size_t tlsWorkerIndex = kNoWorker;
+} // namespace
+
+TaskScheduler::TaskScheduler(int threadCount, const std::string& name)
+    : name_(name) {
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    for (int i = 0; i < threadCount; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    // 所有队列就绪后再启动线程，避免窃取时访问未创建的队列
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        workers_[i]->thread = std::thread(&TaskScheduler::workerLoop, this, i);
+    }
+    LOG_INFO("TaskScheduler '" + name_ + "' started with " + std::to_string(threadCount) + " workers");
+}
+
+TaskScheduler::~TaskScheduler() {
+    shutdown();
+}
+
+TaskScheduler& TaskScheduler::shared() {
+    static TaskScheduler instance(0, "task");
+    return instance;
+}
+
+bool TaskScheduler::isWorkerThread() const {
+    return tlsScheduler == this;
+}
+
+bool TaskScheduler::submit(Task task, Priority priority, TaskGroup* group) {
+    if (stopping_.load(std::memory_order_acquire)) {
+        LOG_WARNING("TaskScheduler '" + name_ + "' is shut down, task rejected");
+        return false;
+    }
+
+    if (group) {
+        group->onSubmitted();
+    }
+
+    // 先计数再入队：取出方递减时计数不会下溢
+    pending_.fetch_add(1, std::memory_order_release);
+    const int level = static_cast<int>(priority);
+    if (isWorkerThread()) {
+        Worker& worker = *workers_[tlsWorkerIndex];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[level].push_front(Entry{std::move(task), group});
+    } else {
+        size_t index = nextWorker_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+        Worker& worker = *workers_[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queues[level].push_back(Entry{std::move(task), group});
+    }
+
+    // 经过sleepMutex_再通知，避免与工作线程检查条件之间的丢失唤醒
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCv_.notify_one();
+    return true;
+}
+
+bool TaskScheduler::takeFrom(std::deque<Entry>& queue, bool fromFront, const TaskGroup* group, Entry& entry) {
+    if (queue.empty()) {
+        return false;
+    }
+    if (!group) {
+        entry = std::move(fromFront ? queue.front() : queue.back());
+        fromFront ? queue.pop_front() : queue.pop_back();
+        return true;
+    }
+    // 只取指定组的任务：与不限组时同一方向上的第一个
+    auto matches = [group](const Entry& candidate) { return candidate.group == group; };
+    auto it = queue.end();
+    if (fromFront) {
+        it = std::find_if(queue.begin(), queue.end(), matches);
+    } else {
+        auto last = std::find_if(queue.rbegin(), queue.rend(), matches);
+        if (last != queue.rend()) {
+            it = std::prev(last.base());
+        }
+    }
+    if (it == queue.end()) {
+        return false;
+    }
+    entry = std::move(*it);
+    queue.erase(it);
+    return true;
+}
+
+bool TaskScheduler::takeAny(Entry& entry, const TaskGroup* group) {
+    const size_t self = isWorkerThread() ? tlsWorkerIndex : kNoWorker;
+    const size_t count = workers_.size();
+
+    // 按优先级从高到低：先取本线程队列前端，再从其他线程队列后端窃取
+    for (int level = kPriorityLevels - 1; level >= 0; --level) {
+        if (self != kNoWorker) {
+            Worker& own = *workers_[self];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (takeFrom(own.queues[level], true, group, entry)) {
+                return true;
+            }
+        }
+
+        size_t start = self != kNoWorker ? self + 1 : nextWorker_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            size_t victim = (start + i) % count;
+            if (victim == self) {
+                continue;
+            }
+            Worker& other = *workers_[victim];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (takeFrom(other.queues[level], false, group, entry)) {
+                if (self != kNoWorker) {
+                    METRICS_COUNTER_ADD("scheduler_steals", 1);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool TaskScheduler::runOne(const TaskGroup* group) {
+    if (pending_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    Entry entry;
+    if (!takeAny(entry, group)) {
+        return false;
+    }
+    // 先计入running_再减pending_，isIdle()不会在两者之间误判为空闲
+    running_.fetch_add(1, std::memory_order_acq_rel);
+    pending_.fetch_sub(1, std::memory_order_acq_rel);
+    execute(entry);
+    return true;
+}
+
+void TaskScheduler::execute(Entry& entry) {
+    bool ok = true;
+    try {
+        entry.task();
+    } catch (const std::exception& e) {
+        ok = false;
+        LOG_ERROR("TaskScheduler '" + name_ + "' task failed: " + e.what());
+    } catch (...) {
+        ok = false;
+        LOG_ERROR("TaskScheduler '" + name_ + "' task failed with unknown exception");
+    }
+    METRICS_COUNTER_ADD("scheduler_tasks", 1);
+
+    // 先释放任务持有的资源，再通知组：组可能在通知后立即析构
+    entry.task = nullptr;
+    if (entry.group) {
+        entry.group->onFinished(ok);
+    }
+
+    if (running_.fetch_sub(1, std::memory_order_acq_rel) == 1 && pending_.load(std::memory_order_acquire) == 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        idleCv_.notify_all();
+    }
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+    tlsScheduler = this;
+    tlsWorkerIndex = index;
+    Tracer::getInstance().setThreadName(name_ + "-" + std::to_string(index));
+
+    while (!stopping_.load(std::memory_order_acquire)) {
+        if (runOne()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [this] {
+            return stopping_.load(std::memory_order_acquire) || pending_.load(std::memory_order_acquire) > 0;
+        });
+    }
+}
+
+bool TaskScheduler::waitForIdle(std::chrono::milliseconds timeout) {
+    if (isWorkerThread()) {
+        LOG_ERROR("TaskScheduler::waitForIdle called from a worker thread, use TaskGroup::wait instead");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(sleepMutex_);
+    auto idle = [this] { return isIdle(); };
+    if (timeout.count() < 0) {
+        idleCv_.wait(lock, idle);
+        return true;
+    }
+    return idleCv_.wait_for(lock, timeout, idle);
+}
+
+size_t TaskScheduler::discardAll() {
+    std::vector<TaskGroup*> groups;
+    size_t discarded = 0;
+    for (auto& worker : workers_) {
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        for (auto& queue : worker->queues) {
+            for (auto& entry : queue) {
+                if (entry.group) {
+                    groups.push_back(entry.group);
+                }
+            }
+            discarded += queue.size();
+            queue.clear();
+        }
+    }
+    pending_.fetch_sub(discarded, std::memory_order_acq_rel);
+
+    // 丢弃的任务按失败计入所属组，等待中的组不会永远阻塞
+    for (TaskGroup* group : groups) {
+        group->onFinished(false);
+    }
+    return discarded;
+}
+
+void TaskScheduler::shutdown() {
+    if (stopping_.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCv_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+
+    size_t discarded = discardAll();
+    if (discarded > 0) {
+        LOG_WARNING("TaskScheduler '" + name_ + "' discarded " + std::to_string(discarded) + " pending tasks");
+    }
+
+    std::lock_guard<std::mutex> lock(sleepMutex_);
+    idleCv_.notify_all();
+}
+
+// ========== TaskGroup ==========
+
+TaskGroup::TaskGroup(TaskScheduler& scheduler)
+    : scheduler_(scheduler) {
+}
+
+TaskGroup::~TaskGroup() {
+    wait();
+}
+
+bool TaskGroup::run(TaskScheduler::Task task, TaskScheduler::Priority priority) {
+    return scheduler_.submit(std::move(task), priority, this);
+}
+
+void TaskGroup::onSubmitted() {
+    pending_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void TaskGroup::onFinished(bool ok) {
+    if (!ok) {
+        failed_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    // 持锁通知：wait()返回（组可能随即析构）前通知方已不再访问本对象
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        doneCv_.notify_all();
+    }
+}
+
+bool TaskGroup::wait() {
+    while (pending_.load(std::memory_order_acquire) > 0) {
+        // 只帮忙执行本组的任务：工作线程等待子任务时不空等，
+        // 外部线程（编解码、UI）也不会接手其他组可能很长的任务
+        if (scheduler_.runOne(this)) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        doneCv_.wait_for(lock, std::chrono::milliseconds(2), [this] {
+            return pending_.load(std::memory_order_acquire) == 0;
+        });
+    }
+    // 与onFinished中的持锁通知同步，确保通知方已释放本对象
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_.load(std::memory_order_acquire) == 0;
+}
@@ -0,0 +1,165 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TaskGroup;
+
+/**
+ * @brief 工作窃取任务调度器（不依赖Qt，流水线代码和UI线程池共用）
+ *
+ * 每个工作线程有自己的任务双端队列（按优先级分三层）：
+ * - 工作线程内提交的任务压入本线程队列前端，本线程从前端取（后进先出，缓存友好）
+ * - 外部线程提交的任务轮流追加到各工作线程队列后端，按提交顺序执行
+ * - 本线程队列为空时从其他线程队列的后端窃取任务，
+ *   一个耗时的4K任务不会再阻塞排在它后面的任务
+ *
+ * 高优先级任务总是先于低优先级任务被取出（本线程和窃取都按优先级从高到低查找）。
+ * 任务可归属TaskGroup，TaskGroup::wait() 等待组内任务完成；
+ * 等待时帮忙执行本组尚未开始的任务，工作线程不会因全部阻塞而死锁，
+ * 编解码、UI等外部线程也不会被拖去执行其他组的长任务
+ */
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    enum class Priority {
+        Low = 0,
+        Normal = 1,
+        High = 2
+    };
+
+    /**
+     * @param threadCount 工作线程数，<=0时使用硬件线程数
+     * @param name 线程名前缀（用于追踪时间线）
+     */
+    explicit TaskScheduler(int threadCount = 0, const std::string& name = "worker");
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief 进程共享的调度器，线程数为硬件线程数，首次调用时创建
+     */
+    static TaskScheduler& shared();
+
+    /**
+     * @brief 提交任务
+     * @param task 任务函数，抛出的异常会被记录并计入所属组的失败数
+     * @param priority 优先级
+     * @param group 所属任务组（可为空）
+     * @return 调度器已关闭时返回false
+     */
+    bool submit(Task task, Priority priority = Priority::Normal, TaskGroup* group = nullptr);
+
+    /**
+     * @brief 取出并执行一个任务（等待线程借此帮忙推进）
+     * @param group 只取该组的任务，为空时取任意任务
+     * @return 是否执行了任务
+     */
+    bool runOne(const TaskGroup* group = nullptr);
+
+    /**
+     * @brief 等待所有已提交任务完成
+     * @param timeout 超时时间，负值表示一直等待
+     * @return 是否在超时前完成
+     */
+    bool waitForIdle(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    /**
+     * @brief 停止调度：正在执行的任务完成后工作线程退出，未开始的任务被丢弃
+     */
+    void shutdown();
+
+    int threadCount() const { return static_cast<int>(workers_.size()); }
+    size_t pendingTasks() const { return pending_.load(std::memory_order_acquire); }
+    bool isIdle() const { return pendingTasks() == 0 && running_.load(std::memory_order_acquire) == 0; }
+
+    /**
+     * @brief 当前线程是否为本调度器的工作线程
+     */
+    bool isWorkerThread() const;
+
+private:
+    struct Entry {
+        Task task;
+        TaskGroup* group = nullptr;
+    };
+
+    static constexpr int kPriorityLevels = 3;
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Entry> queues[kPriorityLevels];  // 下标为优先级
+        std::thread thread;
+    };
+
+    void workerLoop(size_t index);
+    bool takeAny(Entry& entry, const TaskGroup* group);
+    static bool takeFrom(std::deque<Entry>& queue, bool fromFront, const TaskGroup* group, Entry& entry);
+    void execute(Entry& entry);
+    size_t discardAll();
+
+    std::string name_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> nextWorker_{0};
+    std::atomic<size_t> pending_{0};   // 已提交未取出的任务数
+    std::atomic<size_t> running_{0};   // 正在执行的任务数
+    std::atomic<bool> stopping_{false};
+
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;  // 工作线程等待新任务
+    std::condition_variable idleCv_;   // waitForIdle等待
+};
+
+/**
+ * @brief 任务组：跟踪一批任务的完成情况
+ * 组对象须在其任务全部完成前保持有效（析构时会自动等待）
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::shared());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /**
+     * @brief 提交归属本组的任务
+     */
+    bool run(TaskScheduler::Task task, TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
+
+    /**
+     * @brief 等待组内任务全部完成，等待期间帮忙执行本组尚未开始的任务
+     * @return 组内任务是否全部成功（没有抛出异常）
+     */
+    bool wait();
+
+    size_t pending() const { return pending_.load(std::memory_order_acquire); }
+    size_t failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+    friend class TaskScheduler;
+
+    void onSubmitted();
+    void onFinished(bool ok);
+
+    TaskScheduler& scheduler_;
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> failed_{0};
+    std::mutex mutex_;
+    std::condition_variable doneCv_;
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,171 @@
+#include "Trace.h"
+#include "Logger.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+// 当前线程的名字：线程在首次记录事件时才建缓冲区，名字先记在这里
+thread_local std::string tlsThreadName;
+
+std::string escapeJson(const char* text) {
+    std::string escaped;
+    for (const char* p = text ? text : ""; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            escaped += '\\';
+        }
+        escaped += *p;
+    }
+    return escaped;
+}
+} // namespace
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer()
+    : origin_(std::chrono::steady_clock::now()) {
+}
+
+void Tracer::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+    LOG_INFO(std::string("Tracing ") + (enabled ? "enabled" : "disabled"));
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    // 不在这里建缓冲区：未启用追踪时命名线程不应注册缓冲区
+    tlsThreadName = name;
+    std::shared_ptr<ThreadBuffer>& buffer = threadBuffer();
+    if (!buffer) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(buffer->mutex);
+    buffer->threadName = name;
+}
+
+std::shared_ptr<Tracer::ThreadBuffer>& Tracer::threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    return buffer;
+}
+
+Tracer::ThreadBuffer& Tracer::currentBuffer() {
+    std::shared_ptr<ThreadBuffer>& buffer = threadBuffer();
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>(std::max<size_t>(1, bufferCapacity_.load(std::memory_order_relaxed)));
+        buffer->tid = static_cast<int>(::syscall(SYS_gettid));
+        buffer->threadName = tlsThreadName;
+
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        // 顺带回收已退出且没有事件的线程的缓冲区
+        pruneExitedLocked(false);
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::pruneExitedLocked(bool dropEvents) {
+    // 线程退出时其thread_local引用随之释放，只剩buffers_持有的即为已退出线程
+    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                  [dropEvents](const std::shared_ptr<ThreadBuffer>& buffer) {
+                                      if (buffer.use_count() != 1) {
+                                          return false;
+                                      }
+                                      std::lock_guard<std::mutex> lock(buffer->mutex);
+                                      return dropEvents || buffer->count == 0;
+                                  }),
+                   buffers_.end());
+}
+
+void Tracer::record(const char* name, const char* category,
+                    std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end) {
+    ThreadBuffer& buffer = currentBuffer();
+
+    Event event;
+    event.name = name;
+    event.category = category;
+    event.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin_).count();
+    event.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() < buffer.capacity) {
+        buffer.events.push_back(event);
+    } else {
+        buffer.events[buffer.next] = event;
+    }
+    buffer.next = (buffer.next + 1) % buffer.capacity;
+    buffer.count = std::min(buffer.count + 1, buffer.capacity);
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("Cannot open trace output: " + path);
+        return false;
+    }
+
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffers = buffers_;
+    }
+
+    const int pid = static_cast<int>(::getpid());
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    size_t written = 0;
+    for (const auto& buffer : buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+
+        if (!buffer->threadName.empty()) {
+            out << (first ? "" : ",")
+                << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << buffer->tid
+                << ",\"args\":{\"name\":\"" << escapeJson(buffer->threadName.c_str()) << "\"}}";
+            first = false;
+        }
+
+        // 环形缓冲区按时间顺序输出：从最旧的事件开始
+        size_t size = buffer->events.size();
+        size_t oldest = size > 0 ? (buffer->next + size - buffer->count) % size : 0;
+        for (size_t i = 0; i < buffer->count; ++i) {
+            const Event& event = buffer->events[(oldest + i) % size];
+            out << (first ? "" : ",")
+                << "{\"name\":\"" << escapeJson(event.name) << "\""
+                << ",\"cat\":\"" << escapeJson(event.category) << "\""
+                << ",\"ph\":\"X\""
+                << ",\"ts\":" << event.startNs / 1000.0
+                << ",\"dur\":" << event.durationNs / 1000.0
+                << ",\"pid\":" << pid << ",\"tid\":" << buffer->tid << "}";
+            first = false;
+            ++written;
+        }
+    }
+
+    out << "]}\n";
+
+    // 已退出线程的事件已经导出，释放其缓冲区
+    buffers.clear();
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        pruneExitedLocked(true);
+    }
+    LOG_INFO("Trace written: " + path + " (" + std::to_string(written) + " events)");
+    return out.good();
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(buffersMutex_);
+    pruneExitedLocked(true);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+        buffer->next = 0;
+        buffer->count = 0;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 流水线时间线追踪（Chrome trace / Perfetto格式）
+ *
+ * 用法：在函数或代码块开头写 TRACE_SCOPE("name", "category")，
+ * 运行时调用 Tracer::getInstance().setEnabled(true) 开始记录，
+ * 结束后 writeChromeTrace() 导出，用 chrome://tracing 或 ui.perfetto.dev 打开。
+ *
+ * 事件写入各线程独立的环形缓冲区，满后覆盖最旧事件；
+ * 未启用时每个作用域只有一次原子读。定义 VIDEOSR_DISABLE_TRACE 可在编译期完全移除
+ */
+class Tracer {
+public:
+    struct Event {
+        const char* name = nullptr;       // 事件名（须为字符串字面量）
+        const char* category = nullptr;   // 分类（须为字符串字面量）
+        int64_t startNs = 0;              // 相对追踪起点的开始时间
+        int64_t durationNs = 0;           // 持续时间
+    };
+
+    static Tracer& getInstance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /**
+     * @brief 开启/关闭记录
+     */
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 设置每个线程环形缓冲区的事件容量（对之后新建的缓冲区生效）
+     */
+    void setBufferCapacity(size_t events) { bufferCapacity_.store(events, std::memory_order_relaxed); }
+
+    /**
+     * @brief 为当前线程命名，显示在时间线的线程标签上（线程首次记录事件时才注册缓冲区）
+     */
+    void setThreadName(const std::string& name);
+
+    /**
+     * @brief 记录一个完整事件（由TraceScope调用）
+     */
+    void record(const char* name, const char* category,
+                std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief 导出为Chrome trace JSON，已退出线程的缓冲区导出后释放
+     * @param path 输出文件路径
+     * @return 是否成功
+     */
+    bool writeChromeTrace(const std::string& path);
+
+    /**
+     * @brief 清空所有线程已记录的事件
+     */
+    void clear();
+
+private:
+    struct ThreadBuffer {
+        explicit ThreadBuffer(size_t capacity) : capacity(capacity) {}
+
+        std::mutex mutex;           // 仅在导出时与写入线程竞争
+        std::vector<Event> events;  // 按需增长到capacity后循环覆盖，短命线程不会占满整块内存
+        size_t capacity;
+        size_t next = 0;            // 下一个写入位置
+        size_t count = 0;           // 有效事件数（不超过容量）
+        int tid = 0;
+        std::string threadName;
+    };
+
+    Tracer();
+    static std::shared_ptr<ThreadBuffer>& threadBuffer();  // 当前线程的缓冲区（未注册时为空）
+    ThreadBuffer& currentBuffer();
+    // 移除已退出线程的缓冲区；dropEvents为false时只移除没有事件的
+    void pruneExitedLocked(bool dropEvents);
+
+    std::atomic<bool> enabled_{false};
+    std::atomic<size_t> bufferCapacity_{1 << 16};
+    std::chrono::steady_clock::time_point origin_;
+
+    mutable std::mutex buffersMutex_;
+    // 线程退出后缓冲区保留到导出或clear()，以便导出其事件
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+};
+
+/**
+ * @brief 作用域追踪事件
+ */
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category)
+        : name_(name), category_(category), active_(Tracer::getInstance().isEnabled()) {
+        if (active_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (active_) {
+            Tracer::getInstance().record(name_, category_, start_, std::chrono::steady_clock::now());
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    const char* category_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef VIDEOSR_DISABLE_TRACE
+#define TRACE_SCOPE(name, category) do {} while (0)
+#else
+#define TRACE_SCOPE(name, category) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name, category)
+#endif
+
+#endif // TRACE_H
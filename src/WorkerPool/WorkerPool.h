@@ -1,41 +1,14 @@
 #pragma once
 
 #include <QObject>
-#include <QThread>
-#include <QMutex>
-#include <QWaitCondition>
-#include <QQueue>
 #include <functional>
 #include <memory>
+#include "../Utils/TaskScheduler.h"
 
 // 任务类型定义
 using Task = std::function<void()>;
 
-// 工作线程类
-class WorkerThread : public QThread
-{
-    Q_OBJECT
-
-public:
-    explicit WorkerThread(QObject* parent = nullptr);
-    ~WorkerThread();
-
-    void addTask(Task task);
-    void stop();
-    bool isIdle() const;
-
-protected:
-    void run() override;
-
-private:
-    QMutex m_mutex;
-    QWaitCondition m_condition;
-    QQueue<Task> m_tasks;
-    bool m_running;
-    bool m_idle;
-};
-
-// 工作池类
+// 工作池类：基于工作窃取调度器，空闲线程会从繁忙线程的队列中窃取任务
 class WorkerPool : public QObject
 {
     Q_OBJECT
@@ -45,23 +18,21 @@ public:
     ~WorkerPool();
 
     // 提交任务
-    void submitTask(Task task);
+    void submitTask(Task task, TaskScheduler::Priority priority = TaskScheduler::Priority::Normal);
 
-    // 停止所有工作线程
+    // 停止所有工作线程（未开始的任务被丢弃）
     void stop();
 
-    // 等待所有任务完成
+    // 等待所有任务完成，msecs<0 表示一直等待
     void waitForDone(int msecs = -1);
 
     // 获取状态
-    int threadCount() const { return m_threads.size(); }
-    bool isIdle() const;
+    int threadCount() const { return m_scheduler->threadCount(); }
+    bool isIdle() const { return m_scheduler->isIdle(); }
 
 signals:
     void allTasksCompleted();
 
 private:
-    std::vector<std::unique_ptr<WorkerThread>> m_threads;
-    int m_currentThread;
-    mutable QMutex m_mutex;
-};
\ No newline at end of file
+    std::unique_ptr<TaskScheduler> m_scheduler;
+}; 
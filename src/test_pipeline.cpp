@@ -3,6 +3,8 @@
 #include <memory>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <vector>
 
 // 各模块头文件
 #include "Decoder/include/VideoDecoder.h"
@@ -10,7 +12,13 @@
 #include "SuperEigen/include/SuperResEngine.h"
 #include "SyncVA/AVSyncManager.h"
 #include "Encoder/Encoder.h"
+#include "Processing/ThreadBudgetTuner.h"
 #include "Utils/Logger.h"
+#include "Utils/MemoryTracker.h"
+#include "Utils/Metrics.h"
+#include "Utils/TaskScheduler.h"
+#include "Utils/Trace.h"
+#include <fstream>
 
 /**
  * @brief 视频处理流水线测试
@@ -19,7 +27,13 @@
  */
 class VideoPipeline {
 public:
-    VideoPipeline() : frameCount_(0), processedFrames_(0) {}
+    VideoPipeline() : frameCount_(0), processedFrames_(0), autoTune_(false) {}
+    
+    /**
+     * @brief 启用线程预算自动调优（在initialize前调用）
+     * 用前几帧校准解码/超分/编码吞吐，选出线程分配与超分会话数后用于整个作业
+     */
+    void setAutoTune(bool enable) { autoTune_ = enable; }
     
     bool initialize(const std::string& inputPath, const std::string& outputPath) {
         inputPath_ = inputPath;
@@ -29,6 +43,12 @@ public:
         LOG_INFO("Input: " + inputPath_);
         LOG_INFO("Output: " + outputPath_);
         
+        // 校准线程预算
+        if (autoTune_ && !calibrateThreadBudget()) {
+            LOG_WARNING("Thread budget calibration failed, using defaults");
+            budget_ = ThreadBudget();
+        }
+        
         // 初始化解码器
         if (!initializeDecoders()) {
             LOG_ERROR("Failed to initialize decoders");
@@ -41,8 +61,14 @@ public:
             return false;
         }
         
-        // 初始化同步管理器
-        syncManager_ = std::make_unique<AVSyncManager>();
+        // 初始化同步管理器：每帧视频推入后随即取出，容量只防异常流无限堆积
+        AVSyncConfig syncConfig;
+        syncConfig.videoCapacity = 4;
+        syncConfig.audioCapacity = 64;
+        syncManager_ = std::make_unique<AVSyncManager>(syncConfig);
+        if (!audioDecoder_) {
+            syncManager_->endAudio();
+        }
         
         // 初始化编码器（延迟到获得第一帧尺寸后）
         encoderInitialized_ = false;
@@ -62,89 +88,54 @@ public:
         int processedVideoFrames = 0;
         int max_frame = 20;
         while ((hasVideoFrames || hasAudioFrames) && processedVideoFrames < max_frame) {
-            // 解码视频帧
+            // 解码视频帧：每个超分会话一帧，并行超分后按顺序推入
             if (hasVideoFrames) {
-                FrameData videoFrame;
-                if (videoDecoder_->readNextFrame(videoFrame)) {
-                    frameCount_++;
-                    processedVideoFrames++;
-                    
-                    // 超分处理
-                    if (!processSuperResolution(videoFrame)) {
-                        LOG_ERROR("Failed to process super resolution for frame " + std::to_string(frameCount_));
+                std::vector<FrameData> videoFrames;
+                // 超过内存上限时退化为单帧超分，降低同时在途的帧缓冲
+                size_t batchLimit = MemoryTracker::getInstance().isOverCeiling() ? 1 : superResEngines_.size();
+                while (videoFrames.size() < batchLimit &&
+                       processedVideoFrames < max_frame) {
+                    FrameData videoFrame;
+                    if (!videoDecoder_->readNextFrame(videoFrame)) {
+                        hasVideoFrames = false;
+                        syncManager_->endVideo();
+                        LOG_INFO("Video decoding completed, total frames: " + std::to_string(frameCount_ + videoFrames.size()));
                         break;
                     }
+                    videoFrames.push_back(std::move(videoFrame));
+                    processedVideoFrames++;
+                }
+                
+                // 超分处理
+                if (!processSuperResolution(videoFrames)) {
+                    LOG_ERROR("Failed to process super resolution for frame " + std::to_string(frameCount_ + 1));
+                    break;
+                }
+                
+                for (auto& videoFrame : videoFrames) {
+                    frameCount_++;
                     
-                    // 推入同步管理器
-                    syncManager_->pushVideo(videoFrame);
+                    // 推入同步管理器，音频解码到追上这一帧为止，随即取出可输出的帧
+                    if (!pushSync(videoFrame) || !pumpAudio(hasAudioFrames, videoFrame.timestamp) || !drainSync()) {
+                        return false;
+                    }
                     
                     LOG_INFO("Processed video frame " + std::to_string(frameCount_) + 
                               " @ " + std::to_string(videoFrame.timestamp) + "s");
-                } else {
-                    hasVideoFrames = false;
-                    LOG_INFO("Video decoding completed, total frames: " + std::to_string(frameCount_));
                 }
             }
             
-            // 解码音频帧
-            if (hasAudioFrames && audioDecoder_) {
-                AudioFrameData audioFrame;
-                if (audioDecoder_->readNextFrame(audioFrame)) {
-                    // 推入同步管理器
-                    syncManager_->pushAudio(audioFrame);
-                    
-                    LOG_DEBUG("Processed audio frame @ " + std::to_string(audioFrame.timestamp) + "s");
-                } else {
-                    hasAudioFrames = false;
-                    LOG_INFO("Audio decoding completed");
-                }
-            }
-            
-            // 处理同步输出
-            while (syncManager_->hasNext()) {
-                auto frame = syncManager_->popNext();
-                
-                if (!encoderInitialized_) {
-                    if (!initializeEncoder(frame)) {
-                        LOG_ERROR("Failed to initialize encoder");
-                        return false;
-                    }
-                    encoderInitialized_ = true;
-                }
-                
-                // 调试：保存前几帧图像
-                if (processedFrames_ < 3) {
-                    if (AVSyncManager::isVideoFrame(frame)) {
-                        const auto& videoFrame = AVSyncManager::getVideoFrame(frame);
-                        std::string debugPath = "VideoSR-Lite/resource/image" + std::to_string(processedFrames_) + ".png";
-                        cv::imwrite(debugPath, videoFrame.image);
-                        LOG_INFO("Saved debug frame: " + debugPath + " size: " + 
-                                std::to_string(videoFrame.image.cols) + "x" + std::to_string(videoFrame.image.rows));
-                    }
-                }
-                
-                if (!encoder_->push(frame)) {
-                    LOG_ERROR("Failed to encode frame");
-                    return false;
-                }
-                
-                processedFrames_++;
-                
-                // 每100帧输出一次进度
-                if (processedFrames_ % 100 == 0) {
-                    LOG_INFO("Encoded " + std::to_string(processedFrames_) + " frames");
-                }
+            // 视频读完后剩余音频全部送入
+            if (!hasVideoFrames && (!pumpAudio(hasAudioFrames, -1.0) || !drainSync())) {
+                return false;
             }
         }
         
-        // 处理剩余的同步帧
-        while (syncManager_->hasNext()) {
-            auto frame = syncManager_->popNext();
-            if (!encoder_->push(frame)) {
-                LOG_ERROR("Failed to encode remaining frame");
-                return false;
-            }
-            processedFrames_++;
+        // 处理剩余的同步帧（达到帧数上限时两路可能都未读完）
+        syncManager_->endVideo();
+        syncManager_->endAudio();
+        if (!drainSync()) {
+            return false;
         }
         
         // 刷新编码器
@@ -167,6 +158,29 @@ public:
         LOG_INFO("Total frames processed: " + std::to_string(processedFrames_));
         LOG_INFO("Output file: " + outputPath_);
         
+        // 按NUMA节点输出超分吞吐
+        for (const auto& node : SuperEigen::SuperResEngine::getNodeStats()) {
+            LOG_INFO("SR node " + std::to_string(node.numaNode) + ": " +
+                     std::to_string(node.totalFrames) + " frames, " +
+                     std::to_string(node.framesPerSecond) + " fps");
+        }
+        
+        // 各阶段内存峰值
+        if (MemoryTracker::getInstance().isEnabled()) {
+            LOG_INFO("Peak tracked memory: " + std::to_string(MemoryTracker::getInstance().peakBytes() >> 20) + " MB");
+            for (const auto& stage : MemoryTracker::getInstance().getStageStats()) {
+                LOG_INFO("Memory stage " + stage.stage + ": peak " + std::to_string(stage.peakBytes >> 20) +
+                         " MB, max per frame " + std::to_string(stage.peakFrameBytes >> 20) +
+                         " MB, " + std::to_string(stage.allocations) + " allocations");
+            }
+        }
+        
+        // 各阶段耗时、队列深度、字节数与内存占用
+        std::string metricsPath = outputPath_ + ".metrics.json";
+        std::ofstream metricsFile(metricsPath);
+        metricsFile << MetricsRegistry::getInstance().toJson() << std::endl;
+        LOG_INFO("Pipeline metrics written to: " + metricsPath);
+        
         return true;
     }
 
@@ -174,7 +188,7 @@ private:
     // 组件
     std::unique_ptr<VideoDecoder> videoDecoder_;
     std::unique_ptr<AudioDecoder> audioDecoder_;
-    std::unique_ptr<SuperEigen::SuperResEngine> superResEngine_;
+    std::vector<std::shared_ptr<SuperEigen::SuperResEngine>> superResEngines_;
     std::unique_ptr<AVSyncManager> syncManager_;
     std::unique_ptr<Encoder> encoder_;
     
@@ -185,10 +199,41 @@ private:
     int processedFrames_;
     bool encoderInitialized_;
     
+    // 线程预算
+    bool autoTune_;
+    ThreadBudget budget_;
+    // 校准时按线程数建的超分会话；选中的那个直接作为第一个处理会话，不再重新加载模型
+    ThreadBudgetTuner::SessionMap calibrationEngines_;
+    
+    bool calibrateThreadBudget() {
+        ThreadBudgetTuner tuner;
+        VideoProbeConfig probeConfig;
+        probeConfig.inputPath = inputPath_;
+        if (!tuner.setVideoProbes(probeConfig, &calibrationEngines_)) {
+            return false;
+        }
+        
+        budget_ = tuner.tune();
+        
+        // 只保留选中线程数的会话
+        for (auto it = calibrationEngines_.begin(); it != calibrationEngines_.end();) {
+            if (it->first != budget_.srThreadsPerSession) {
+                it = calibrationEngines_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return budget_.predictedFps > 0.0;
+    }
+    
     bool initializeDecoders() {
         // 初始化视频解码器
         videoDecoder_ = std::make_unique<VideoDecoder>();
-        if (!videoDecoder_->open(inputPath_)) {
+        VideoDecoderConfig decoderConfig;
+        if (autoTune_) {
+            decoderConfig.threadCount = budget_.decodeThreads;
+        }
+        if (!videoDecoder_->initialize(decoderConfig) || !videoDecoder_->open(inputPath_)) {
             LOG_ERROR("Failed to open video file: " + inputPath_);
             return false;
         }
@@ -206,14 +251,118 @@ private:
     }
     
     bool initializeSuperRes() {
-        superResEngine_ = std::make_unique<SuperEigen::SuperResEngine>();
+        int sessions = autoTune_ ? budget_.srSessions : 1;
+        superResEngines_.clear();
         
-        if (!superResEngine_->initialize(SuperEigen::SuperResEngine::getDefaultModelPath(), false, 0)) {
-            LOG_ERROR("Failed to initialize super resolution engine");
-            return false;
+        for (int i = 0; i < sessions; ++i) {
+            auto calibrated = calibrationEngines_.find(budget_.srThreadsPerSession);
+            if (autoTune_ && calibrated != calibrationEngines_.end()) {
+                superResEngines_.push_back(std::move(calibrated->second));
+                calibrationEngines_.erase(calibrated);
+                continue;
+            }
+            
+            auto engine = std::make_unique<SuperEigen::SuperResEngine>();
+            if (autoTune_) {
+                SuperEigen::SuperResConfig config;
+                config.numThreads = budget_.srThreadsPerSession;
+                engine->setConfig(config);
+            }
+            
+            if (!engine->initialize(SuperEigen::SuperResEngine::getDefaultModelPath(), false, 0)) {
+                LOG_ERROR("Failed to initialize super resolution engine");
+                return false;
+            }
+            superResEngines_.push_back(std::move(engine));
         }
         
-        LOG_INFO("Super resolution engine initialized successfully");
+        LOG_INFO("Super resolution engine initialized successfully (" + std::to_string(sessions) + " session(s))");
+        return true;
+    }
+    
+    bool pumpAudio(bool& hasAudioFrames, double untilTimestamp) {
+        // 音频解码到时间戳超过untilTimestamp为止（负值表示读完），视频帧才能输出
+        while (hasAudioFrames && audioDecoder_) {
+            AudioFrameData audioFrame;
+            if (!audioDecoder_->readNextFrame(audioFrame)) {
+                hasAudioFrames = false;
+                syncManager_->endAudio();
+                LOG_INFO("Audio decoding completed");
+                break;
+            }
+            double timestamp = audioFrame.timestamp;
+            if (!pushSync(audioFrame)) {
+                return false;
+            }
+            LOG_DEBUG("Processed audio frame @ " + std::to_string(timestamp) + "s");
+            if (untilTimestamp >= 0.0 && timestamp >= untilTimestamp) {
+                break;
+            }
+        }
+        return true;
+    }
+    
+    bool pushSync(const FrameData& frame) {
+        while (!syncManager_->pushVideo(frame, std::chrono::milliseconds(0))) {
+            if (!drainFullSync("video")) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool pushSync(const AudioFrameData& frame) {
+        while (!syncManager_->pushAudio(frame, std::chrono::milliseconds(0))) {
+            if (!drainFullSync("audio")) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool drainFullSync(const char* stream) {
+        // 本线程既推入又取出：队列满时先取出可输出的帧，阻塞等待只会等到自己
+        if (!syncManager_->hasNext()) {
+            LOG_ERROR(std::string(stream) + " sync queue full with no frame ready");
+            return false;
+        }
+        return drainSync();
+    }
+    
+    bool drainSync() {
+        AVSyncManager::FrameVariant frame;
+        while (syncManager_->popNext(frame, std::chrono::milliseconds(0))) {
+            if (!encoderInitialized_) {
+                if (!initializeEncoder(frame)) {
+                    LOG_ERROR("Failed to initialize encoder");
+                    return false;
+                }
+                encoderInitialized_ = true;
+            }
+            
+            // 调试：保存前几帧图像
+            if (processedFrames_ < 3) {
+                if (AVSyncManager::isVideoFrame(frame)) {
+                    const auto& videoFrame = AVSyncManager::getVideoFrame(frame);
+                    std::string debugPath = "VideoSR-Lite/resource/image" + std::to_string(processedFrames_) + ".png";
+                    cv::imwrite(debugPath, videoFrame.image);
+                    LOG_INFO("Saved debug frame: " + debugPath + " size: " + 
+                            std::to_string(videoFrame.image.cols) + "x" + std::to_string(videoFrame.image.rows));
+                }
+            }
+            
+            if (!encoder_->push(frame)) {
+                LOG_ERROR("Failed to encode frame");
+                return false;
+            }
+            
+            processedFrames_++;
+            
+            // 每100帧输出一次进度
+            if (processedFrames_ % 100 == 0) {
+                LOG_INFO("Encoded " + std::to_string(processedFrames_) + " frames");
+            }
+        }
         return true;
     }
     
@@ -249,6 +398,9 @@ private:
         config.videoFrameRate = 30.0;
         config.videoPreset = "ultrafast";  // 快速编码
         config.videoCRF = 18;           // CRF=18为高质量压缩
+        if (autoTune_) {
+            config.threadCount = budget_.encodeThreads;
+        }
         
         if (!encoder_->init(config)) {
             LOG_ERROR("Failed to initialize encoder");
@@ -259,24 +411,41 @@ private:
         return true;
     }
     
-    bool processSuperResolution(FrameData& frame) {
-        if (!superResEngine_) {
+    bool processSuperResolution(std::vector<FrameData>& frames) {
+        if (superResEngines_.empty()) {
             LOG_ERROR("Super resolution engine not initialized");
             return false;
         }
         
-        cv::Mat outputImage = superResEngine_->Process(frame.image);
-        if (outputImage.empty()) {
-            LOG_ERROR("Failed to process super resolution");
-            return false;
+        // 每帧交给一个会话，在共享调度器上并行处理（不再为每帧创建线程）
+        std::vector<cv::Mat> results(frames.size());
+        TaskGroup group;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            SuperEigen::SuperResEngine* engine = superResEngines_[i % superResEngines_.size()].get();
+            const cv::Mat& input = frames[i].image;
+            cv::Mat& output = results[i];
+            group.run([engine, &input, &output]() {
+                output = engine->Process(input);
+            });
         }
+        group.wait();
         
-        // 更新帧数据
-        frame.image = outputImage;
-        frame.width = outputImage.cols;
-        frame.height = outputImage.rows;
+        bool ok = true;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            cv::Mat& outputImage = results[i];
+            if (outputImage.empty()) {
+                LOG_ERROR("Failed to process super resolution");
+                ok = false;
+                continue;
+            }
+            
+            // 更新帧数据
+            frames[i].image = outputImage;
+            frames[i].width = outputImage.cols;
+            frames[i].height = outputImage.rows;
+        }
         
-        return true;
+        return ok;
     }
 };
 
@@ -285,6 +454,23 @@ int main(int argc, char* argv[]) {
     // 配置日志系统
     Logger::getInstance().setLogLevel(Logger::LogLevel::INFO);
     Logger::getInstance().setLogToConsole(true);
+    // 异步输出：逐帧日志不阻塞解码/超分/编码线程
+    Logger::getInstance().setAsync(true);
+    // 设置VIDEOSR_BINARY_LOG时以二进制格式记录完整DEBUG日志，用 log_decode 还原为文本
+    const char* binaryLog = std::getenv("VIDEOSR_BINARY_LOG");
+    if (binaryLog && Logger::getInstance().setBinaryOutput(binaryLog)) {
+        Logger::getInstance().setLogLevel(Logger::LogLevel::DEBUG);
+    }
+    
+    // 设置VIDEOSR_TRACE_FILE时记录时间线，结束后导出为Chrome trace
+    const char* traceFile = std::getenv("VIDEOSR_TRACE_FILE");
+    if (traceFile) {
+        Tracer::getInstance().setEnabled(true);
+        Tracer::getInstance().setThreadName("pipeline");
+    }
+    
+    // VIDEOSR_MEMORY_TRACKING=1 统计各阶段内存，VIDEOSR_MEMORY_CEILING_MB 设置内存上限
+    MemoryTracker::getInstance().configureFromEnvironment();
     
     std::cout << "=== 视频处理流水线测试 ===" << std::endl;
     
@@ -298,12 +484,19 @@ int main(int argc, char* argv[]) {
     if (argc >= 3) {
         outputPath = argv[2];
     }
+    bool autoTune = false;
+    for (int i = 3; i < argc; ++i) {
+        if (std::string(argv[i]) == "--auto-tune") {
+            autoTune = true;
+        }
+    }
     
     std::cout << "输入文件: " << inputPath << std::endl;
     std::cout << "输出文件: " << outputPath << std::endl;
     
     // 创建并运行流水线
     VideoPipeline pipeline;
+    pipeline.setAutoTune(autoTune);
     
     if (!pipeline.initialize(inputPath, outputPath)) {
         std::cerr << "Failed to initialize pipeline" << std::endl;
@@ -315,6 +508,10 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
+    if (traceFile) {
+        Tracer::getInstance().writeChromeTrace(traceFile);
+    }
+    
     std::cout << "=== 处理完成 ===" << std::endl;
     return 0;
 } 
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "../SuperEigen/include/TensorKernels.h"
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+extern "C" {
+#include <libavutil/cpu.h>
+#include <libavutil/imgutils.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief 预处理/后处理与像素格式转换内核的微基准测试
+ *
+ * 覆盖 TensorKernels（通道交换、HWC<->CHW、归一化、范围拉伸）以及解码器/编码器中
+ * 使用的 sws_scale 转换，按分辨率和SIMD级别展开，吞吐以 bytes_per_second 报告
+ * （读+写字节数）。
+ *
+ * SIMD级别：0 = 关闭OpenCV优化路径并强制FFmpeg不使用任何CPU扩展，1 = 运行时自动检测。
+ * TensorKernels中的纯循环内核由编译器向量化，无法在运行时切换，只测自动级别。
+ *
+ * 运行：./benchmark_kernels --benchmark_format=json --benchmark_out=kernels.json
+ */
+
+using namespace SuperEigen;
+
+namespace {
+
+// 测试分辨率（宽度，高度按16:9），4K覆盖超分后处理的输出尺寸
+const std::vector<int64_t> kWidths = {640, 1280, 1920, 3840};
+
+int heightFor(int64_t width) {
+    return static_cast<int>(width * 9 / 16);
+}
+
+/**
+ * @brief 在作用域内切换SIMD级别，结束时恢复自动检测
+ */
+class ScopedSimdLevel {
+public:
+    explicit ScopedSimdLevel(int level) {
+        cv::setUseOptimized(level != 0);
+        av_force_cpu_flags(level != 0 ? -1 : 0);
+    }
+    ~ScopedSimdLevel() {
+        cv::setUseOptimized(true);
+        av_force_cpu_flags(-1);
+    }
+};
+
+const char* simdLabel(int level) {
+    return level != 0 ? "simd=auto" : "simd=off";
+}
+
+cv::Mat makeImage(int width, int height, int type) {
+    cv::Mat image(height, width, type);
+    cv::randu(image, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255));
+    return image;
+}
+
+void setBytes(benchmark::State& state, size_t bytesPerIteration) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(bytesPerIteration));
+}
+
+// ========== TensorKernels ==========
+
+void BM_BgrToRgb(benchmark::State& state) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    ScopedSimdLevel simd(static_cast<int>(state.range(1)));
+    cv::Mat bgr = makeImage(width, height, CV_8UC3);
+
+    for (auto _ : state) {
+        cv::Mat rgb = TensorKernels::bgrToRgb(bgr);
+        benchmark::DoNotOptimize(rgb.data);
+    }
+    setBytes(state, bgr.total() * 3 * 2);
+    state.SetLabel(simdLabel(static_cast<int>(state.range(1))));
+}
+
+void BM_HwcToChw(benchmark::State& state) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    ScopedSimdLevel simd(static_cast<int>(state.range(1)));
+    cv::Mat rgb = makeImage(width, height, CV_8UC3);
+    std::vector<float> chw;
+
+    for (auto _ : state) {
+        TensorKernels::hwcToChw(rgb, chw);
+        benchmark::DoNotOptimize(chw.data());
+    }
+    // 读8位，写float
+    setBytes(state, rgb.total() * 3 * (sizeof(uint8_t) + sizeof(float)));
+    state.SetLabel(simdLabel(static_cast<int>(state.range(1))));
+}
+
+void BM_ChwToHwc(benchmark::State& state) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    ScopedSimdLevel simd(static_cast<int>(state.range(1)));
+    std::vector<float> chw(static_cast<size_t>(width) * height * 3, 0.5f);
+
+    for (auto _ : state) {
+        cv::Mat hwc = TensorKernels::chwToHwc(chw.data(), 3, height, width);
+        benchmark::DoNotOptimize(hwc.data);
+    }
+    setBytes(state, chw.size() * sizeof(float) * 2);
+    state.SetLabel(simdLabel(static_cast<int>(state.range(1))));
+}
+
+void BM_Normalize(benchmark::State& state) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    std::vector<float> source(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<float>(i % 256) / 255.0f;
+    }
+    std::vector<float> data(source.size());
+
+    for (auto _ : state) {
+        // 原地归一化：每轮从原始数据重新开始，否则数值逐轮发散到inf
+        state.PauseTiming();
+        data = source;
+        state.ResumeTiming();
+        TensorKernels::normalize(data.data(), data.size(), 0.5f, 0.25f);
+        benchmark::ClobberMemory();
+    }
+    setBytes(state, data.size() * sizeof(float) * 2);
+}
+
+void BM_RescaleToUnitRange(benchmark::State& state) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    std::vector<float> source(static_cast<size_t>(width) * height * 3);
+    for (size_t i = 0; i < source.size(); ++i) {
+        // 模拟超出[0,1]的模型输出，走完整的拉伸+截断路径
+        source[i] = static_cast<float>(i % 1021) / 1000.0f - 0.01f;
+    }
+    std::vector<float> data(source.size());
+
+    for (auto _ : state) {
+        state.PauseTiming();
+        data = source;
+        state.ResumeTiming();
+        TensorKernels::rescaleToUnitRange(data.data(), data.size());
+        benchmark::ClobberMemory();
+    }
+    setBytes(state, data.size() * sizeof(float) * 2);
+}
+
+// ========== sws_scale ==========
+
+/**
+ * @brief 与解码器/编码器相同参数的sws_scale转换
+ * SwsContext在切换SIMD级别后创建，使其按当前CPU标志选择实现
+ */
+void runSwsScale(benchmark::State& state, AVPixelFormat srcFormat, AVPixelFormat dstFormat, int flags) {
+    int width = static_cast<int>(state.range(0));
+    int height = heightFor(width);
+    int level = static_cast<int>(state.range(1));
+    ScopedSimdLevel simd(level);
+
+    SwsContext* context = sws_getContext(width, height, srcFormat, width, height, dstFormat,
+                                         flags, nullptr, nullptr, nullptr);
+    uint8_t* srcData[4] = {nullptr};
+    uint8_t* dstData[4] = {nullptr};
+    int srcLinesize[4] = {0};
+    int dstLinesize[4] = {0};
+    int srcBytes = av_image_alloc(srcData, srcLinesize, width, height, srcFormat, 32);
+    int dstBytes = av_image_alloc(dstData, dstLinesize, width, height, dstFormat, 32);
+    if (!context || srcBytes < 0 || dstBytes < 0) {
+        state.SkipWithError("Failed to set up sws_scale");
+    } else {
+        for (int i = 0; i < srcBytes; ++i) {
+            srcData[0][i] = static_cast<uint8_t>(i * 31);
+        }
+        for (auto _ : state) {
+            sws_scale(context, srcData, srcLinesize, 0, height, dstData, dstLinesize);
+            benchmark::DoNotOptimize(dstData[0]);
+        }
+        setBytes(state, static_cast<size_t>(srcBytes) + static_cast<size_t>(dstBytes));
+        state.SetLabel(simdLabel(level));
+    }
+
+    av_freep(&srcData[0]);
+    av_freep(&dstData[0]);
+    sws_freeContext(context);
+}
+
+// 解码器输出路径：YUV420P -> BGR24 (SWS_BILINEAR)
+void BM_SwsDecodeYuvToBgr(benchmark::State& state) {
+    runSwsScale(state, AV_PIX_FMT_YUV420P, AV_PIX_FMT_BGR24, SWS_BILINEAR);
+}
+
+// 编码器输入路径：BGR24 -> YUV420P (SWS_BICUBIC)
+void BM_SwsEncodeBgrToYuv(benchmark::State& state) {
+    runSwsScale(state, AV_PIX_FMT_BGR24, AV_PIX_FMT_YUV420P, SWS_BICUBIC);
+}
+
+} // namespace
+
+BENCHMARK(BM_BgrToRgb)->ArgsProduct({kWidths, {0, 1}})->ArgNames({"width", "simd"});
+BENCHMARK(BM_HwcToChw)->ArgsProduct({kWidths, {0, 1}})->ArgNames({"width", "simd"});
+BENCHMARK(BM_ChwToHwc)->ArgsProduct({kWidths, {0, 1}})->ArgNames({"width", "simd"});
+BENCHMARK(BM_Normalize)->ArgsProduct({kWidths})->ArgNames({"width"});
+BENCHMARK(BM_RescaleToUnitRange)->ArgsProduct({kWidths})->ArgNames({"width"});
+BENCHMARK(BM_SwsDecodeYuvToBgr)->ArgsProduct({kWidths, {0, 1}})->ArgNames({"width", "simd"});
+BENCHMARK(BM_SwsEncodeBgrToYuv)->ArgsProduct({kWidths, {0, 1}})->ArgNames({"width", "simd"});
+
+BENCHMARK_MAIN();
@@ -0,0 +1,643 @@
+#include "../Decoder/include/VideoDecoder.h"
+#include "../SuperEigen/include/SuperResEngine.h"
+#include "../SuperEigen/include/ModelSession.h"
+#include "../SuperEigen/include/PrePostProcessor.h"
+#include "../Encoder/Encoder.h"
+#include "../Encoder/VideoEncoder.h"
+#include "../Encoder/Muxer.h"
+#include "../Utils/Logger.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+extern "C" {
+#include <libavutil/avutil.h>
+}
+
+/**
+ * @brief 端到端基准测试
+ *
+ * 用确定性的合成视频（无需外部素材）分别测量解码、预处理、推理、后处理、编码、封装
+ * 各组件以及完整流水线在不同线程数下的表现，结果输出为JSON/CSV，便于版本间对比回归。
+ *
+ * 组件测试互相隔离：解码结果先缓存在内存中，再分别喂给超分和编码阶段。
+ * 各轮的峰值RSS以本轮开始时的RSS为基线取增量，超分和编码阶段不含缓存的解码帧。
+ * 超分组件直接驱动ModelSession/PrePostProcessor，输入为原始分辨率；
+ * 超过512的分辨率在完整流水线中会被SuperResEngine先缩小，两者不可直接比较，
+ * 因此默认分辨率取512x288。
+ */
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct BenchmarkOptions {
+    int width = 512;                  // 合成视频宽度
+    int height = 288;                 // 合成视频高度
+    double fps = 30.0;                // 合成视频帧率
+    double duration = 2.0;            // 合成视频时长（秒）
+    std::vector<int> threadCounts{1, 2, 4};  // 依次测试的线程数
+    int warmupFrames = 2;             // 每轮超分前的预热帧数（不计入结果）
+    int maxSrFrames = 0;              // 超分组件与流水线最多处理的帧数（0=全部）
+    std::string modelPath;            // 模型路径（空=默认模型）
+    std::string preset = "veryfast";  // 编码预设
+    std::string workDir;              // 中间文件目录（空=系统临时目录）
+    std::string jsonPath = "benchmark_results.json";
+    std::string csvPath;              // 为空则不输出CSV
+    bool skipSr = false;              // 只测解码/编码/封装
+};
+
+struct StageResult {
+    std::string stage;
+    int threads = 0;
+    std::vector<double> latenciesMs;  // 每帧耗时
+    double wallMs = 0.0;              // 整轮墙钟时间（含收尾flush，flush不计为一帧）
+    long baselineRssKb = 0;           // 本轮开始时的RSS
+    long peakRssKb = 0;               // 本轮峰值RSS相对基线的增量
+
+    double fps() const {
+        return wallMs > 0.0 ? latenciesMs.size() * 1000.0 / wallMs : 0.0;
+    }
+
+    double mean() const {
+        return latenciesMs.empty() ? 0.0
+            : std::accumulate(latenciesMs.begin(), latenciesMs.end(), 0.0) / latenciesMs.size();
+    }
+
+    // 最近秩法分位数
+    double percentile(double q) const {
+        if (latenciesMs.empty()) {
+            return 0.0;
+        }
+        std::vector<double> sorted = latenciesMs;
+        std::sort(sorted.begin(), sorted.end());
+        size_t rank = static_cast<size_t>(std::ceil(q * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+};
+
+double elapsedMs(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+long readStatusKb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t length = std::strlen(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, length, field) == 0) {
+            return std::stol(line.substr(length));
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 重置进程峰值RSS（Linux 4.0+ 写clear_refs=5清零VmHWM），使每轮的峰值互不影响
+ * @return 重置后的当前RSS（KB），作为本轮峰值的基线
+ */
+long resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs.is_open()) {
+        clearRefs << "5";
+    }
+    return std::max(0L, readStatusKb("VmRSS:"));
+}
+
+long readPeakRssKb() {
+    long peak = readStatusKb("VmHWM:");
+    if (peak >= 0) {
+        return peak;
+    }
+    // 回退：getrusage给出的是整个进程生命周期的峰值
+    struct rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * @brief 生成第index帧合成画面：平移渐变 + 移动方块 + 固定种子噪声，保证每次运行内容一致
+ */
+cv::Mat makeSyntheticFrame(int width, int height, int index) {
+    cv::Mat frame(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < width; ++x) {
+            row[x] = cv::Vec3b(static_cast<uchar>((x + index * 4) & 0xFF),
+                               static_cast<uchar>((y + index * 2) & 0xFF),
+                               static_cast<uchar>((x + y) / 2 & 0xFF));
+        }
+    }
+
+    int boxSize = std::max(8, std::min(width, height) / 6);
+    int boxX = (index * 7) % std::max(1, width - boxSize);
+    int boxY = (index * 5) % std::max(1, height - boxSize);
+    cv::rectangle(frame, cv::Rect(boxX, boxY, boxSize, boxSize), cv::Scalar(255, 255, 255), cv::FILLED);
+
+    // 纹理噪声让编码器和模型有真实的细节可处理
+    cv::Mat noise(height, width, CV_8UC3);
+    cv::RNG rng(static_cast<uint64_t>(index) + 1);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 24);
+    frame += noise;
+    return frame;
+}
+
+bool generateSyntheticVideo(const BenchmarkOptions& options, const std::string& path) {
+    EncoderConfig config;
+    config.outputPath = path;
+    config.videoWidth = options.width;
+    config.videoHeight = options.height;
+    config.videoFrameRate = options.fps;
+    config.videoPreset = "ultrafast";
+    config.videoCRF = 18;
+    config.audioSampleRate = 0;  // 仅视频
+    config.audioChannels = 0;
+
+    Encoder encoder;
+    if (!encoder.init(config)) {
+        LOG_ERROR("Failed to initialize encoder for synthetic video");
+        return false;
+    }
+
+    int totalFrames = static_cast<int>(options.fps * options.duration);
+    for (int i = 0; i < totalFrames; ++i) {
+        FrameData frame;
+        frame.image = makeSyntheticFrame(options.width, options.height, i);
+        frame.width = options.width;
+        frame.height = options.height;
+        frame.frameIndex = i;
+        frame.pts = i;
+        frame.timestamp = i / options.fps;
+        if (!encoder.push(frame)) {
+            LOG_ERROR("Failed to encode synthetic frame " + std::to_string(i));
+            return false;
+        }
+    }
+    return encoder.close();
+}
+
+// ========== 组件测试 ==========
+
+bool benchDecode(const std::string& path, int threads, std::vector<FrameData>& frames, StageResult& result) {
+    VideoDecoderConfig config;
+    config.threadCount = threads;
+
+    VideoDecoder decoder;
+    if (!decoder.initialize(config) || !decoder.open(path)) {
+        LOG_ERROR("Failed to open synthetic video: " + path);
+        return false;
+    }
+
+    result.stage = "decode";
+    frames.clear();
+    auto runStart = Clock::now();
+    while (true) {
+        FrameData frame;
+        auto start = Clock::now();
+        if (!decoder.readNextFrame(frame)) {
+            break;
+        }
+        result.latenciesMs.push_back(elapsedMs(start));
+        frames.push_back(std::move(frame));
+    }
+    result.wallMs = elapsedMs(runStart);
+    return !frames.empty();
+}
+
+bool benchSuperRes(const std::vector<FrameData>& frames, const BenchmarkOptions& options, int threads,
+                   StageResult& preprocess, StageResult& inference, StageResult& postprocess) {
+    // ModelSession只保存配置引用，config须比会话活得久
+    SuperEigen::SuperResConfig config(options.modelPath);
+    config.numThreads = threads;
+    // 与SuperResEngine::initialize相同的倍率推断规则
+    config.scaleFactor = fs::path(options.modelPath).filename().string().find("x4") != std::string::npos ? 4 : 2;
+
+    SuperEigen::ModelSession session(config);
+    if (!session.initialize(options.modelPath)) {
+        LOG_ERROR("Failed to load model: " + options.modelPath);
+        return false;
+    }
+    SuperEigen::PrePostProcessor processor(config);
+
+    size_t count = frames.size();
+    if (options.maxSrFrames > 0) {
+        count = std::min(count, static_cast<size_t>(options.maxSrFrames));
+    }
+
+    for (int i = 0; i < options.warmupFrames && !frames.empty(); ++i) {
+        const cv::Mat& image = frames[i % frames.size()].image;
+        processor.postprocess(session.inference(processor.preprocess(image, session.getMemoryInfo())), image.size());
+    }
+
+    preprocess.stage = "preprocess";
+    inference.stage = "inference";
+    postprocess.stage = "postprocess";
+    for (size_t i = 0; i < count; ++i) {
+        const cv::Mat& image = frames[i].image;
+
+        auto start = Clock::now();
+        Ort::Value input = processor.preprocess(image, session.getMemoryInfo());
+        preprocess.latenciesMs.push_back(elapsedMs(start));
+
+        start = Clock::now();
+        Ort::Value output = session.inference(input);
+        inference.latenciesMs.push_back(elapsedMs(start));
+
+        start = Clock::now();
+        processor.postprocess(output, image.size());
+        postprocess.latenciesMs.push_back(elapsedMs(start));
+    }
+
+    // 各阶段串行执行，吞吐按本阶段耗时之和计算
+    for (StageResult* stage : {&preprocess, &inference, &postprocess}) {
+        stage->wallMs = std::accumulate(stage->latenciesMs.begin(), stage->latenciesMs.end(), 0.0);
+    }
+    return true;
+}
+
+bool benchEncodeMux(const std::vector<FrameData>& frames, const BenchmarkOptions& options, int threads,
+                    const std::string& outputPath, StageResult& encode, StageResult& mux) {
+    VideoEncoderConfig encoderConfig;
+    encoderConfig.width = options.width;
+    encoderConfig.height = options.height;
+    encoderConfig.frameRate = options.fps;
+    encoderConfig.preset = options.preset;
+    encoderConfig.crf = 23;
+    encoderConfig.threadCount = threads;
+
+    VideoEncoder encoder;
+    AVRational timeBase = {1, static_cast<int>(options.fps)};
+    if (!encoder.init(encoderConfig, timeBase)) {
+        LOG_ERROR("Failed to initialize video encoder");
+        return false;
+    }
+
+    MuxerConfig muxerConfig;
+    muxerConfig.outputPath = outputPath;
+    Muxer muxer;
+    if (!muxer.init(muxerConfig) || muxer.addVideoStream(encoder.getCodecContext()) < 0 || !muxer.writeHeader()) {
+        LOG_ERROR("Failed to initialize muxer: " + outputPath);
+        return false;
+    }
+
+    encode.stage = "encode";
+    mux.stage = "mux";
+
+    double encodeFlushMs = 0.0;
+    double muxFlushMs = 0.0;
+    auto writePackets = [&](std::vector<AVPacket*>& packets, double* flushMs) {
+        auto start = Clock::now();
+        bool ok = true;
+        for (auto* packet : packets) {
+            ok = muxer.writePacket(packet, 0) && ok;
+        }
+        encoder.releasePackets(packets);
+        // 收尾flush写出的积压包只计入总耗时，不算一帧
+        if (flushMs) {
+            *flushMs = elapsedMs(start);
+        } else {
+            mux.latenciesMs.push_back(elapsedMs(start));
+        }
+        return ok;
+    };
+
+    for (const auto& frame : frames) {
+        std::vector<AVPacket*> packets;
+        auto start = Clock::now();
+        if (!encoder.encode(frame, packets)) {
+            LOG_ERROR("Failed to encode frame " + std::to_string(frame.frameIndex));
+            return false;
+        }
+        encode.latenciesMs.push_back(elapsedMs(start));
+        if (!writePackets(packets, nullptr)) {
+            return false;
+        }
+    }
+
+    std::vector<AVPacket*> packets;
+    auto flushStart = Clock::now();
+    if (!encoder.flush(packets)) {
+        return false;
+    }
+    encodeFlushMs = elapsedMs(flushStart);
+    if (!writePackets(packets, &muxFlushMs)) {
+        return false;
+    }
+
+    encode.wallMs = std::accumulate(encode.latenciesMs.begin(), encode.latenciesMs.end(), encodeFlushMs);
+    mux.wallMs = std::accumulate(mux.latenciesMs.begin(), mux.latenciesMs.end(), muxFlushMs);
+    return muxer.finalize();
+}
+
+// ========== 完整流水线 ==========
+
+bool benchPipeline(const std::string& inputPath, const BenchmarkOptions& options, int threads,
+                   const std::string& outputPath, StageResult& result) {
+    VideoDecoderConfig decoderConfig;
+    decoderConfig.threadCount = threads;
+    VideoDecoder decoder;
+    if (!decoder.initialize(decoderConfig) || !decoder.open(inputPath)) {
+        return false;
+    }
+
+    SuperEigen::SuperResEngine engine;
+    if (!options.skipSr) {
+        SuperEigen::SuperResConfig srConfig = engine.getConfig();
+        srConfig.numThreads = threads;
+        engine.setConfig(srConfig);
+        if (!engine.initialize(options.modelPath)) {
+            return false;
+        }
+        cv::Mat warmup = makeSyntheticFrame(options.width, options.height, 0);
+        for (int i = 0; i < options.warmupFrames; ++i) {
+            engine.Process(warmup);
+        }
+    }
+
+    EncoderConfig encoderConfig;
+    encoderConfig.outputPath = outputPath;
+    encoderConfig.videoFrameRate = options.fps;
+    encoderConfig.videoPreset = options.preset;
+    encoderConfig.videoCRF = 23;
+    encoderConfig.threadCount = threads;
+    encoderConfig.audioSampleRate = 0;
+    encoderConfig.audioChannels = 0;
+    Encoder encoder;
+    bool encoderReady = false;
+
+    result.stage = "pipeline";
+    auto runStart = Clock::now();
+    while (options.maxSrFrames <= 0 || result.latenciesMs.size() < static_cast<size_t>(options.maxSrFrames)) {
+        auto start = Clock::now();
+        FrameData frame;
+        if (!decoder.readNextFrame(frame)) {
+            break;
+        }
+
+        FrameData output = options.skipSr ? frame : engine.processFrame(frame);
+
+        // 编码尺寸取超分输出尺寸
+        if (!encoderReady) {
+            encoderConfig.videoWidth = output.width;
+            encoderConfig.videoHeight = output.height;
+            if (!encoder.init(encoderConfig)) {
+                return false;
+            }
+            encoderReady = true;
+        }
+        if (!encoder.push(output)) {
+            return false;
+        }
+        result.latenciesMs.push_back(elapsedMs(start));
+    }
+    if (encoderReady) {
+        encoder.close();
+    }
+    result.wallMs = elapsedMs(runStart);
+    return !result.latenciesMs.empty();
+}
+
+// ========== 结果输出 ==========
+
+void writeJson(const std::string& path, const BenchmarkOptions& options, const std::vector<StageResult>& results) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("Cannot write benchmark results: " + path);
+        return;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"config\": {"
+        << "\"width\": " << options.width
+        << ", \"height\": " << options.height
+        << ", \"fps\": " << options.fps
+        << ", \"duration\": " << options.duration
+        << ", \"warmup_frames\": " << options.warmupFrames
+        << ", \"max_sr_frames\": " << options.maxSrFrames
+        << ", \"preset\": \"" << options.preset << "\""
+        << ", \"model\": \"" << (options.skipSr ? "" : fs::path(options.modelPath).filename().string()) << "\"},\n";
+    out << "  \"environment\": {"
+        << "\"hardware_concurrency\": " << std::thread::hardware_concurrency()
+        << ", \"ffmpeg\": \"" << av_version_info() << "\""
+        << ", \"opencv\": \"" << CV_VERSION << "\""
+        << ", \"onnxruntime\": \"" << OrtGetApiBase()->GetVersionString() << "\"},\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const StageResult& r = results[i];
+        out << "    {\"stage\": \"" << r.stage << "\""
+            << ", \"threads\": " << r.threads
+            << ", \"frames\": " << r.latenciesMs.size()
+            << ", \"fps\": " << r.fps()
+            << ", \"mean_ms\": " << r.mean()
+            << ", \"p50_ms\": " << r.percentile(0.50)
+            << ", \"p99_ms\": " << r.percentile(0.99)
+            << ", \"peak_rss_kb\": " << r.peakRssKb
+            << ", \"baseline_rss_kb\": " << r.baselineRssKb << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void writeCsv(const std::string& path, const std::vector<StageResult>& results) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        LOG_ERROR("Cannot write benchmark results: " + path);
+        return;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "stage,threads,frames,fps,mean_ms,p50_ms,p99_ms,peak_rss_kb,baseline_rss_kb\n";
+    for (const auto& r : results) {
+        out << r.stage << "," << r.threads << "," << r.latenciesMs.size() << "," << r.fps() << ","
+            << r.mean() << "," << r.percentile(0.50) << "," << r.percentile(0.99) << "," << r.peakRssKb << ","
+            << r.baselineRssKb << "\n";
+    }
+}
+
+std::vector<int> parseThreadList(const std::string& text) {
+    std::vector<int> counts;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = std::atoi(item.c_str());
+        if (value > 0) {
+            counts.push_back(value);
+        }
+    }
+    return counts;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --width N           synthetic video width (default 512)\n"
+              << "  --height N          synthetic video height (default 288)\n"
+              << "  --fps F             synthetic video frame rate (default 30)\n"
+              << "  --duration S        synthetic video duration in seconds (default 2)\n"
+              << "  --threads 1,2,4     thread counts to test\n"
+              << "  --warmup N          warm-up frames before timing SR (default 2)\n"
+              << "  --max-sr-frames N   limit frames for SR and pipeline runs (0 = all)\n"
+              << "  --model PATH        ONNX model (default: bundled model)\n"
+              << "  --preset NAME       x264 preset for encode runs (default veryfast)\n"
+              << "  --work-dir DIR      directory for intermediate videos\n"
+              << "  --json PATH         JSON output (default benchmark_results.json)\n"
+              << "  --csv PATH          CSV output (optional)\n"
+              << "  --skip-sr           benchmark decode/encode/mux only\n";
+}
+
+bool parseArgs(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            return i + 1 < argc ? argv[++i] : "";
+        };
+
+        if (arg == "--width") options.width = std::atoi(next().c_str());
+        else if (arg == "--height") options.height = std::atoi(next().c_str());
+        else if (arg == "--fps") options.fps = std::atof(next().c_str());
+        else if (arg == "--duration") options.duration = std::atof(next().c_str());
+        else if (arg == "--threads") options.threadCounts = parseThreadList(next());
+        else if (arg == "--warmup") options.warmupFrames = std::atoi(next().c_str());
+        else if (arg == "--max-sr-frames") options.maxSrFrames = std::atoi(next().c_str());
+        else if (arg == "--model") options.modelPath = next();
+        else if (arg == "--preset") options.preset = next();
+        else if (arg == "--work-dir") options.workDir = next();
+        else if (arg == "--json") options.jsonPath = next();
+        else if (arg == "--csv") options.csvPath = next();
+        else if (arg == "--skip-sr") options.skipSr = true;
+        else {
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    // 编码器要求偶数尺寸（yuv420p）
+    if (options.width <= 0 || options.height <= 0 || options.width % 2 || options.height % 2 ||
+        options.fps <= 0.0 || options.duration <= 0.0 || options.threadCounts.empty()) {
+        std::cerr << "Invalid benchmark options" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    // 基准测试期间只保留警告以上日志，避免控制台输出影响计时
+    Logger::getInstance().setLogLevel(Logger::LogLevel::WARNING);
+
+    if (!options.skipSr) {
+        if (options.modelPath.empty()) {
+            options.modelPath = SuperEigen::SuperResEngine::getDefaultModelPath();
+        }
+        if (!fs::exists(options.modelPath)) {
+            std::cerr << "Model file not found: " << options.modelPath << " (use --model or --skip-sr)" << std::endl;
+            return 1;
+        }
+    }
+
+    fs::path workDir = options.workDir.empty() ? fs::temp_directory_path() / "videosr_benchmark" : fs::path(options.workDir);
+    fs::create_directories(workDir);
+    std::string syntheticPath = (workDir / "synthetic.mp4").string();
+    std::string encodeOutput = (workDir / "encode_out.mp4").string();
+    std::string pipelineOutput = (workDir / "pipeline_out.mp4").string();
+
+    std::cout << "Generating synthetic video " << options.width << "x" << options.height
+              << " @ " << options.fps << "fps, " << options.duration << "s..." << std::endl;
+    if (!generateSyntheticVideo(options, syntheticPath)) {
+        std::cerr << "Failed to generate synthetic video" << std::endl;
+        return 1;
+    }
+
+    std::vector<StageResult> results;
+    auto addResult = [&](StageResult result, int threads, long baselineRssKb) {
+        result.threads = threads;
+        result.baselineRssKb = baselineRssKb;
+        result.peakRssKb = std::max(0L, readPeakRssKb() - baselineRssKb);
+        std::cout << std::fixed << std::setprecision(2)
+                  << "  " << std::setw(12) << std::left << result.stage
+                  << " threads=" << threads
+                  << "  fps=" << result.fps()
+                  << "  p50=" << result.percentile(0.50) << "ms"
+                  << "  p99=" << result.percentile(0.99) << "ms"
+                  << "  rss=" << result.peakRssKb / 1024 << "MB" << std::endl;
+        results.push_back(std::move(result));
+    };
+
+    bool ok = true;
+    for (int threads : options.threadCounts) {
+        std::cout << "== threads=" << threads << " ==" << std::endl;
+
+        long baseline = resetPeakRss();
+        std::vector<FrameData> frames;
+        StageResult decode;
+        if (!benchDecode(syntheticPath, threads, frames, decode)) {
+            std::cerr << "Decode benchmark failed" << std::endl;
+            ok = false;
+            break;
+        }
+        addResult(std::move(decode), threads, baseline);
+
+        // 以下基线在解码帧缓存建好之后取，峰值不含缓存本身
+        if (!options.skipSr) {
+            baseline = resetPeakRss();
+            StageResult preprocess, inference, postprocess;
+            if (!benchSuperRes(frames, options, threads, preprocess, inference, postprocess)) {
+                std::cerr << "Super-resolution benchmark failed" << std::endl;
+                ok = false;
+                break;
+            }
+            addResult(std::move(preprocess), threads, baseline);
+            addResult(std::move(inference), threads, baseline);
+            addResult(std::move(postprocess), threads, baseline);
+        }
+
+        baseline = resetPeakRss();
+        StageResult encode, mux;
+        if (!benchEncodeMux(frames, options, threads, encodeOutput, encode, mux)) {
+            std::cerr << "Encode benchmark failed" << std::endl;
+            ok = false;
+            break;
+        }
+        addResult(std::move(encode), threads, baseline);
+        addResult(std::move(mux), threads, baseline);
+
+        frames.clear();
+        frames.shrink_to_fit();
+
+        baseline = resetPeakRss();
+        StageResult pipeline;
+        if (!benchPipeline(syntheticPath, options, threads, pipelineOutput, pipeline)) {
+            std::cerr << "Pipeline benchmark failed" << std::endl;
+            ok = false;
+            break;
+        }
+        addResult(std::move(pipeline), threads, baseline);
+    }
+
+    writeJson(options.jsonPath, options, results);
+    std::cout << "Results written to " << options.jsonPath << std::endl;
+    if (!options.csvPath.empty()) {
+        writeCsv(options.csvPath, results);
+        std::cout << "Results written to " << options.csvPath << std::endl;
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+#include "../Utils/Logger.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 二进制日志解码工具
+ *
+ * 将 Logger::setBinaryOutput() 写出的日志还原为与文本日志相同的行格式：
+ *   [时间] [级别] [文件:行] 消息
+ *
+ * 用法：log_decode <日志文件> [--level DEBUG|INFO|WARNING|ERROR|CRITICAL]
+ * 文件尾部不完整（进程崩溃时）的记录会被忽略
+ */
+
+namespace {
+
+struct FormatEntry {
+    Logger::LogLevel level = Logger::LogLevel::INFO;
+    int line = 0;
+    std::string file;
+    std::string format;
+};
+
+class BinaryReader {
+public:
+    explicit BinaryReader(std::istream& in) : in_(in) {}
+
+    template <typename T>
+    bool read(T& value) {
+        return static_cast<bool>(in_.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool readString(std::string& text) {
+        uint32_t size = 0;
+        if (!read(size)) {
+            return false;
+        }
+        text.resize(size);
+        return size == 0 || static_cast<bool>(in_.read(&text[0], size));
+    }
+
+private:
+    std::istream& in_;
+};
+
+bool parseLevel(const std::string& name, Logger::LogLevel& level) {
+    for (int i = 0; i <= static_cast<int>(Logger::LogLevel::CRITICAL); ++i) {
+        auto candidate = static_cast<Logger::LogLevel>(i);
+        if (Logger::levelToString(candidate) == name) {
+            level = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::chrono::system_clock::time_point toTimePoint(int64_t timeNs) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(timeNs)));
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " <binary log> [--level DEBUG|INFO|WARNING|ERROR|CRITICAL]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[1]) == "--help") {
+        printUsage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    std::string path = argv[1];
+    Logger::LogLevel minLevel = Logger::LogLevel::DEBUG;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--level" && i + 1 < argc) {
+            if (!parseLevel(argv[++i], minLevel)) {
+                std::cerr << "Unknown level: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+
+    char magic[sizeof(Logger::kBinaryMagic)] = {};
+    if (!in.read(magic, sizeof(magic)) || memcmp(magic, Logger::kBinaryMagic, sizeof(magic)) != 0) {
+        std::cerr << path << " is not a VideoSR binary log" << std::endl;
+        return 1;
+    }
+
+    BinaryReader reader(in);
+    std::unordered_map<uint32_t, FormatEntry> formats;
+    std::string payload;
+    size_t events = 0;
+    bool truncated = false;
+
+    while (true) {
+        uint8_t type = 0;
+        if (!reader.read(type)) {
+            break;
+        }
+
+        if (type == static_cast<uint8_t>(Logger::BinaryRecord::Format)) {
+            uint32_t id = 0;
+            uint8_t level = 0;
+            uint32_t line = 0;
+            FormatEntry entry;
+            if (!reader.read(id) || !reader.read(level) || !reader.read(line) ||
+                !reader.readString(entry.file) || !reader.readString(entry.format)) {
+                truncated = true;
+                break;
+            }
+            entry.level = static_cast<Logger::LogLevel>(level);
+            entry.line = static_cast<int>(line);
+            formats[id] = std::move(entry);
+        } else if (type == static_cast<uint8_t>(Logger::BinaryRecord::Event)) {
+            uint32_t id = 0;
+            int64_t timeNs = 0;
+            if (!reader.read(id) || !reader.read(timeNs) || !reader.readString(payload)) {
+                truncated = true;
+                break;
+            }
+            auto it = formats.find(id);
+            if (it == formats.end()) {
+                std::cerr << "Event references unknown format id " << id << std::endl;
+                continue;
+            }
+            const FormatEntry& entry = it->second;
+            if (entry.level < minLevel) {
+                continue;
+            }
+            std::cout << Logger::formatLine(entry.level, toTimePoint(timeNs), entry.file.c_str(), entry.line,
+                                            Logger::formatPayload(entry.format.c_str(), payload.data(), payload.size()))
+                      << '\n';
+            ++events;
+        } else if (type == static_cast<uint8_t>(Logger::BinaryRecord::Text)) {
+            uint8_t level = 0;
+            int64_t timeNs = 0;
+            uint32_t line = 0;
+            std::string file;
+            std::string message;
+            if (!reader.read(level) || !reader.read(timeNs) || !reader.read(line) ||
+                !reader.readString(file) || !reader.readString(message)) {
+                truncated = true;
+                break;
+            }
+            if (static_cast<Logger::LogLevel>(level) < minLevel) {
+                continue;
+            }
+            std::cout << Logger::formatLine(static_cast<Logger::LogLevel>(level), toTimePoint(timeNs),
+                                            file.c_str(), static_cast<int>(line), message)
+                      << '\n';
+            ++events;
+        } else {
+            std::cerr << "Unknown record type " << static_cast<int>(type) << ", stopping" << std::endl;
+            return 1;
+        }
+    }
+
+    if (truncated) {
+        std::cerr << "Warning: last record is incomplete (log was not closed cleanly)" << std::endl;
+    }
+    std::cerr << "Decoded " << events << " records, " << formats.size() << " formats" << std::endl;
+    return 0;
+}
@@ -0,0 +1,607 @@
+#include "../AppController/ImageBatchPipeline.h"
+#include "../AppController/JobScheduler.h"
+#include "../AppController/VideoJob.h"
+#include "../Decoder/include/ProbeCache.h"
+#include "../Processing/ThreadBudgetTuner.h"
+#include "../SuperEigen/include/SuperResEngine.h"
+#include "../Utils/Logger.h"
+#include "../Utils/MemoryTracker.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glob.h>
+
+/**
+ * @brief 无界面批处理命令行
+ *
+ * 输入可以是文件、目录或通配符（如 "*.mp4"，需加引号避免shell展开）。
+ * 图像和视频作为作业提交到 JobScheduler，共享 --sessions 个超分会话；
+ * 图像经 ImageBatchPipeline 处理，读取解码和编码写出在线程池上并行、与推理重叠；
+ * 输出按输入的相对路径写入输出目录，已存在的输出默认跳过（--overwrite 强制重做）。
+ * 结果先写入 .part 临时文件，成功后再改名，中断的作业不会被下次运行误判为已完成。
+ * 每个文件的耗时写入CSV报告（默认 <输出目录>/videosr_report.csv）。
+ *
+ * 用法：videosr -o <输出目录> [选项] <输入...>
+ */
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CliOptions {
+    std::vector<std::string> inputs;   // 文件、目录或通配符
+    std::string outputDir;             // 输出目录
+    std::string modelPath;             // 模型路径（空=默认模型）
+    std::string reportPath;            // 报告路径（空=输出目录下videosr_report.csv）
+    std::string probeCacheDir;         // 媒体探测缓存目录（空=只在内存中缓存）
+    int sessions = 1;                  // 超分会话数（同时处理的帧数）
+    int threadsPerSession = 0;         // 每个会话的推理线程数（0=引擎默认）
+    int maxActive = 0;                 // 同时打开的作业数（0=会话数*2）
+    int encoderThreads = 2;            // 每个视频作业的编码线程数
+    int decoderThreads = 0;            // 每个视频作业的解码线程数（0=解码器默认）
+    bool autoThreads = false;          // 用第一个视频校准解码/超分/编码线程分配
+    int swsThreads = 1;                // 解码/编码色彩转换的并行带数（1=不分带，0=按帧尺寸自动）
+    int jpegQuality = 95;              // JPEG输出质量 (1-100)
+    size_t imagesInFlight = 0;         // 同时在内存中的图像数（0=硬件线程数*2）
+    int64_t maxFrames = 0;             // 每个视频最多处理的帧数（0=全部）
+    bool reencodeAudio = false;        // 重新编码音频（默认直通原始音频）
+    bool directIO = false;             // 视频输出使用O_DIRECT写
+    std::string inputIO = "readahead"; // 视频输入读取方式：readahead/mmap/default
+    bool fragmented = false;           // 视频输出分片MP4（写入过程中即可播放）
+    double hlsSegmentSeconds = 0.0;    // >0时视频输出HLS分段（播放列表+fMP4分段）
+    int64_t preallocateMb = 0;         // 每个视频输出预分配的空间（MiB）
+    bool useGpu = false;
+    int gpuId = 0;
+    bool recursive = false;            // 递归遍历目录
+    bool overwrite = false;            // 覆盖已存在的输出
+};
+
+enum class MediaType { Image, Video, Unknown };
+
+struct FileTask {
+    fs::path input;
+    fs::path output;
+    MediaType type = MediaType::Unknown;
+    std::string status = "pending";    // pending/skipped/completed/failed/cancelled
+    std::string error;                 // 失败原因（写入报告）
+    JobId jobId = 0;
+    uint64_t frames = 0;
+    double queuedMs = 0.0;
+    double processingMs = 0.0;
+    double wallMs = 0.0;
+};
+
+const std::set<std::string> kImageExtensions = {".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff", ".webp"};
+const std::set<std::string> kVideoExtensions = {".mp4", ".mkv", ".avi", ".mov", ".webm", ".flv", ".ts", ".m4v"};
+
+std::string lowerExtension(const fs::path& path) {
+    std::string ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+MediaType classify(const fs::path& path) {
+    std::string ext = lowerExtension(path);
+    if (kImageExtensions.count(ext)) {
+        return MediaType::Image;
+    }
+    if (kVideoExtensions.count(ext)) {
+        return MediaType::Video;
+    }
+    return MediaType::Unknown;
+}
+
+const char* typeName(MediaType type) {
+    switch (type) {
+        case MediaType::Image: return "image";
+        case MediaType::Video: return "video";
+        default: return "unknown";
+    }
+}
+
+bool hasWildcard(const std::string& text) {
+    return text.find_first_of("*?[") != std::string::npos;
+}
+
+/**
+ * @brief 展开单个输入：通配符用glob(3)，目录按扩展名筛选，文件原样保留
+ * 结果为(文件, 根目录)，输出路径按文件相对根目录的路径计算
+ */
+void collectInput(const std::string& input, bool recursive, std::vector<std::pair<fs::path, fs::path>>& files) {
+    if (hasWildcard(input)) {
+        glob_t matches{};
+        if (glob(input.c_str(), 0, nullptr, &matches) == 0) {
+            for (size_t i = 0; i < matches.gl_pathc; ++i) {
+                fs::path path = matches.gl_pathv[i];
+                if (fs::is_regular_file(path)) {
+                    files.emplace_back(path, path.parent_path());
+                } else if (fs::is_directory(path)) {
+                    collectInput(path.string(), recursive, files);
+                }
+            }
+        } else {
+            std::cerr << "No match for " << input << std::endl;
+        }
+        globfree(&matches);
+        return;
+    }
+
+    fs::path path = input;
+    std::error_code ec;
+    if (fs::is_directory(path, ec)) {
+        auto addEntry = [&](const fs::directory_entry& entry) {
+            if (entry.is_regular_file() && classify(entry.path()) != MediaType::Unknown) {
+                files.emplace_back(entry.path(), path);
+            }
+        };
+        if (recursive) {
+            for (const auto& entry : fs::recursive_directory_iterator(path, ec)) {
+                addEntry(entry);
+            }
+        } else {
+            for (const auto& entry : fs::directory_iterator(path, ec)) {
+                addEntry(entry);
+            }
+        }
+    } else if (fs::is_regular_file(path, ec)) {
+        files.emplace_back(path, path.parent_path());
+    } else {
+        std::cerr << "Input not found: " << input << std::endl;
+    }
+}
+
+/**
+ * @brief 临时输出路径：name.ext -> name.part.ext（保留扩展名，imwrite按扩展名选择编码）
+ */
+fs::path partPath(const fs::path& output) {
+    fs::path part = output;
+    part.replace_extension(".part" + output.extension().string());
+    return part;
+}
+
+bool commitOutput(const fs::path& part, const fs::path& output) {
+    // 空的临时文件不能改名：下次运行会把非空的同名输出当作已完成而跳过，这里宁可判失败
+    std::error_code ec;
+    if (!fs::exists(part, ec) || fs::file_size(part, ec) == 0 || ec) {
+        LOG_ERROR("Output is missing or empty, not committing: " + part.string());
+        return false;
+    }
+    fs::rename(part, output, ec);
+    if (ec) {
+        LOG_ERROR("Failed to rename " + part.string() + " -> " + output.string() + ": " + ec.message());
+        return false;
+    }
+    return true;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " -o <output dir> [options] <input...>\n"
+              << "  input                 image/video file, directory, or quoted glob (\"clips/*.mp4\")\n"
+              << "  -o, --output DIR      output directory (relative layout of inputs is kept)\n"
+              << "  -r, --recursive       descend into subdirectories\n"
+              << "  -j, --sessions N      super-resolution sessions shared by all jobs (default 1)\n"
+              << "  --threads N           inference threads per session (default: engine default)\n"
+              << "  --max-active N        files processed concurrently (default: 2 x sessions)\n"
+              << "  --encoder-threads N   encoder threads per video (default 2)\n"
+              << "  --decoder-threads N   decoder threads per video (default: decoder default)\n"
+              << "  --auto-threads        calibrate sessions and decode/SR/encode threads on the first video\n"
+              << "  --sws-threads N       row bands for decode/encode color conversion (default: 1 = off, 0 = by frame size)\n"
+              << "  --jpeg-quality N      JPEG output quality 1-100 (default 95)\n"
+              << "  --images-in-flight N  decoded images held in memory (default: 2 x hardware threads)\n"
+              << "  --max-frames N        stop each video after N frames\n"
+              << "  --reencode-audio      re-encode audio to AAC instead of copying the source stream\n"
+              << "  --input-io MODE       read video inputs with readahead (default), mmap or default FFmpeg I/O\n"
+              << "  --direct-io           write video outputs with O_DIRECT (bypass page cache)\n"
+              << "  --fragmented          write fragmented MP4 (playable while being written, no final rewrite)\n"
+              << "  --hls SECONDS         write videos as HLS playlists with SECONDS-long fMP4 segments\n"
+              << "  --preallocate-mb N    preallocate N MiB for each video output\n"
+              << "  --model PATH          ONNX model (default: bundled model)\n"
+              << "  --gpu [ID]            run inference on GPU ID (default 0)\n"
+              << "  --probe-cache DIR     keep media probe results in DIR so reruns skip stream probing\n"
+              << "  --report PATH         per-file timing CSV (default <output>/videosr_report.csv)\n"
+              << "  --overwrite           reprocess files whose output already exists\n";
+}
+
+bool parseArgs(int argc, char* argv[], CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> std::string {
+            return i + 1 < argc ? argv[++i] : "";
+        };
+
+        if (arg == "-o" || arg == "--output") options.outputDir = next();
+        else if (arg == "-r" || arg == "--recursive") options.recursive = true;
+        else if (arg == "-j" || arg == "--sessions") options.sessions = std::atoi(next().c_str());
+        else if (arg == "--threads") options.threadsPerSession = std::atoi(next().c_str());
+        else if (arg == "--max-active") options.maxActive = std::atoi(next().c_str());
+        else if (arg == "--encoder-threads") options.encoderThreads = std::atoi(next().c_str());
+        else if (arg == "--decoder-threads") options.decoderThreads = std::atoi(next().c_str());
+        else if (arg == "--auto-threads") options.autoThreads = true;
+        else if (arg == "--sws-threads") options.swsThreads = std::atoi(next().c_str());
+        else if (arg == "--jpeg-quality") options.jpegQuality = std::atoi(next().c_str());
+        else if (arg == "--images-in-flight") options.imagesInFlight = static_cast<size_t>(std::atoll(next().c_str()));
+        else if (arg == "--max-frames") options.maxFrames = std::atoll(next().c_str());
+        else if (arg == "--reencode-audio") options.reencodeAudio = true;
+        else if (arg == "--input-io") options.inputIO = next();
+        else if (arg == "--direct-io") options.directIO = true;
+        else if (arg == "--fragmented") options.fragmented = true;
+        else if (arg == "--hls") options.hlsSegmentSeconds = std::atof(next().c_str());
+        else if (arg == "--preallocate-mb") options.preallocateMb = std::atoll(next().c_str());
+        else if (arg == "--model") options.modelPath = next();
+        else if (arg == "--report") options.reportPath = next();
+        else if (arg == "--probe-cache") options.probeCacheDir = next();
+        else if (arg == "--overwrite") options.overwrite = true;
+        else if (arg == "--gpu") {
+            options.useGpu = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                options.gpuId = std::atoi(argv[++i]);
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+
+    if (options.inputIO != "readahead" && options.inputIO != "mmap" && options.inputIO != "default") {
+        std::cerr << "Unknown --input-io mode: " << options.inputIO << std::endl;
+        return false;
+    }
+    if (options.outputDir.empty() || options.inputs.empty() || options.sessions <= 0) {
+        printUsage(argv[0]);
+        return false;
+    }
+    if (options.maxActive <= 0 && !options.autoThreads) {
+        options.maxActive = options.sessions * 2;
+    }
+    if (options.imagesInFlight == 0) {
+        options.imagesInFlight = std::max(2u, std::thread::hardware_concurrency() * 2);
+    }
+    return true;
+}
+
+bool writeReport(const std::string& path, const std::vector<FileTask>& tasks) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Cannot write report: " << path << std::endl;
+        return false;
+    }
+    out << "input,output,type,status,frames,queued_ms,processing_ms,wall_ms,error\n";
+    out << std::fixed << std::setprecision(1);
+    for (const auto& task : tasks) {
+        out << '"' << task.input.string() << "\",\"" << task.output.string() << "\","
+            << typeName(task.type) << ',' << task.status << ',' << task.frames << ','
+            << task.queuedMs << ',' << task.processingMs << ',' << task.wallMs << ",\"" << task.error << "\"\n";
+    }
+    return true;
+}
+
+/**
+ * @brief 用第一个待处理视频校准线程分配，结果写回options
+ *
+ * 按单条流水线建模：会话数和每会话线程数取校准结果，解码/编码线程数用于每个视频作业。
+ * 校准失败时保留命令行给出的设置
+ */
+void calibrateThreads(const std::vector<FileTask>& tasks, CliOptions& options,
+                      ThreadBudgetTuner::SessionMap& sessions) {
+    auto video = std::find_if(tasks.begin(), tasks.end(), [](const FileTask& task) {
+        return task.type == MediaType::Video && task.status != "skipped";
+    });
+    if (video == tasks.end()) {
+        return;
+    }
+
+    ThreadBudgetTuner tuner;
+    VideoProbeConfig probeConfig;
+    probeConfig.inputPath = video->input.string();
+    probeConfig.modelPath = options.modelPath;
+    probeConfig.useGpu = options.useGpu;
+    probeConfig.gpuId = options.gpuId;
+    if (!tuner.setVideoProbes(probeConfig, &sessions)) {
+        std::cerr << "Thread calibration failed, keeping command line settings" << std::endl;
+        return;
+    }
+
+    ThreadBudget budget = tuner.tune();
+    if (budget.predictedFps <= 0.0) {
+        std::cerr << "Thread calibration failed, keeping command line settings" << std::endl;
+        sessions.clear();
+        return;
+    }
+    options.sessions = budget.srSessions;
+    options.threadsPerSession = budget.srThreadsPerSession;
+    options.decoderThreads = budget.decodeThreads;
+    options.encoderThreads = budget.encodeThreads;
+    std::cout << "Thread budget: " << budget.toString() << std::endl;
+
+    // 只保留选中线程数的会话
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        it = it->first == budget.srThreadsPerSession ? std::next(it) : sessions.erase(it);
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CliOptions options;
+    if (!parseArgs(argc, argv, options)) {
+        return 1;
+    }
+
+    Logger::getInstance().setLogLevel(Logger::LogLevel::INFO);
+    Logger::getInstance().setLogToConsole(true);
+    Logger::getInstance().setAsync(true);
+    MemoryTracker::getInstance().configureFromEnvironment();
+    if (!options.probeCacheDir.empty()) {
+        ProbeCache::getInstance().setDiskCacheDir(options.probeCacheDir);
+    }
+
+    if (options.modelPath.empty()) {
+        options.modelPath = SuperEigen::SuperResEngine::getDefaultModelPath();
+    }
+    if (!fs::exists(options.modelPath)) {
+        std::cerr << "Model file not found: " << options.modelPath << std::endl;
+        return 1;
+    }
+
+    // 收集输入文件并计算输出路径
+    std::vector<std::pair<fs::path, fs::path>> files;
+    for (const auto& input : options.inputs) {
+        collectInput(input, options.recursive, files);
+    }
+
+    fs::path outputDir = options.outputDir;
+    std::vector<FileTask> tasks;
+    std::set<fs::path> seenOutputs;
+    for (const auto& [input, base] : files) {
+        FileTask task;
+        task.input = input;
+        task.type = classify(input);
+        if (task.type == MediaType::Unknown) {
+            std::cerr << "Skipping unsupported file: " << input << std::endl;
+            continue;
+        }
+
+        fs::path relative = base.empty() ? input.filename() : input.lexically_relative(base);
+        task.output = outputDir / relative;
+        if (task.type == MediaType::Video) {
+            // 编码器输出mp4；HLS输出播放列表，分段文件写在同一目录
+            task.output.replace_extension(options.hlsSegmentSeconds > 0.0 ? ".m3u8" : ".mp4");
+        }
+        if (!seenOutputs.insert(task.output).second) {
+            std::cerr << "Skipping " << input << ": output " << task.output << " collides with another input" << std::endl;
+            continue;
+        }
+
+        std::error_code ec;
+        if (fs::equivalent(task.input, task.output, ec)) {
+            std::cerr << "Skipping " << input << ": output would overwrite the input" << std::endl;
+            continue;
+        }
+        if (!options.overwrite && fs::exists(task.output) && fs::file_size(task.output, ec) > 0) {
+            task.status = "skipped";
+        }
+        tasks.push_back(std::move(task));
+    }
+
+    if (tasks.empty()) {
+        std::cerr << "No images or videos found" << std::endl;
+        return 1;
+    }
+
+    // 按第一个待处理视频校准线程分配，选中的校准会话直接作为第一个超分会话
+    ThreadBudgetTuner::SessionMap calibrated;
+    if (options.autoThreads) {
+        calibrateThreads(tasks, options, calibrated);
+        if (options.maxActive <= 0) {
+            options.maxActive = options.sessions * 2;
+        }
+    }
+
+    // 创建共享的超分会话
+    JobScheduler scheduler;
+    for (int i = 0; i < options.sessions; ++i) {
+        auto reuse = calibrated.find(options.threadsPerSession);
+        if (reuse != calibrated.end()) {
+            scheduler.addSession(reuse->second);
+            calibrated.erase(reuse);
+            continue;
+        }
+        auto engine = std::make_shared<SuperEigen::SuperResEngine>();
+        if (options.threadsPerSession > 0) {
+            SuperEigen::SuperResConfig config;
+            config.numThreads = options.threadsPerSession;
+            engine->setConfig(config);
+        }
+        if (!engine->initialize(options.modelPath, options.useGpu, options.gpuId)) {
+            std::cerr << "Failed to initialize super resolution engine" << std::endl;
+            return 1;
+        }
+        scheduler.addSession(engine);
+    }
+
+    // 作业结束通知：限制同时打开的视频数
+    std::mutex finishedMutex;
+    std::condition_variable finishedCv;
+    size_t active = 0;
+
+    // 图像：解码/编码在线程池上并行，超分作业与视频共享会话
+    ImageBatchConfig imageConfig;
+    imageConfig.jpegQuality = options.jpegQuality;
+    imageConfig.maxInFlight = options.imagesInFlight;
+    ImageBatchPipeline imagePipeline(scheduler, imageConfig);
+    std::map<std::string, FileTask*> imageTasks;  // 临时输出路径 -> 任务
+    imagePipeline.setResultCallback([&](const ImageBatchResult& result) {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        auto it = imageTasks.find(result.item.outputPath);
+        if (it == imageTasks.end()) {
+            return;
+        }
+        FileTask* task = it->second;
+        fs::path part = result.item.outputPath;
+        std::string error = result.success ? "" : result.error;
+        if (result.success && !commitOutput(part, task->output)) {
+            error = "failed to commit output";
+        }
+        bool ok = error.empty();
+        if (!ok) {
+            std::error_code ec;
+            fs::remove(part, ec);
+        }
+        task->status = ok ? "completed" : (result.error == "cancelled" ? "cancelled" : "failed");
+        task->error = error;
+        task->frames = ok ? 1 : 0;
+        task->processingMs = result.decodeMs + result.srMs + result.encodeMs;
+        task->queuedMs = std::max(0.0, result.totalMs - task->processingMs);
+        task->wallMs = result.totalMs;
+    });
+
+    auto batchStart = std::chrono::steady_clock::now();
+    size_t skipped = 0;
+    // 先把图像全部排入流水线（不阻塞），再按 --max-active 逐个提交视频
+    for (auto& task : tasks) {
+        if (task.status == "skipped" || task.type != MediaType::Image) {
+            continue;
+        }
+        fs::create_directories(task.output.parent_path());
+        std::string part = partPath(task.output).string();
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            imageTasks[part] = &task;
+        }
+        imagePipeline.submit({task.input.string(), part});
+    }
+
+    for (auto& task : tasks) {
+        if (task.status == "skipped") {
+            ++skipped;
+            continue;
+        }
+        if (task.type != MediaType::Video) {
+            continue;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            finishedCv.wait(lock, [&] { return active < static_cast<size_t>(options.maxActive); });
+            ++active;
+        }
+
+        fs::create_directories(task.output.parent_path());
+        fs::path part = partPath(task.output);
+
+        VideoJobConfig config;
+        config.inputPath = task.input.string();
+        config.outputPath = part.string();
+        config.maxFrames = options.maxFrames;
+        config.audioPassthrough = !options.reencodeAudio;
+        if (options.inputIO == "mmap") {
+            config.decoder.input.mode = InputReadMode::Mmap;
+        } else if (options.inputIO == "default") {
+            config.decoder.input.mode = InputReadMode::Default;
+        }
+        config.encoder.directIO = options.directIO;
+        config.encoder.preallocateBytes = options.preallocateMb << 20;
+        if (options.hlsSegmentSeconds > 0.0) {
+            // 分段按最终文件名命名，完成时只需重命名播放列表
+            config.encoder.outputMode = MuxerOutputMode::Segmented;
+            config.encoder.segmentDuration = options.hlsSegmentSeconds;
+            config.encoder.segmentBaseName = task.output.stem().string();
+        } else if (options.fragmented) {
+            config.encoder.outputMode = MuxerOutputMode::Fragmented;
+        }
+        config.encoder.threadCount = options.encoderThreads;
+        if (options.decoderThreads > 0) {
+            config.decoder.threadCount = options.decoderThreads;
+        }
+        config.decoder.swsThreads = options.swsThreads;
+        config.encoder.swsThreads = options.swsThreads;
+        auto videoJob = std::make_shared<VideoJob>(config);
+
+        auto submitted = std::chrono::steady_clock::now();
+        JobOptions jobOptions;
+        jobOptions.priority = JobPriority::Batch;
+        jobOptions.onFinished = [&, taskPtr = &task, part, submitted, videoJob](JobId id, JobState state) {
+            // 调度器在回调返回后移除作业记录，排队和处理时间在这里取
+            JobStatus status;
+            bool hasStatus = scheduler.getStatus(id, status);
+            // 只有作业真正完成（含编码器刷新和文件尾写出）才提交，否则删掉不完整的临时文件
+            std::string error;
+            if (state == JobState::Cancelled) {
+                error = "cancelled";
+            } else if (state != JobState::Completed) {
+                error = "processing or output write failed";
+            } else if (!commitOutput(part, taskPtr->output)) {
+                error = "failed to commit output";
+            }
+            bool ok = error.empty();
+            if (!ok) {
+                std::error_code ec;
+                fs::remove(part, ec);
+            }
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            taskPtr->status = ok ? "completed" : (state == JobState::Cancelled ? "cancelled" : "failed");
+            taskPtr->error = error;
+            taskPtr->frames = static_cast<uint64_t>(videoJob->processedFrames());
+            if (hasStatus) {
+                taskPtr->queuedMs = status.queuedMs;
+                taskPtr->processingMs = status.runMs;
+            }
+            taskPtr->wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - submitted).count();
+            --active;
+            finishedCv.notify_all();
+        };
+
+        task.jobId = scheduler.submit(videoJob, jobOptions);
+        if (task.jobId == 0) {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            task.status = "failed";
+            task.error = "job scheduler is shut down";
+            --active;
+        }
+    }
+
+    // 图像的超分作业在解码完成后才提交，先等流水线再等调度器
+    imagePipeline.wait();
+    scheduler.waitAll();
+    double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - batchStart).count();
+
+    size_t completed = 0;
+    size_t failed = 0;
+    for (auto& task : tasks) {
+        if (task.status == "completed") {
+            ++completed;
+        } else if (task.status != "skipped") {
+            ++failed;
+        }
+    }
+
+    std::string reportPath = options.reportPath.empty() ? (outputDir / "videosr_report.csv").string() : options.reportPath;
+    writeReport(reportPath, tasks);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Processed " << completed << " file(s), skipped " << skipped << ", failed " << failed
+              << " in " << batchSeconds << "s. Report: " << reportPath << std::endl;
+
+    scheduler.shutdown();
+    Logger::getInstance().flush();
+    return failed == 0 ? 0 : 2;
+}